@@ -47,7 +47,7 @@ auto Demo_ElevationSampler = [](Application& app)
     static std::uint64_t frame = 0;
     static auto active = [](Application& app) {return (app.frameCount() - frame < 2); };
     static ElevationSampler sampler;
-    static Future<Result<ElevationSample>> sample;
+    static Future<std::vector<Result<ElevationSample>>> sample;
     static GeoPoint mouse;
 
     frame = app.viewer->getFrameStamp()->frameCount;
@@ -96,10 +96,8 @@ auto Demo_ElevationSampler = [](Application& app)
 
                     mouse = p.transform(SRS::WGS84);
 
-                    sample = app.io().services().jobs.dispatch([&app, point(p)](Cancelable& c)
-                        {
-                            return sampler.sample(point, app.io().with(c));
-                        });
+                    // asynchronous query, so the mouse handler never waits on tile I/O
+                    sample = sampler.sampleAsync({ p }, app.io());
                 }
                 else
                 {
@@ -137,10 +135,11 @@ auto Demo_ElevationSampler = [](Application& app)
         {
             ImGui::Separator();
 
-            if (sample.available() && sample.value().ok())
+            if (sample.available() && !sample->empty() && sample->front().ok())
             {
-                ImGuiLTable::Text("Elevation sampler:", "%.2f m", sample->value().height);
-                ImGuiLTable::Text("Geometric error:", "%.2f m", std::abs(sample->value().height - i.z));
+                auto height = sample->front().value().height;
+                ImGuiLTable::Text("Elevation sampler:", "%.2f m", height);
+                ImGuiLTable::Text("Geometric error:", "%.2f m", std::abs(height - i.z));
             }
             else if (sample.working())
             {
@@ -87,6 +87,11 @@ auto Demo_Stats = [](Application& app)
         buf = format(u8"%lld us", average(&update, over, f));
         ImGuiLTable::PlotLines("Update", get_timings, &update, frame_count, f, buf.c_str(), 0.0f, 10.0f);
 
+        auto metered = app.vsgcontext->meteredUpdateStats();
+        buf = format("%d ran / %d queued (%lld of %lld us)", (int)metered.ran, (int)metered.backlog,
+            (long long)metered.used.count(), (long long)app.vsgcontext->meteredUpdateBudget.count());
+        ImGuiLTable::TextUnformatted("  Metered", buf.c_str());
+
         buf = format(u8"%lld us", average(&record, over, f));
         ImGuiLTable::PlotLines("Record", get_timings, &record, frame_count, f, buf.c_str(), 0.0f, 10.0f);
 
@@ -119,8 +124,12 @@ auto Demo_Stats = [](Application& app)
             if (m)
             {
                 std::string name = m->name.empty() ? "default" : m->name;
-                auto buf = format("(%d) %d / %d", (int)m->concurrency, (int)m->running, (int)m->pending);
+                auto buf = format("(%d) %d / %d (peak %d)", (int)m->concurrency, (int)m->running, (int)m->pending, (int)m->peak_pending);
                 ImGuiLTable::TextUnformatted(name.c_str(), buf.c_str());
+                auto latency = format("%.1lf us / %.1lf ms", m->avg_dequeue_ns() / 1e3, m->avg_wait_ns() / 1e6);
+                ImGuiLTable::TextUnformatted("  dequeue / wait", latency.c_str());
+                auto run = format("%.1lf ms / %d errors", m->avg_run_ns() / 1e6, (int)m->errors);
+                ImGuiLTable::TextUnformatted("  run / errors", run.c_str());
             }
         }
         ImGuiLTable::End();
@@ -152,13 +161,23 @@ auto Demo_Stats = [](Application& app)
         auto contentCache = app.io().services().contentCache;
         if (contentCache)
         {
-            ImGui::TableNextColumn(); ImGui::TextUnformatted("URI cache");
-            ImGui::TableNextColumn(); ImGui::Text("%ld", contentCache->capacity());
-            ImGui::TableNextColumn(); ImGui::Text("%ld", contentCache->size());
+            ImGui::TableNextColumn(); ImGui::TextUnformatted("URI cache (MB)");
+            ImGui::TableNextColumn(); ImGui::Text("%ld", contentCache->capacity() / 1048576);
+            ImGui::TableNextColumn(); ImGui::Text("%ld", contentCache->bytes() / 1048576);
             ImGui::TableNextColumn(); ImGui::Text("%d", contentCache->hits());
             ImGui::TableNextColumn(); ImGui::Text("%d", contentCache->misses());
         }
 
+        auto diskCache = app.io().services().diskCache;
+        if (diskCache)
+        {
+            ImGui::TableNextColumn(); ImGui::TextUnformatted("Disk cache (MB)");
+            ImGui::TableNextColumn(); ImGui::Text("%ld", diskCache->capacity() / 1048576);
+            ImGui::TableNextColumn(); ImGui::Text("%ld", (std::size_t)(diskCache->sizeInBytes() / 1048576));
+            ImGui::TableNextColumn(); ImGui::Text("%d", diskCache->hits());
+            ImGui::TableNextColumn(); ImGui::Text("%d", diskCache->misses());
+        }
+
         auto deadpool = app.io().services().deadpool;
         if (deadpool)
         {
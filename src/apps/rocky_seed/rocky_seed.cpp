@@ -0,0 +1,179 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * Seeds an MBTiles database with the tiles of one layer from a map file,
+ * for use without a network connection. Re-run the same command to resume
+ * an interrupted seed.
+ */
+#include <rocky/rocky.h>
+#include <rocky/TileSeeder.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+int usage(const char* name)
+{
+    std::cout
+        << "Seeds an MBTiles database with the tiles of a map layer" << std::endl
+        << name << std::endl
+        << "    --map <filename>             // JSON map file holding the layer" << std::endl
+        << "    --out <filename>             // MBTiles database to create or add to" << std::endl
+        << "    [--layer <name>]             // layer to seed (default: first image or elevation layer)" << std::endl
+        << "    [--extent <w> <s> <e> <n>]   // area to seed in degrees (default: layer extent)" << std::endl
+        << "    [--min-level <n>]            // lowest level to seed (default: 0)" << std::endl
+        << "    [--max-level <n>]            // highest level to seed (default: 10)" << std::endl
+        << "    [--format <mime-type>]       // tile format (default: image/png, or image/tif for elevation)" << std::endl
+        << "    [--concurrency <n>]          // tiles to create at once (default: 8)" << std::endl
+        << "    [--compress]                 // zlib-compress each tile" << std::endl
+        << "    [--deduplicate]              // store identical tiles once (new databases only)" << std::endl
+        << "    [--upsample]                 // also write tiles the layer only has lower-resolution data for" << std::endl;
+    return 0;
+}
+
+#ifdef ROCKY_HAS_MBTILES
+
+using namespace ROCKY_NAMESPACE;
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine args(&argc, argv);
+
+    if (args.read("--help"))
+        return usage(argv[0]);
+
+    std::string mapFile, outFile, layerName;
+    args.read("--map", mapFile);
+    args.read("--out", outFile);
+    args.read("--layer", layerName);
+
+    if (mapFile.empty() || outFile.empty())
+        return usage(argv[0]);
+
+    TileSeeder seeder;
+    seeder.maxLevel = 10u;
+    args.read("--min-level", seeder.minLevel);
+    args.read("--max-level", seeder.maxLevel);
+    args.read("--concurrency", seeder.concurrency);
+    seeder.upsample = args.read("--upsample");
+
+    double west, south, east, north;
+    if (args.read("--extent", west, south, east, north))
+        seeder.extent = GeoExtent(SRS::WGS84, west, south, east, north);
+
+    MBTiles::Options options;
+    options.uri = URI(outFile);
+    options.compress = args.read("--compress");
+    options.deduplicate = args.read("--deduplicate");
+
+    std::string format;
+    bool formatSet = args.read("--format", format);
+
+    // the VSG context supplies the image codecs and the rest of the IO services.
+    auto context = VSGContextFactory::create(vsg::Viewer::create(), argc, argv);
+    if (context->status.failed())
+    {
+        Log()->error("Cannot create rocky context: {}", context->status.error().message);
+        return -1;
+    }
+    auto& io = context->io;
+
+    auto mapJSON = URI(mapFile).read(io);
+    if (mapJSON.failed())
+    {
+        Log()->error("Cannot read map file {}: {}", mapFile, mapJSON.error().message);
+        return -1;
+    }
+
+    auto map = Map::create();
+    auto r = map->from_json(mapJSON->content.data, io.from(mapFile));
+    if (r.failed())
+    {
+        Log()->error("Cannot load map file {}: {}", mapFile, r.error().message);
+        return -1;
+    }
+
+    seeder.layer = map->layer<TileLayer>([&](TileLayer::ConstPtr layer) {
+        return (layerName.empty() || layer->name == layerName) &&
+            (ImageLayer::cast(layer) || ElevationLayer::cast(layer)); });
+
+    if (!seeder.layer)
+    {
+        Log()->error("No image or elevation layer {}in {}", layerName.empty() ? "" : "named " + layerName + " ", mapFile);
+        return -1;
+    }
+
+    r = seeder.layer->open(io);
+    if (r.failed())
+    {
+        Log()->error("Cannot open layer {}: {}", seeder.layer->name, r.error().message);
+        return -1;
+    }
+
+    bool elevation = ElevationLayer::cast(seeder.layer) != nullptr;
+    options.format = formatSet ? format : elevation ? "image/tif" : "image/png";
+
+    // make sure the format has a writer before seeding anything; elevation tiles
+    // are stored as 32-bit float heights, which many image formats can't hold.
+    auto probe = Image::create(elevation ? Image::R32_SFLOAT : Image::R8G8B8A8_UNORM, 1, 1);
+    probe->fill(glm::fvec4(0.0f));
+    std::stringstream probeStream;
+    r = io.services().writeImageToStream(probe, probeStream, options.format, io);
+    if (r.failed())
+    {
+        Log()->error("Cannot write {} tiles as {} ({}); choose another --format", elevation ? "elevation" : "image",
+            options.format.value(), r.error().message);
+        return -1;
+    }
+
+    MBTiles::Driver output;
+    Profile profile = seeder.layer->profile;
+    DataExtentList dataExtents;
+    r = output.open(seeder.layer->name, options, true, profile, dataExtents, io);
+    if (r.failed())
+    {
+        Log()->error("Cannot open {}: {}", outFile, r.error().message);
+        return -1;
+    }
+
+    seeder.profile = profile;
+
+    auto start = std::chrono::steady_clock::now();
+
+    seeder.onProgress = [&](const TileSeeder::Progress& p)
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "\r" << p.done << " / " << p.total << " keys, "
+                << p.written << " written, " << p.skipped << " empty, " << p.failed << " failed ("
+                << (unsigned)(seconds > 0.0 ? (double)p.written / seconds : 0.0) << " tiles/s)   " << std::flush;
+        };
+
+    auto result = seeder.run(output, io);
+    std::cout << std::endl;
+
+    if (result.failed())
+    {
+        Log()->error("Seeding failed: {}", result.error().message);
+        return -1;
+    }
+
+    // record the seeded area so readers know where the data is.
+    output.setDataExtents({ DataExtent(seeder.extent.valid() ? seeder.extent : seeder.layer->extent(), seeder.minLevel, seeder.maxLevel) });
+    output.close();
+
+    Log()->info("Seeded {} tiles of {} into {}", result->written, seeder.layer->name, outFile);
+    return 0;
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+    std::cout << "rocky was built without MBTiles support" << std::endl;
+    return 0;
+}
+
+#endif // ROCKY_HAS_MBTILES
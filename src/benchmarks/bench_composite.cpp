@@ -0,0 +1,166 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * Compares GeoImage::composite against the original per-pixel implementation
+ * (column-major walk, one SRS transform per pixel per source, generic pixel
+ * reads and writes), with and without splitting rows across the job runtime.
+ *
+ * The sources mimic a terrain tile built from several imagery layers: an opaque
+ * base layer, a layer in a different SRS, and partially transparent overlays.
+ *
+ * Usage: rocky_bench_composite [--size N] [--layers N] [--iterations N]
+ */
+#include <rocky/rocky.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // The implementation of GeoImage::composite before it was rewritten.
+    void composite_legacy(GeoImage& dest, const std::vector<GeoImage>& sources, const std::vector<float>& opacities)
+    {
+        auto image = dest.image();
+        double x, y;
+
+        std::vector<SRSOperation> xforms;
+        xforms.reserve(sources.size());
+        for (auto& source : sources)
+            xforms.emplace_back(dest.srs().to(source.srs()));
+
+        std::vector<glm::fvec4> pixels;
+        pixels.reserve(sources.size());
+
+        for (unsigned s = 0; s < image->width(); ++s)
+        {
+            for (unsigned t = 0; t < image->height(); ++t)
+            {
+                dest.getCoord(s, t, x, y);
+
+                for (unsigned layer = 0; layer < image->depth(); ++layer)
+                {
+                    pixels.clear();
+
+                    for (int i = (int)sources.size() - 1; i >= 0; --i)
+                    {
+                        auto r = sources[i].read(xforms[i], x, y, layer);
+                        if (r.ok())
+                        {
+                            r.value().a *= opacities[i];
+                            float a = r.value().a;
+                            pixels.emplace_back(std::move(r.value()));
+                            if (a >= 1.0f)
+                                break;
+                        }
+                    }
+
+                    glm::fvec4 pixel(0, 0, 0, 0);
+                    auto n = (int)pixels.size();
+                    for (int i = n - 1; i >= 0; --i)
+                    {
+                        pixel = i == (n - 1) ? pixels[i] : glm::mix(pixel, pixels[i], pixels[i].a);
+                    }
+
+                    image->write(pixel, s, t, layer);
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<Image> make_source(unsigned size, unsigned seed, float alpha)
+    {
+        auto image = Image::create(Image::R8G8B8A8_UNORM, size, size);
+        image->eachPixel([&](const Image::iterator& i)
+            {
+                float r = (float)((i.s() * 7 + seed * 31) % 256) / 255.0f;
+                float g = (float)((i.t() * 5 + seed * 17) % 256) / 255.0f;
+                float b = (float)(((i.s() ^ i.t()) + seed) % 256) / 255.0f;
+                image->write(Image::Pixel(r, g, b, alpha), i);
+            });
+        return image;
+    }
+
+    template<typename FUNC>
+    double time_ms(unsigned iterations, FUNC&& func)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; ++i)
+            func();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / (double)iterations;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned size = 256, layers = 4, iterations = 20;
+
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (std::strcmp(argv[i], "--size") == 0)
+            size = (unsigned)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--layers") == 0)
+            layers = (unsigned)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = (unsigned)std::atoi(argv[++i]);
+    }
+
+    size = std::max(size, 2u);
+    layers = std::max(layers, 1u);
+    iterations = std::max(iterations, 1u);
+
+    Profile geo("global-geodetic");
+    Profile merc("spherical-mercator");
+    TileKey key(6, 40, 20, geo);
+
+    std::vector<GeoImage> sources;
+    std::vector<float> opacities;
+    for (unsigned i = 0; i < layers; ++i)
+    {
+        // the second layer is in a different SRS so its samples need a real transform
+        GeoExtent extent = key.extent();
+        if (i == 1)
+        {
+            auto keys = key.intersectingKeys(merc);
+            extent = keys.empty() ? key.extent() : keys.front().extent();
+        }
+
+        float alpha = i == 0 ? 1.0f : 0.6f;
+        sources.emplace_back(make_source(size, i, alpha), extent);
+        opacities.emplace_back(i == 0 ? 1.0f : 0.8f);
+    }
+
+    IOOptions io;
+
+    auto legacy = Image::create(Image::R8G8B8A8_UNORM, size, size);
+    auto serial = Image::create(Image::R8G8B8A8_UNORM, size, size);
+    auto parallel = Image::create(Image::R8G8B8A8_UNORM, size, size);
+    GeoImage legacy_geo(legacy, key.extent()), serial_geo(serial, key.extent()), parallel_geo(parallel, key.extent());
+
+    double legacy_ms = time_ms(iterations, [&]() { composite_legacy(legacy_geo, sources, opacities); });
+    double serial_ms = time_ms(iterations, [&]() { serial_geo.composite(sources, opacities); });
+    double parallel_ms = time_ms(iterations, [&]() { parallel_geo.composite(sources, opacities, &io); });
+
+    // count pixels that differ by more than one step from the legacy result
+    unsigned mismatches = 0;
+    auto* a = legacy->data<std::uint8_t>();
+    auto* b = serial->data<std::uint8_t>();
+    for (unsigned i = 0; i < legacy->sizeInBytes(); ++i)
+        if (std::abs((int)a[i] - (int)b[i]) > 1)
+            ++mismatches;
+
+    std::printf("composite %ux%u, %u layers, %u iterations\n\n", size, size, layers, iterations);
+    std::printf("%-10s %10s %10s\n", "method", "ms/tile", "speedup");
+    std::printf("%-10s %10.3f %10.2f\n", "legacy", legacy_ms, 1.0);
+    std::printf("%-10s %10.3f %10.2f\n", "serial", serial_ms, legacy_ms / serial_ms);
+    std::printf("%-10s %10.3f %10.2f\n", "parallel", parallel_ms, legacy_ms / parallel_ms);
+    std::printf("\nbytes differing from legacy by more than 1: %u\n", mismatches);
+
+    return 0;
+}
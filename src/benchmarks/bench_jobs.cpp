@@ -0,0 +1,149 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * Measures weejobs throughput for a large number of tiny jobs across a range
+ * of thread counts, comparing the job pool scheduling modes:
+ *
+ *   default  - shared queue, priorities evaluated on every dequeue
+ *   cached   - shared queue kept as a heap of cached priorities
+ *   stealing - per-worker lock-free deques with work stealing
+ *
+ * Two workloads are run for each mode:
+ *
+ *   external - the main thread dispatches every job
+ *   nested   - one root job per thread dispatches the tiny jobs from inside the
+ *              pool, unthrottled. The default mode is skipped here since its
+ *              O(n) dequeue is quadratic in the queue depth.
+ *
+ * Usage: rocky_bench_jobs [--jobs N] [--window N] [--max-threads N]
+ */
+#include <rocky/weejobs.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        unsigned jobs = 1000000;
+        unsigned window = 4096; // max jobs in flight; keeps the O(n) default mode tractable
+        unsigned maxThreads = 64;
+    };
+
+    void configure(jobs::jobpool* pool, const std::string& mode)
+    {
+        pool->set_cached_priorities(mode == "cached");
+        pool->set_work_stealing(mode == "stealing");
+    }
+
+    // waits until fewer than "window" jobs are in flight
+    inline void throttle(const std::atomic<unsigned>& done, unsigned submitted, unsigned window)
+    {
+        while (submitted - done.load(std::memory_order_relaxed) >= window)
+            std::this_thread::yield();
+    }
+
+    double external(jobs::runtime& rt, jobs::jobpool* pool, const Options& options)
+    {
+        std::atomic<unsigned> done = { 0u };
+        jobs::context context{ "tiny", pool };
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (unsigned i = 0; i < options.jobs; ++i)
+        {
+            throttle(done, i, options.window);
+            rt.dispatch([&done]() { done.fetch_add(1, std::memory_order_relaxed); }, context);
+        }
+
+        while (done < options.jobs)
+            std::this_thread::yield();
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    double nested(jobs::runtime& rt, jobs::jobpool* pool, unsigned threads, const Options& options)
+    {
+        std::atomic<unsigned> done = { 0u };
+        jobs::context context{ "tiny", pool };
+        unsigned perRoot = options.jobs / threads;
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (unsigned r = 0; r < threads; ++r)
+        {
+            rt.dispatch([&]()
+                {
+                    for (unsigned i = 0; i < perRoot; ++i)
+                        rt.dispatch([&done]() { done.fetch_add(1, std::memory_order_relaxed); }, context);
+                }, context);
+        }
+
+        while (done < perRoot * threads)
+            std::this_thread::yield();
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (std::strcmp(argv[i], "--jobs") == 0)
+            options.jobs = (unsigned)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--window") == 0)
+            options.window = (unsigned)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-threads") == 0)
+            options.maxThreads = (unsigned)std::atoi(argv[++i]);
+    }
+
+    options.jobs = std::max(options.jobs, 1u);
+    options.window = std::max(options.window, 1u);
+
+    std::printf("weejobs %s: %u jobs, window %u\n\n", WEEJOBS_VERSION_STRING, options.jobs, options.window);
+    std::printf("%-9s %-9s %8s %14s\n", "workload", "mode", "threads", "jobs/s");
+
+    const std::vector<std::string> modes = { "default", "cached", "stealing" };
+
+    for (auto& workload : { "external", "nested" })
+    {
+        for (auto& mode : modes)
+        {
+            if (std::strcmp(workload, "nested") == 0 && mode == "default")
+                continue;
+
+            for (unsigned threads = 1; threads <= options.maxThreads; threads *= 2)
+            {
+                // fresh runtime each time so no threads linger between runs
+                jobs::runtime rt;
+                auto pool = rt.get_pool("bench", threads);
+                configure(pool, mode);
+
+                double seconds = std::strcmp(workload, "external") == 0 ?
+                    external(rt, pool, options) :
+                    nested(rt, pool, threads, options);
+
+                unsigned count = std::strcmp(workload, "external") == 0 ?
+                    options.jobs : (options.jobs / threads) * threads;
+
+                std::printf("%-9s %-9s %8u %14.0f\n", workload, mode.c_str(), threads, (double)count / seconds);
+                std::fflush(stdout);
+
+                rt.shutdown();
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * Measures MBTiles::Driver::read throughput (tiles/s) across a range of reader
+ * thread counts, against a reference run that serializes every read behind one
+ * mutex the way the driver used to.
+ *
+ * Also times populating the database tile by tile with write() against the
+ * batched writeAsync() path, with and without deduplication.
+ *
+ * Tiles are stored with a trivial raw codec installed in the IOOptions services,
+ * so the numbers reflect the database and buffer handling rather than an image
+ * decoder.
+ *
+ * Usage: rocky_bench_mbtiles [--tiles N] [--size N] [--reads N] [--max-threads N] [--compress]
+ */
+#include <rocky/rocky.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ROCKY_NAMESPACE;
+
+#ifdef ROCKY_HAS_MBTILES
+
+namespace
+{
+    struct Options
+    {
+        unsigned tiles = 1024;
+        unsigned size = 256;
+        unsigned reads = 20000;
+        unsigned maxThreads = 16;
+        bool compress = false;
+    };
+
+    // raw codec: width, height, pixel format, then the pixel data
+    void installRawCodec(IOOptions& io)
+    {
+        io.services().writeImageToStream = [](std::shared_ptr<Image> image, std::ostream& out, std::string, const IOOptions&) -> Result<>
+            {
+                std::uint32_t header[3] = { image->width(), image->height(), (std::uint32_t)image->pixelFormat() };
+                out.write((const char*)header, sizeof(header));
+                out.write(image->data<char>(), image->sizeInBytes());
+                return ResultVoidOK;
+            };
+
+        io.services().readImageFromStream = [](std::istream& in, std::string, const IOOptions&) -> Result<std::shared_ptr<Image>>
+            {
+                std::uint32_t header[3];
+                if (!in.read((char*)header, sizeof(header)))
+                    return Failure_GeneralError;
+                auto image = Image::create((Image::PixelFormat)header[2], header[0], header[1]);
+                if (!in.read(image->data<char>(), image->sizeInBytes()))
+                    return Failure_GeneralError;
+                return image;
+            };
+    }
+
+    double run(const MBTiles::Driver& driver, const std::vector<TileKey>& keys, unsigned threads, bool serialize,
+        const Options& options, const IOOptions& io)
+    {
+        std::mutex mutex;
+        std::atomic<unsigned> failures = { 0u };
+        unsigned perThread = options.reads / threads;
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]()
+                {
+                    std::mt19937 random(t);
+                    for (unsigned i = 0; i < perThread; ++i)
+                    {
+                        auto& key = keys[random() % keys.size()];
+                        std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+                        if (serialize)
+                            lock.lock();
+                        if (driver.read(key, io).failed())
+                            failures.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        if (failures > 0)
+            std::printf("warning: %u reads failed\n", failures.load());
+
+        return (double)(perThread * threads) / seconds;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--compress") == 0)
+            options.compress = true;
+        else if (i + 1 < argc && std::strcmp(argv[i], "--tiles") == 0)
+            options.tiles = (unsigned)std::atoi(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--size") == 0)
+            options.size = (unsigned)std::atoi(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--reads") == 0)
+            options.reads = (unsigned)std::atoi(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--max-threads") == 0)
+            options.maxThreads = (unsigned)std::atoi(argv[++i]);
+    }
+
+    options.tiles = std::max(options.tiles, 1u);
+    options.size = std::max(options.size, 1u);
+    options.reads = std::max(options.reads, 1u);
+    options.maxThreads = std::max(options.maxThreads, 1u);
+
+    IOOptions io;
+    installRawCodec(io);
+
+    auto path = (std::filesystem::temp_directory_path() / "rocky_bench_mbtiles.mbtiles").string();
+
+    Profile profile("global-geodetic");
+    unsigned level = 0;
+    while (profile.numTiles(level).x * profile.numTiles(level).y < options.tiles)
+        ++level;
+
+    std::vector<TileKey> keys;
+    auto [cols, rows] = profile.numTiles(level);
+    for (unsigned y = 0; y < rows && keys.size() < options.tiles; ++y)
+        for (unsigned x = 0; x < cols && keys.size() < options.tiles; ++x)
+            keys.emplace_back(level, x, y, profile);
+
+    std::printf("mbtiles: %u tiles of %ux%u%s, %u reads per run\n\n", (unsigned)keys.size(), options.size, options.size,
+        options.compress ? " (zlib)" : "", options.reads);
+
+    MBTiles::Options dbOptions;
+    dbOptions.uri = URI(path);
+    dbOptions.format = "application/x-raw";
+    dbOptions.compress = options.compress;
+
+    // one image per distinct color; every 4th tile is identical, like open ocean
+    std::vector<std::shared_ptr<Image>> images;
+    for (auto& key : keys)
+    {
+        auto image = Image::create(Image::R8G8B8A8_UNORM, options.size, options.size);
+        if (key.x % 4 == 0)
+            image->fill(glm::fvec4(0.0f, 0.0f, 0.5f, 1.0f));
+        else
+            image->fill(glm::fvec4((float)(key.x % 256) / 255.0f, (float)(key.y % 256) / 255.0f, 0.5f, 1.0f));
+        images.emplace_back(image);
+    }
+
+    std::printf("%-22s %12s %12s\n", "populate", "tiles/s", "MB");
+
+    // populate the database three ways; the last one stays for the read test.
+    for (auto mode : { "write", "writeAsync+dedup", "writeAsync" })
+    {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + "-wal");
+        std::filesystem::remove(path + "-shm");
+
+        auto writeOptions = dbOptions;
+        writeOptions.deduplicate = std::strcmp(mode, "writeAsync+dedup") == 0;
+
+        MBTiles::Driver writer;
+        DataExtentList extents;
+        Profile p = profile;
+        auto r = writer.open("bench", writeOptions, true, p, extents, io);
+        if (r.failed())
+        {
+            std::printf("failed to create %s: %s\n", path.c_str(), r.error().message.c_str());
+            return 1;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (unsigned i = 0; i < keys.size(); ++i)
+        {
+            if (std::strcmp(mode, "write") == 0)
+                writer.write(keys[i], images[i], io);
+            else
+                writer.writeAsync(keys[i], images[i], io);
+        }
+
+        r = writer.flush();
+        if (r.failed())
+            std::printf("warning: %s\n", r.error().message.c_str());
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        writer.close();
+        double mb = (double)std::filesystem::file_size(path) / (1024.0 * 1024.0);
+        std::printf("%-22s %12.0f %12.1f\n", mode, (double)keys.size() / seconds, mb);
+    }
+    std::printf("\n");
+
+    MBTiles::Driver reader;
+    DataExtentList extents;
+    Profile p = profile;
+    auto r = reader.open("bench", dbOptions, false, p, extents, io);
+    if (r.failed())
+    {
+        std::printf("failed to open %s: %s\n", path.c_str(), r.error().message.c_str());
+        return 1;
+    }
+
+    std::printf("%8s %16s %16s %10s\n", "threads", "serialized/s", "parallel/s", "speedup");
+
+    for (unsigned threads = 1; threads <= options.maxThreads; threads *= 2)
+    {
+        double serialized = run(reader, keys, threads, true, options, io);
+        double parallel = run(reader, keys, threads, false, options, io);
+        std::printf("%8u %16.0f %16.0f %10.2f\n", threads, serialized, parallel, parallel / serialized);
+        std::fflush(stdout);
+    }
+
+    reader.close();
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + "-wal");
+    std::filesystem::remove(path + "-shm");
+
+    return 0;
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+    std::printf("rocky was built without MBTiles support\n");
+    return 0;
+}
+
+#endif // ROCKY_HAS_MBTILES
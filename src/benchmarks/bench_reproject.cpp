@@ -0,0 +1,129 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * Compares the generic tile reprojection used by ImageLayer::assembleTile and
+ * ElevationLayer::assembleTile (transform every output sample, then a generic
+ * GeoImage::read per sample per source) against the separable fast path in
+ * detail::mosaicImages and detail::mosaicHeightfields, for spherical mercator
+ * sources resampled into a geographic tile.
+ *
+ * Usage: rocky_bench_reproject [--size N] [--iterations N]
+ */
+#include <rocky/rocky.h>
+#include <rocky/Reprojection.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    template<typename FUNC>
+    double time_ms(unsigned iterations, FUNC&& func)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; ++i)
+            func();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / (double)iterations;
+    }
+
+    // the per-sample path both assembleTile methods used before the fast path
+    void generic(const GeoExtent& extent, bool pixelCenters, const std::vector<GeoImage>& sources, Image& output)
+    {
+        unsigned cols = output.width(), rows = output.height();
+        std::vector<glm::dvec3> points(cols * rows);
+
+        double dx = (extent.xmax() - extent.xmin()) / (double)(pixelCenters ? cols : cols - 1);
+        double dy = (extent.ymax() - extent.ymin()) / (double)(pixelCenters ? rows : rows - 1);
+        double offset = pixelCenters ? 0.5 : 0.0;
+        for (unsigned r = 0; r < rows; ++r)
+            for (unsigned c = 0; c < cols; ++c)
+                points[r * cols + c] = { extent.xmin() + dx * (offset + c), extent.ymin() + dy * (offset + r), 0.0 };
+
+        extent.srs().to(sources[0].srs()).transformArray(&points[0], points.size());
+
+        for (unsigned r = 0; r < rows; ++r)
+        {
+            for (unsigned c = 0; c < cols; ++c)
+            {
+                auto& p = points[r * cols + c];
+                Image::Pixel pixel(0, 0, 0, 0);
+                for (auto& source : sources)
+                {
+                    auto result = source.read(p.x, p.y);
+                    if (result.ok())
+                    {
+                        pixel = result.value();
+                        break;
+                    }
+                }
+                output.write(pixel, c, r);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned size = 256, iterations = 50;
+
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (std::strcmp(argv[i], "--size") == 0)
+            size = (unsigned)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = (unsigned)std::atoi(argv[++i]);
+    }
+
+    size = std::max(size, 3u);
+    iterations = std::max(iterations, 1u);
+
+    Profile merc("spherical-mercator");
+    TileKey key(6, 40, 20, Profile("global-geodetic"));
+    auto sourceKeys = key.intersectingKeys(merc);
+
+    std::vector<GeoImage> images, heightfields;
+    for (auto& sourceKey : sourceKeys)
+    {
+        auto image = Image::create(Image::R8G8B8A8_UNORM, size, size);
+        image->eachPixel([&](const Image::iterator& i) {
+            image->write(Image::Pixel(i.u(), i.v(), 0.5f, 1.0f), i); });
+        images.emplace_back(image, sourceKey.extent());
+
+        auto hf = Heightfield::create(size, size);
+        hf.image->eachPixel([&](const Image::iterator& i) {
+            hf.heightAt(i.s(), i.t()) = (float)(i.u() * 1000.0 + i.v() * 500.0); });
+        heightfields.emplace_back(hf.image, sourceKey.extent());
+    }
+
+    IOOptions io;
+    auto out = Image::create(Image::R8G8B8A8_UNORM, size, size);
+    auto outHF = Image::create(HF_WRITABLE_FORMAT, size, size);
+
+    double image_generic_ms = time_ms(iterations, [&]() {
+        generic(key.extent(), true, images, *out); });
+
+    double image_fast_ms = time_ms(iterations, [&]() {
+        detail::ReprojectionGrid grid(key.extent(), size, size, true, merc.srs());
+        detail::mosaicImages(grid, images, *out, io); });
+
+    double hf_generic_ms = time_ms(iterations, [&]() {
+        generic(key.extent(), false, heightfields, *outHF); });
+
+    double hf_fast_ms = time_ms(iterations, [&]() {
+        detail::ReprojectionGrid grid(key.extent(), size, size, false, merc.srs());
+        detail::mosaicHeightfields(grid, heightfields, *outHF, io); });
+
+    std::printf("reproject %ux%u, %u source tiles, %u iterations\n\n", size, size, (unsigned)sourceKeys.size(), iterations);
+    std::printf("%-12s %12s %12s %10s\n", "type", "generic ms", "fast ms", "speedup");
+    std::printf("%-12s %12.3f %12.3f %10.2f\n", "image", image_generic_ms, image_fast_ms, image_generic_ms / image_fast_ms);
+    std::printf("%-12s %12.3f %12.3f %10.2f\n", "heightfield", hf_generic_ms, hf_fast_ms, hf_generic_ms / hf_fast_ms);
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * Measures coordinate transform throughput (points per second) for the SRS
+ * pairs SRSOperation handles with built-in math, against the same pairs
+ * through PROJ, one point at a time and as arrays.
+ *
+ * Usage: rocky_bench_srs [--points N] [--iterations N]
+ */
+#include <rocky/rocky.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    template<typename FUNC>
+    double points_per_second(std::size_t points, unsigned iterations, FUNC&& func)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; ++i)
+            func();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return s > 0.0 ? (double)points * (double)iterations / s : 0.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned points = 1000000, iterations = 10;
+
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (std::strcmp(argv[i], "--points") == 0)
+            points = (unsigned)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = (unsigned)std::atoi(argv[++i]);
+    }
+
+    points = std::max(points, 1u);
+    iterations = std::max(iterations, 1u);
+
+    // random points on and above the earth, within mercator's latitude limits
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0), lat(-85.0, 85.0), alt(0.0, 10000.0);
+    std::vector<glm::dvec3> lla(points);
+    for (auto& p : lla)
+        p = { lon(rng), lat(rng), alt(rng) };
+
+    struct Pair {
+        const char* name;
+        const SRS& from;
+        const SRS& to;
+    };
+
+    Pair pairs[] = {
+        { "wgs84 > ecef", SRS::WGS84, SRS::ECEF },
+        { "ecef > wgs84", SRS::ECEF, SRS::WGS84 },
+        { "wgs84 > merc", SRS::WGS84, SRS::SPHERICAL_MERCATOR },
+        { "merc > wgs84", SRS::SPHERICAL_MERCATOR, SRS::WGS84 } };
+
+    std::printf("srs transforms, %u points, %u iterations (million points/sec)\n\n", points, iterations);
+    std::printf("%-14s %10s %10s %10s %10s %9s %9s\n", "pair", "proj", "native", "proj[]", "native[]", "speedup", "speedup[]");
+
+    for (auto& pair : pairs)
+    {
+        std::vector<glm::dvec3> input(lla);
+        if (!pair.from.isGeodetic())
+            SRS::WGS84.to(pair.from).transformArray(input.data(), input.size());
+
+        SRSOperation proj(pair.from, pair.to, false);
+        SRSOperation native(pair.from, pair.to, true);
+        std::vector<glm::dvec3> work(input.size());
+
+        auto single = [&](const SRSOperation& op) {
+            return points_per_second(input.size(), iterations, [&]() {
+                for (std::size_t i = 0; i < input.size(); ++i)
+                    op.transform(input[i], work[i]); });
+        };
+
+        auto array = [&](const SRSOperation& op) {
+            return points_per_second(input.size(), iterations, [&]() {
+                work = input;
+                op.transformArray(work.data(), work.size()); });
+        };
+
+        double proj_single = single(proj), native_single = single(native);
+        double proj_array = array(proj), native_array = array(native);
+
+        std::printf("%-14s %10.2f %10.2f %10.2f %10.2f %9.2f %9.2f%s\n", pair.name,
+            proj_single * 1e-6, native_single * 1e-6, proj_array * 1e-6, native_array * 1e-6,
+            native_single / proj_single, native_array / proj_array,
+            native.native() ? "" : "  (no native path!)");
+    }
+
+    return 0;
+}
@@ -120,8 +120,7 @@ AzureImageLayer::createTileImplementation(const TileKey& key, const IOOptions& i
         return fetch.error();
     }
 
-    std::istringstream stream(fetch->content.data);
-    auto image_rr = io.services().readImageFromStream(stream, fetch->content.type, io);
+    auto image_rr = io.services().readImageFromBuffer(fetch->content.data, fetch->content.type, io);
 
     if (image_rr.failed())
         return image_rr.error();
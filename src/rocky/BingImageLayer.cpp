@@ -135,9 +135,8 @@ BingImageLayer::createTileImplementation(const TileKey& key, const IOOptions& io
         return fetch.error();
     }
 
-    // Decode the stream:
-    std::istringstream stream(fetch->content.data);
-    auto image_rr = io.services().readImageFromStream(stream, fetch->content.type, io);
+    // Decode the data:
+    auto image_rr = io.services().readImageFromBuffer(fetch->content.data, fetch->content.type, io);
 
     if (image_rr.failed())
         return image_rr.error();
@@ -7,11 +7,13 @@
 
 #include <rocky/Common.h>
 #include <rocky/Utils.h>
+#include <atomic>
 #include <mutex>
 #include <shared_mutex>
 #include <list>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace ROCKY_NAMESPACE
 {
@@ -47,8 +49,8 @@ namespace ROCKY_NAMESPACE
             using entry_t = std::pair<std::weak_ptr<V>, METADATA>;
             mutable std::unordered_map<K, entry_t> _lut;
             mutable std::shared_mutex _mutex;
-            std::uint32_t _hits = 0;
-            std::uint32_t _misses = 0;
+            std::atomic_uint32_t _hits = { 0 };
+            std::atomic_uint32_t _misses = { 0 };
             std::uint32_t _puts = 0;
 
             using data_t = std::pair<std::shared_ptr<V>, METADATA>;
@@ -90,7 +92,7 @@ namespace ROCKY_NAMESPACE
 
             void clear()
             {
-                std::shared_lock lock(_mutex);
+                std::unique_lock lock(_mutex);
                 _lut.clear();
                 _hits = 0;
                 _misses = 0;
@@ -136,7 +138,7 @@ namespace ROCKY_NAMESPACE
             mutable typename std::list<E> _cache;
             mutable std::unordered_map<K, typename std::list<E>::iterator> _map;
             //mutable detail::vector_map<K, typename std::list<E>::iterator> _map;
-            std::uint32_t _hits = 0, _misses = 0;
+            std::atomic_uint32_t _hits = { 0 }, _misses = { 0 };
 
         public:
 
@@ -237,5 +239,264 @@ namespace ROCKY_NAMESPACE
                 _hits = 0, _misses = 0;
             }
         };
+
+        /**
+        * ShardedCache is a thread-safe, cost-bounded cache.
+        *
+        * Keys are distributed across N independently locked shards so that
+        * concurrent readers and writers rarely contend. Each shard evicts using
+        * the CLOCK algorithm (a cheap approximation of LRU): a hit only sets a
+        * "referenced" bit, and eviction sweeps a hand around the slots, giving
+        * referenced entries a second chance.
+        *
+        * The capacity is expressed in "cost" units as reported by a cost function.
+        * The default cost function returns 1 per entry, which makes the capacity an
+        * entry count; supply a function returning a size in bytes to bound the
+        * cache by memory use. Each shard gets an equal share of the capacity, so
+        * that share (maxEntryCost()) is also the largest entry the cache will take;
+        * put() drops a larger entry and counts it in rejections(). Use fewer shards
+        * if you need to cache large entries.
+        */
+        template<class K, class V>
+        class ShardedCache : public rocky::Cache<K, V>
+        {
+        public:
+            //! Function that returns the cost (e.g., size in bytes) of an entry
+            using CostFunction = std::function<std::size_t(const K&, const V&)>;
+
+            //! Constructs a cache.
+            //! \param capacity Maximum total cost of all entries
+            //! \param cost Cost function; default counts entries
+            //! \param numShards Number of lock-striped segments (rounded down to a power of two)
+            ShardedCache(std::size_t capacity = 32, CostFunction cost = {}, unsigned numShards = 16) :
+                _cost(cost)
+            {
+                // small caches don't benefit from many shards, and each shard
+                // must be able to hold a reasonable number of entries.
+                unsigned n = 1;
+                while (n * 2 <= std::max(numShards, 1u) && (capacity / (n * 2)) >= 8)
+                    n *= 2;
+                _shards = std::vector<Shard>(n);
+                setCapacity(capacity);
+            }
+
+            //! Sets the cache capacity and clears all current entries and statistics.
+            inline void setCapacity(std::size_t value)
+            {
+                clear();
+                _capacity = value;
+                _shardCapacity = value / _shards.size();
+            }
+
+            //! Retrieves the value associated with the given key, if present.
+            inline std::optional<V> get(const K& key) override
+            {
+                if (_shardCapacity == 0)
+                    return {};
+
+                auto& shard = shardFor(key);
+                std::scoped_lock L(shard.mutex);
+                auto it = shard.index.find(key);
+                if (it == shard.index.end())
+                {
+                    ++_misses;
+                    return {};
+                }
+                auto& slot = shard.slots[it->second];
+                slot.referenced = true;
+                ++_hits;
+                return slot.entry->second;
+            }
+
+            //! Inserts or updates the value for the given key,
+            //! evicting other entries as necessary to stay within capacity.
+            //! An entry costing more than maxEntryCost() is not cached (and an
+            //! existing entry for the key is removed).
+            inline void put(const K& key, const V& value) override
+            {
+                if (_shardCapacity == 0)
+                    return;
+
+                auto cost = _cost ? _cost(key, value) : 1;
+
+                auto& shard = shardFor(key);
+                std::scoped_lock L(shard.mutex);
+
+                // an update replaces the old entry, and the new one may be larger,
+                // so it goes through the same eviction as an insert.
+                bool updating = false;
+                auto it = shard.index.find(key);
+                if (it != shard.index.end())
+                {
+                    updating = true;
+                    release(shard, it->second);
+                    shard.index.erase(it);
+                }
+
+                if (cost > _shardCapacity)
+                {
+                    ++_rejections;
+                    return;
+                }
+
+                while (shard.cost + cost > _shardCapacity && !shard.index.empty())
+                {
+                    evictOne(shard);
+                }
+
+                std::size_t i;
+                if (!shard.free.empty())
+                {
+                    i = shard.free.back();
+                    shard.free.pop_back();
+                }
+                else
+                {
+                    i = shard.slots.size();
+                    shard.slots.emplace_back();
+                }
+
+                auto& slot = shard.slots[i];
+                slot.entry.emplace(key, value);
+                slot.cost = cost;
+                slot.referenced = updating;
+                shard.index[key] = i;
+                shard.cost += cost;
+                _bytes += cost;
+            }
+
+            //! Removes an entry from the cache, if present.
+            inline void remove(const K& key)
+            {
+                auto& shard = shardFor(key);
+                std::scoped_lock L(shard.mutex);
+                auto it = shard.index.find(key);
+                if (it != shard.index.end())
+                {
+                    release(shard, it->second);
+                    shard.index.erase(it);
+                }
+            }
+
+            //! Maximum total cost the cache can hold.
+            inline std::size_t capacity() const override
+            {
+                return _capacity;
+            }
+
+            //! Maximum cost of a single entry (the capacity of one shard).
+            inline std::size_t maxEntryCost() const
+            {
+                return _shardCapacity;
+            }
+
+            //! Number of entries in the cache.
+            std::size_t size() const override
+            {
+                std::size_t count = 0;
+                for (auto& shard : _shards)
+                {
+                    std::scoped_lock L(shard.mutex);
+                    count += shard.index.size();
+                }
+                return count;
+            }
+
+            //! Total cost of all entries in the cache (bytes, if the cost function reports bytes).
+            std::size_t bytes() const { return _bytes; }
+
+            std::uint32_t hits() const override { return _hits; }
+            std::uint32_t misses() const override { return _misses; }
+            std::uint32_t evictions() const { return _evictions; }
+
+            //! Number of entries put() dropped for costing more than maxEntryCost().
+            std::uint32_t rejections() const { return _rejections; }
+
+            //! Clears all entries from the cache and resets statistics.
+            inline void clear() override
+            {
+                for (auto& shard : _shards)
+                {
+                    std::scoped_lock L(shard.mutex);
+                    shard.slots.clear();
+                    shard.free.clear();
+                    shard.index.clear();
+                    shard.hand = 0;
+                    shard.cost = 0;
+                }
+                _bytes = 0;
+                _hits = 0, _misses = 0, _evictions = 0, _rejections = 0;
+            }
+
+        private:
+            struct Slot
+            {
+                std::optional<std::pair<K, V>> entry;
+                std::size_t cost = 0;
+                bool referenced = false;
+            };
+
+            struct Shard
+            {
+                mutable std::mutex mutex;
+                std::vector<Slot> slots;
+                std::vector<std::size_t> free;
+                std::unordered_map<K, std::size_t> index;
+                std::size_t hand = 0;
+                std::size_t cost = 0;
+            };
+
+            std::vector<Shard> _shards;
+            std::size_t _capacity = 0;
+            std::size_t _shardCapacity = 0;
+            CostFunction _cost;
+            std::atomic<std::size_t> _bytes = { 0 };
+            std::atomic_uint32_t _hits = { 0 }, _misses = { 0 }, _evictions = { 0 }, _rejections = { 0 };
+
+            inline Shard& shardFor(const K& key)
+            {
+                auto h = std::hash<K>()(key);
+                h ^= (h >> 17); // std::hash is the identity for integers on some platforms
+                return _shards[h & (_shards.size() - 1)];
+            }
+
+            // assumes the shard is locked
+            inline void release(Shard& shard, std::size_t i)
+            {
+                auto& slot = shard.slots[i];
+                shard.cost -= slot.cost;
+                _bytes -= slot.cost;
+                slot.entry.reset();
+                slot.cost = 0;
+                slot.referenced = false;
+                shard.free.push_back(i);
+            }
+
+            // CLOCK eviction; assumes the shard is locked and not empty
+            inline void evictOne(Shard& shard)
+            {
+                for (;;)
+                {
+                    if (shard.hand >= shard.slots.size())
+                        shard.hand = 0;
+
+                    auto i = shard.hand++;
+                    auto& slot = shard.slots[i];
+                    if (!slot.entry.has_value())
+                        continue;
+
+                    if (slot.referenced)
+                    {
+                        slot.referenced = false; // second chance
+                        continue;
+                    }
+
+                    shard.index.erase(slot.entry->first);
+                    release(shard, i);
+                    ++_evictions;
+                    return;
+                }
+            }
+        };
     }
 }
\ No newline at end of file
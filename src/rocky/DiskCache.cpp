@@ -0,0 +1,404 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#include "DiskCache.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#define LC "[DiskCache] "
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // File layout of a cache entry:
+    //   magic (4) | version (4) | timestamp (8) | expires (8)
+    //   | key | type | etag | lastModified | data
+    // where each variable-length field is a 64-bit length followed by the bytes.
+    // The fixed-size fields come first so that refresh() can rewrite the
+    // expiration time in place. The filename is detail::stableHash of the key,
+    // since it must be the same in every process (std::hash is not).
+    constexpr char MAGIC[4] = { 'R', 'K', 'Y', 'C' };
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::streamoff EXPIRES_OFFSET = 16;
+    constexpr const char* EXTENSION = ".rkc";
+
+    inline std::int64_t to_ms(std::chrono::system_clock::time_point t)
+    {
+        if (t == std::chrono::system_clock::time_point::max())
+            return std::numeric_limits<std::int64_t>::max();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    }
+
+    inline std::chrono::system_clock::time_point from_ms(std::int64_t ms)
+    {
+        if (ms == std::numeric_limits<std::int64_t>::max())
+            return std::chrono::system_clock::time_point::max();
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+    }
+
+    template<typename T>
+    inline void write_pod(std::string& buf, const T& value)
+    {
+        buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    inline void write_string(std::string& buf, const std::string& value)
+    {
+        write_pod(buf, (std::uint64_t)value.size());
+        buf.append(value);
+    }
+
+    template<typename T>
+    inline bool read_pod(std::istream& in, T& value)
+    {
+        return (bool)in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+
+    inline bool read_string(std::istream& in, std::string& value)
+    {
+        std::uint64_t len = 0;
+        if (!read_pod(in, len))
+            return false;
+        value.resize((std::size_t)len);
+        return len == 0 || (bool)in.read(value.data(), (std::streamsize)len);
+    }
+
+    inline std::string to_hex(std::uint64_t hash)
+    {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+        return buf;
+    }
+}
+
+DiskCache::DiskCache(const std::string& rootPath, std::uint64_t maxSizeBytes) :
+    _root(rootPath),
+    _maxSizeBytes(maxSizeBytes)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(_root, ec);
+    _valid = std::filesystem::is_directory(_root, ec);
+
+    if (_valid)
+    {
+        scan();
+        Log()->info(LC "Opened \"{}\" with {} entries ({} MB of {} MB)",
+            _root.string(), size(), _sizeInBytes / 1048576, _maxSizeBytes / 1048576);
+    }
+    else
+    {
+        Log()->warn(LC "Failed to create cache folder \"{}\"", _root.string());
+    }
+}
+
+std::filesystem::path
+DiskCache::pathFor(std::uint64_t hash) const
+{
+    auto hex = to_hex(hash);
+    return _root / hex.substr(0, 2) / hex.substr(2, 2) / (hex + EXTENSION);
+}
+
+void
+DiskCache::scan()
+{
+    struct Found {
+        std::uint64_t hash;
+        std::uint64_t bytes;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    for (auto i = std::filesystem::recursive_directory_iterator(_root, ec);
+        i != std::filesystem::recursive_directory_iterator();
+        i.increment(ec))
+    {
+        if (ec)
+            break;
+
+        if (!i->is_regular_file(ec))
+            continue;
+
+        auto& path = i->path();
+
+        // clean up any partial writes from a previous run
+        if (path.extension() == ".tmp")
+        {
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+
+        if (path.extension() != EXTENSION)
+            continue;
+
+        auto stem = path.stem().string();
+        if (stem.size() != 16)
+            continue;
+
+        Found f;
+        f.hash = std::strtoull(stem.c_str(), nullptr, 16);
+        f.bytes = i->file_size(ec);
+        f.mtime = i->last_write_time(ec);
+        found.emplace_back(f);
+    }
+
+    // most recently used first:
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+        return a.mtime > b.mtime; });
+
+    std::scoped_lock lock(_mutex);
+    _lru.clear();
+    _index.clear();
+    _sizeInBytes = 0;
+
+    for (auto& f : found)
+    {
+        _lru.emplace_back(IndexEntry{ f.hash, f.bytes });
+        _index[f.hash] = std::prev(_lru.end());
+        _sizeInBytes += f.bytes;
+    }
+
+    evict();
+}
+
+void
+DiskCache::touch(std::uint64_t hash)
+{
+    {
+        std::scoped_lock lock(_mutex);
+        auto i = _index.find(hash);
+        if (i == _index.end())
+            return;
+        if (i->second != _lru.begin())
+            _lru.splice(_lru.begin(), _lru, i->second);
+    }
+
+    // persist the access time so the LRU order survives a restart
+    std::error_code ec;
+    std::filesystem::last_write_time(pathFor(hash), std::filesystem::file_time_type::clock::now(), ec);
+}
+
+void
+DiskCache::record(std::uint64_t hash, std::uint64_t bytes)
+{
+    // assumes _mutex is locked
+    auto i = _index.find(hash);
+    if (i != _index.end())
+    {
+        _sizeInBytes -= i->second->bytes;
+        i->second->bytes = bytes;
+        _lru.splice(_lru.begin(), _lru, i->second);
+    }
+    else
+    {
+        _lru.emplace_front(IndexEntry{ hash, bytes });
+        _index[hash] = _lru.begin();
+    }
+    _sizeInBytes += bytes;
+}
+
+void
+DiskCache::forget(std::uint64_t hash)
+{
+    // assumes _mutex is locked
+    auto i = _index.find(hash);
+    if (i != _index.end())
+    {
+        _sizeInBytes -= i->second->bytes;
+        _lru.erase(i->second);
+        _index.erase(i);
+    }
+}
+
+void
+DiskCache::evict()
+{
+    // assumes _mutex is locked
+    std::error_code ec;
+    while (_sizeInBytes > _maxSizeBytes && !_lru.empty())
+    {
+        auto& victim = _lru.back();
+        std::filesystem::remove(pathFor(victim.hash), ec);
+        _sizeInBytes -= victim.bytes;
+        _index.erase(victim.hash);
+        _lru.pop_back();
+        ++_evictions;
+    }
+}
+
+std::optional<DiskCacheEntry>
+DiskCache::get(const std::string& key)
+{
+    if (!_valid)
+        return {};
+
+    auto hash = detail::stableHash(key);
+    {
+        std::scoped_lock lock(_mutex);
+        if (_index.find(hash) == _index.end())
+        {
+            ++_misses;
+            return {};
+        }
+    }
+
+    auto path = pathFor(hash);
+    std::ifstream in(path, std::ios::binary);
+
+    DiskCacheEntry entry;
+    char magic[4];
+    std::uint32_t version = 0;
+    std::int64_t timestamp = 0, expires = 0;
+    std::string storedKey;
+
+    bool ok =
+        in.read(magic, 4) &&
+        std::memcmp(magic, MAGIC, 4) == 0 &&
+        read_pod(in, version) && version == VERSION &&
+        read_pod(in, timestamp) &&
+        read_pod(in, expires) &&
+        read_string(in, storedKey) &&
+        read_string(in, entry.type) &&
+        read_string(in, entry.etag) &&
+        read_string(in, entry.lastModified) &&
+        read_string(in, entry.data);
+
+    in.close();
+
+    if (!ok)
+    {
+        // missing or corrupt; drop it from the index.
+        std::scoped_lock lock(_mutex);
+        forget(hash);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        ++_misses;
+        return {};
+    }
+
+    if (storedKey != key)
+    {
+        // hash collision; treat as a miss and let the next put() replace it.
+        ++_misses;
+        return {};
+    }
+
+    entry.timestamp = from_ms(timestamp);
+    entry.expires = from_ms(expires);
+
+    touch(hash);
+    ++_hits;
+    return entry;
+}
+
+void
+DiskCache::put(const std::string& key, const DiskCacheEntry& entry)
+{
+    if (!_valid || _maxSizeBytes == 0)
+        return;
+
+    auto hash = detail::stableHash(key);
+
+    std::string buf;
+    buf.reserve(entry.data.size() + key.size() + 256);
+    buf.append(MAGIC, 4);
+    write_pod(buf, VERSION);
+    write_pod(buf, to_ms(entry.timestamp));
+    write_pod(buf, to_ms(entry.expires));
+    write_string(buf, key);
+    write_string(buf, entry.type);
+    write_string(buf, entry.etag);
+    write_string(buf, entry.lastModified);
+    write_string(buf, entry.data);
+
+    auto path = pathFor(hash);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // write to a temporary file and rename it so readers never see a partial entry.
+    std::ostringstream tmpname;
+    tmpname << path.string() << '.' << std::this_thread::get_id() << ".tmp";
+    std::filesystem::path tmp(tmpname.str());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(buf.data(), (std::streamsize)buf.size()))
+        {
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+
+    std::scoped_lock lock(_mutex);
+    record(hash, buf.size());
+    evict();
+}
+
+void
+DiskCache::refresh(const std::string& key, Clock::time_point expires)
+{
+    if (!_valid)
+        return;
+
+    auto hash = detail::stableHash(key);
+    {
+        std::scoped_lock lock(_mutex);
+        if (_index.find(hash) == _index.end())
+            return;
+    }
+
+    std::fstream file(pathFor(hash), std::ios::binary | std::ios::in | std::ios::out);
+    if (file)
+    {
+        auto ms = to_ms(expires);
+        file.seekp(EXPIRES_OFFSET);
+        file.write(reinterpret_cast<const char*>(&ms), sizeof(ms));
+    }
+}
+
+void
+DiskCache::remove(const std::string& key)
+{
+    auto hash = detail::stableHash(key);
+    std::scoped_lock lock(_mutex);
+    forget(hash);
+    std::error_code ec;
+    std::filesystem::remove(pathFor(hash), ec);
+}
+
+void
+DiskCache::clear()
+{
+    std::scoped_lock lock(_mutex);
+    std::error_code ec;
+    for (auto& e : _lru)
+        std::filesystem::remove(pathFor(e.hash), ec);
+    _lru.clear();
+    _index.clear();
+    _sizeInBytes = 0;
+    _hits = 0, _misses = 0, _evictions = 0;
+}
+
+std::size_t
+DiskCache::size() const
+{
+    std::scoped_lock lock(_mutex);
+    return _index.size();
+}
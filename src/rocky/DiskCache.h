@@ -0,0 +1,142 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/Common.h>
+#include <rocky/Cache.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+    * One record in a DiskCache.
+    */
+    struct DiskCacheEntry
+    {
+        //! Content type (mime-type) of the data
+        std::string type;
+
+        //! The raw data
+        std::string data;
+
+        //! HTTP entity tag, for revalidation (If-None-Match)
+        std::string etag;
+
+        //! HTTP Last-Modified header, for revalidation (If-Modified-Since)
+        std::string lastModified;
+
+        //! Time at which the data was originally fetched
+        std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
+
+        //! Time after which the data must be revalidated before use
+        std::chrono::system_clock::time_point expires = std::chrono::system_clock::time_point::max();
+
+        //! Whether the entry can be used without revalidation
+        inline bool fresh() const {
+            return std::chrono::system_clock::now() < expires;
+        }
+
+        //! Whether the entry carries HTTP validators that allow revalidation
+        inline bool revalidatable() const {
+            return !etag.empty() || !lastModified.empty();
+        }
+    };
+
+    /**
+    * Persistent, size-bounded cache that stores blobs on the local filesystem.
+    *
+    * Entries are content-addressed by a stable 64-bit hash of their key and stored
+    * one per file under the root folder (root/ab/cd/abcd...). The cache keeps an
+    * in-memory LRU index of all entries and evicts the least recently used ones
+    * whenever the total size on disk exceeds the byte budget.
+    *
+    * Each entry carries the HTTP validators (ETag and Last-Modified) and an
+    * expiration time so that URI::read can revalidate stale content instead of
+    * downloading it again.
+    *
+    * The cache is thread-safe.
+    */
+    class ROCKY_EXPORT DiskCache : public rocky::Cache<std::string, DiskCacheEntry>
+    {
+    public:
+        using Clock = std::chrono::system_clock;
+
+        //! Opens (or creates) a disk cache at the given folder.
+        //! @param rootPath Folder in which to store the cache files
+        //! @param maxSizeBytes Maximum total size of all cached entries, in bytes
+        DiskCache(const std::string& rootPath, std::uint64_t maxSizeBytes = 1024ull * 1024ull * 1024ull);
+
+        //! Whether the cache opened successfully
+        bool valid() const { return _valid; }
+
+        //! Root folder of the cache
+        const std::filesystem::path& rootPath() const { return _root; }
+
+        //! Freshness lifetime to use for HTTP responses that do not specify one
+        std::chrono::seconds defaultMaxAge = std::chrono::hours(24 * 7);
+
+        //! Fetch an entry, or nothing if the entry is not in the cache.
+        //! Note: the returned entry may be stale; check DiskCacheEntry::fresh().
+        std::optional<DiskCacheEntry> get(const std::string& key) override;
+
+        //! Store an entry, evicting older entries as necessary to stay within budget
+        void put(const std::string& key, const DiskCacheEntry& entry) override;
+
+        //! Update the expiration time of an existing entry without rewriting its data
+        //! (e.g., after an HTTP 304 Not Modified response)
+        void refresh(const std::string& key, Clock::time_point expires);
+
+        //! Remove one entry from the cache
+        void remove(const std::string& key);
+
+        //! Delete all entries and reset statistics
+        void clear() override;
+
+        //! Maximum size of the cache in bytes
+        std::size_t capacity() const override { return (std::size_t)_maxSizeBytes; }
+
+        //! Number of entries in the cache
+        std::size_t size() const override;
+
+        //! Total size of all entries, in bytes
+        std::uint64_t sizeInBytes() const { return _sizeInBytes; }
+
+        std::uint32_t hits() const override { return _hits; }
+        std::uint32_t misses() const override { return _misses; }
+        std::uint32_t evictions() const { return _evictions; }
+
+    private:
+        struct IndexEntry
+        {
+            std::uint64_t hash = 0;
+            std::uint64_t bytes = 0;
+        };
+        using LRU = std::list<IndexEntry>;
+
+        std::filesystem::path _root;
+        std::uint64_t _maxSizeBytes;
+        bool _valid = false;
+        mutable std::mutex _mutex;
+        LRU _lru; // front = most recently used
+        std::unordered_map<std::uint64_t, LRU::iterator> _index;
+        std::atomic<std::uint64_t> _sizeInBytes = { 0 };
+        std::atomic_uint32_t _hits = { 0 }, _misses = { 0 }, _evictions = { 0 };
+
+        std::filesystem::path pathFor(std::uint64_t hash) const;
+        void scan();
+        void touch(std::uint64_t hash);
+        void record(std::uint64_t hash, std::uint64_t bytes);
+        void forget(std::uint64_t hash);
+        void evict();
+    };
+}
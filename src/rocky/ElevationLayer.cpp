@@ -5,6 +5,7 @@
  */
 #include "ElevationLayer.h"
 #include "Heightfield.h"
+#include "Reprojection.h"
 #include "json.h"
 
 #include <cinttypes>
@@ -204,9 +205,6 @@ ElevationLayer::assembleTile(const TileKey& key, const IOOptions& io) const
                 rows = std::max(rows, source.image()->height());
             }
 
-            // assume all tiles to mosaic are in the same SRS.
-            SRSOperation xform = key.extent().srs().to(sources[0].srs());
-
             // Now sort the heightfields by resolution to make sure we're sampling
             // the highest resolution one first.
             std::sort(
@@ -225,73 +223,60 @@ ElevationLayer::assembleTile(const TileKey& key, const IOOptions& io) const
             for (auto& source : sources)
                 output->dependencies.emplace_back(source.image());
 
-            // working set of points. it's much faster to xform an entire vector all at once.
-            std::vector<glm::dvec3> points;
-            points.resize(cols * rows);
-
+            // sample locations in the SRS of our source data tiles (we assume all
+            // tiles to mosaic are in the same SRS).
             // note, for elevation we sample edge to edge instead of on pixel-center.
-            double minx, miny, maxx, maxy;
-            key.extent().getBounds(minx, miny, maxx, maxy);
-            double dx = (maxx - minx) / (double)(cols-1);
-            double dy = (maxy - miny) / (double)(rows-1);
+            // Note, point.z will hold a vdatum offset if applicable.
+            detail::ReprojectionGrid grid(key.extent(), cols, rows, false, sources[0].srs());
 
-            // build a grid of sample points:
-            for (unsigned r = 0; r < rows; ++r)
+            // fast path for separable reprojections (e.g. geographic <-> mercator):
+            if (detail::mosaicHeightfields(grid, sources, *output, io))
             {
-                double y = miny + (dy * (double)r);
-                for (unsigned c = 0; c < cols; ++c)
-                {
-                    double x = minx + (dx * (double)c);
-                    points[r * cols + c] = { x, y, 0.0 };
-                }
+                if (io.canceled())
+                    return {};
             }
-
-            // transform the sample points to the SRS of our source data tiles.
-            // Note, point.z will hold a vdatum offset if applicable.
-            if (xform.valid())
+            else
             {
-                xform.transformArray(&points[0], points.size());
-            }
-
-            // indirect indexing is a trick that minimized the number of sources we
-            // need to iterate over, but we can only use it when all resolutions are
-            // the same.
-            std::vector<unsigned> indexes(sources.size());
-            std::iota(indexes.begin(), indexes.end(), 0);
-            bool useIndirectIndexing = (numSourcesAtFullResolution == sources.size());
-
-            // sample the heights:
-            for (unsigned r = 0; r < rows; ++r)
-            {
-                for (unsigned c = 0; c < cols; ++c)
+                // indirect indexing is a trick that minimized the number of sources we
+                // need to iterate over, but we can only use it when all resolutions are
+                // the same.
+                std::vector<unsigned> indexes(sources.size());
+                std::iota(indexes.begin(), indexes.end(), 0);
+                bool useIndirectIndexing = (numSourcesAtFullResolution == sources.size());
+
+                // sample the heights:
+                for (unsigned r = 0; r < rows; ++r)
                 {
-                    auto& point = points[r * cols + c];
+                    for (unsigned c = 0; c < cols; ++c)
+                    {
+                        auto point = grid.point(c, r);
 
-                    float& height = hf.heightAt(c, r);
+                        float& height = hf.heightAt(c, r);
 
-                    for (unsigned i = 0; i < sources.size(); ++i)
-                    {
-                        unsigned j = useIndirectIndexing ? indexes[i] : i;
+                        for (unsigned i = 0; i < sources.size(); ++i)
+                        {
+                            unsigned j = useIndirectIndexing ? indexes[i] : i;
+
+                            auto r = sources[j].read(point.x, point.y);
 
-                        auto r = sources[j].read(point.x, point.y);
+                            height = r.ok() ? r.value().r : NO_DATA_VALUE;
 
-                        height = r.ok() ? r.value().r : NO_DATA_VALUE;
+                            if (height != NO_DATA_VALUE)
+                            {
+                                std::swap(indexes[i], indexes[0]);
+                                break;
+                            }
+                        }
 
                         if (height != NO_DATA_VALUE)
                         {
-                            std::swap(indexes[i], indexes[0]);
-                            break;
+                            height -= point.z; // apply reverse vdatum offset
                         }
                     }
 
-                    if (height != NO_DATA_VALUE)
-                    {
-                        height -= point.z; // apply reverse vdatum offset
-                    }
+                    if (io.canceled())
+                        return {};
                 }
-
-                if (io.canceled())
-                    return {};
             }
         }
     }
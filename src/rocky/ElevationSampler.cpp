@@ -4,32 +4,334 @@
  * MIT License
  */
 #include "ElevationSampler.h"
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
 
 using namespace ROCKY_NAMESPACE;
 
-auto ElevationSampler::fetch(const TileKey& key, const IOOptions& io) const -> Result<GeoImage>
+namespace ROCKY_NAMESPACE
+{
+    namespace detail
+    {
+        /**
+        * Elevation tile requests shared by the asynchronous queries of an ElevationSampler.
+        * Holds the futures of the most recently requested tiles (pending or loaded),
+        * so that queries needing the same tile share a single fetch. Failed requests
+        * are dropped so the next query retries them, and everything is dropped when
+        * the layer (or its revision) changes.
+        */
+        struct ElevationRequests
+        {
+            using TileFuture = Future<Result<GeoImage>>;
+
+            struct Entry
+            {
+                TileKey key;
+                TileFuture future;
+                std::shared_ptr<std::atomic_bool> wanted; // false while only prefetched
+            };
+
+            std::mutex mutex;
+            std::list<Entry> lru; // most recently requested first
+            std::map<TileKey, std::list<Entry>::iterator> index;
+            std::size_t capacity = 128;
+            std::size_t coalesced = 0;
+            UID layerUID = -1;
+            Revision layerRevision = 0;
+
+            // assumes the mutex is locked
+            void erase(std::map<TileKey, std::list<Entry>::iterator>::iterator i)
+            {
+                lru.erase(i->second);
+                index.erase(i);
+            }
+        };
+    }
+}
+
+namespace
 {
-    // check the cache first.
-    if (cache)
+    Result<GeoImage> fetchTile(const ElevationLayer::Ptr& layer, const std::shared_ptr<Cache<TileKey, Result<GeoImage>>>& cache,
+        const TileKey& key, const IOOptions& io)
     {
-        auto r = cache->get(key);
-        if (r.has_value())
+        // check the cache first.
+        if (cache)
         {
-            return r.value();
+            auto r = cache->get(key);
+            if (r.has_value())
+            {
+                return r.value();
+            }
         }
+
+        // failing that, check the layer, and fall back to parent tiles if necessary.
+        for (auto k = key; k.valid(); k.makeParent())
+        {
+            auto r = layer->createTile(k, io);
+            if (r.ok())
+            {
+                if (cache)
+                    cache->put(key, r);
+                return r;
+            }
+        }
+
+        return Failure{};
     }
 
-    // failing that, check the layer, and fall back to parent tiles if necessary.
-    for (auto k = key; k.valid(); k.makeParent())
+    // Returns the pending or loaded request for a tile, dispatching a new fetch if there is none.
+    detail::ElevationRequests::TileFuture request(detail::ElevationRequests& requests,
+        const ElevationLayer::Ptr& layer, const std::shared_ptr<Cache<TileKey, Result<GeoImage>>>& cache,
+        const TileKey& key, bool prefetch, const IOOptions& io)
     {
-        auto r = layer->createTile(k, io);
-        if (r.ok())
+        std::scoped_lock lock(requests.mutex);
+
+        if (layer->uid() != requests.layerUID || layer->revision() != requests.layerRevision)
+        {
+            requests.lru.clear();
+            requests.index.clear();
+            requests.layerUID = layer->uid();
+            requests.layerRevision = layer->revision();
+        }
+
+        auto i = requests.index.find(key);
+        if (i != requests.index.end() && i->second->future.available() && i->second->future.value().failed())
+        {
+            requests.erase(i);
+            i = requests.index.end();
+        }
+
+        if (i != requests.index.end())
+        {
+            requests.lru.splice(requests.lru.begin(), requests.lru, i->second);
+            ++requests.coalesced;
+
+            // a prefetch that a query now needs gets the regular priority
+            if (!prefetch)
+                i->second->wanted->store(true);
+
+            return i->second->future;
+        }
+
+        auto wanted = std::make_shared<std::atomic_bool>(!prefetch);
+
+        auto& jobs = io.services().jobs;
+        jobs::context context;
+        context.name = prefetch ? "elevation prefetch" : "elevation fetch";
+        context.pool = jobs.get_pool("rocky::elevation_fetch", 4);
+        context.priority = [wanted]() { return wanted->load() ? 0.0f : -1.0f; };
+
+        // the fetch cancels itself if every holder of its future lets go (e.g. after eviction)
+        auto future = jobs.dispatch([layer, cache, key, io](Cancelable& c)
+            {
+                return fetchTile(layer, cache, key, io.with(c));
+            },
+            context);
+
+        requests.lru.emplace_front(detail::ElevationRequests::Entry{ key, future, wanted });
+        requests.index[key] = requests.lru.begin();
+
+        while (requests.lru.size() > requests.capacity)
+        {
+            requests.index.erase(requests.lru.back().key);
+            requests.lru.pop_back();
+        }
+
+        return future;
+    }
+
+    // Drops a finished request for a tile if it did not produce one, so the next query retries.
+    void forget(detail::ElevationRequests& requests, const TileKey& key)
+    {
+        std::scoped_lock lock(requests.mutex);
+
+        auto i = requests.index.find(key);
+        if (i != requests.index.end() && !i->second->future.working() &&
+            (!i->second->future.available() || i->second->future.value().failed()))
+        {
+            requests.erase(i);
+        }
+    }
+
+    // Clamps a batch of points, fetching all the tiles it needs at once.
+    std::vector<Result<GeoPoint>> clampBatch(const std::vector<GeoPoint>& points, const Distance& resolution,
+        const ElevationLayer::Ptr& layer, const std::shared_ptr<Cache<TileKey, Result<GeoImage>>>& cache,
+        detail::ElevationRequests& requests, unsigned prefetchRadius, const IOOptions& io)
+    {
+        std::vector<Result<GeoPoint>> results(points.size(), Failure_ResourceUnavailable);
+
+        if (!layer || !layer->status().ok())
+        {
+            results.assign(points.size(), Failure(Failure::ServiceUnavailable, "Elevation layer is not set or not open"));
+            return results;
+        }
+
+        if (points.empty())
+            return results;
+
+        auto& profile = layer->profile;
+
+        // same level selection as ElevationSession:
+        Angle referenceLatitude;
+        if (points.front().valid())
+            referenceLatitude = Angle(points.front().transform(points.front().srs.geodeticSRS()).y, Units::DEGREES);
+
+        double r = profile.srs().transformDistance(resolution, profile.srs().units(), referenceLatitude);
+        unsigned level = profile.levelOfDetailForHorizResolution(r, layer->tileSize);
+
+        // group the points by the tile holding their data:
+        std::vector<glm::dvec3> local(points.size());
+        std::vector<SRSOperation> xforms(points.size());
+        std::map<TileKey, std::vector<unsigned>> groups;
+        SRSOperation xform;
+
+        for (unsigned i = 0; i < points.size(); ++i)
         {
-            if (cache)
-                cache->put(key, r);
-            return r;
+            auto& p = points[i];
+            if (!p.valid())
+                continue;
+
+            if (xform.from() != p.srs)
+                xform = p.srs.to(profile.srs());
+
+            xforms[i] = xform;
+            local[i] = glm::dvec3(p.x, p.y, p.z);
+            if (!xform.transform(local[i], local[i]))
+                continue;
+
+            auto key = TileKey::createTileKeyContainingPoint(local[i].x, local[i].y, level, profile);
+            if (!key.valid())
+                continue;
+
+            auto best = layer->bestAvailableTileKey(key);
+            if (best.valid())
+                groups[best].push_back(i);
         }
+
+        // request every tile first so they all load in parallel...
+        struct Pending {
+            const TileKey* key;
+            const std::vector<unsigned>* indices;
+            detail::ElevationRequests::TileFuture future;
+        };
+        std::vector<Pending> pending;
+        for (auto& [key, indices] : groups)
+        {
+            pending.emplace_back(Pending{ &key, &indices, request(requests, layer, cache, key, false, io) });
+        }
+
+        // ...then the tiles around them, so points on the move find their next tile ready.
+        int radius = (int)prefetchRadius;
+        for (auto& group : groups)
+        {
+            for (int dy = -radius; dy <= radius; ++dy)
+            {
+                for (int dx = -radius; dx <= radius; ++dx)
+                {
+                    if (dx == 0 && dy == 0)
+                        continue;
+
+                    auto neighbor = group.first.createNeighborKey(dx, dy);
+                    if (neighbor.valid())
+                    {
+                        // the key a query for a point in that tile would ask for:
+                        auto best = layer->bestAvailableTileKey(neighbor);
+                        if (best.valid() && groups.find(best) == groups.end())
+                            request(requests, layer, cache, best, true, io);
+                    }
+                }
+            }
+        }
+
+        for (auto& [key, indices, future] : pending)
+        {
+            bool available = future.wait(&io);
+
+            if (io.canceled())
+                break;
+
+            if (!available || future.value().failed())
+            {
+                forget(requests, *key);
+                continue;
+            }
+
+            GeoHeightfield hf(future.value().value());
+
+            for (auto i : *indices)
+            {
+                auto h = hf.read(local[i].x, local[i].y);
+                if (h.ok())
+                {
+                    glm::dvec3 clamped(local[i].x, local[i].y, h.value());
+                    if (xforms[i].inverse(clamped, clamped))
+                        results[i] = GeoPoint(points[i].srs, clamped);
+                }
+            }
+        }
+
+        return results;
     }
+}
+
+ElevationSampler::ElevationSampler() :
+    _requests(std::make_shared<detail::ElevationRequests>())
+{
+    //nop
+}
+
+auto ElevationSampler::fetch(const TileKey& key, const IOOptions& io) const -> Result<GeoImage>
+{
+    return fetchTile(layer, cache, key, io);
+}
+
+auto ElevationSampler::clampAsync(std::vector<GeoPoint> points, const Distance& resolution, const IOOptions& io) const
+    -> Future<std::vector<Result<GeoPoint>>>
+{
+    auto& jobs = io.services().jobs;
+    jobs::context context{ "elevation query", jobs.get_pool("rocky::elevation", 2) };
+
+    return jobs.dispatch(
+        [points(std::move(points)), resolution, layer(layer), cache(cache), requests(_requests), radius(prefetchRadius), io](Cancelable& c)
+        {
+            return clampBatch(points, resolution, layer, cache, *requests, radius, io.with(c));
+        },
+        context);
+}
+
+auto ElevationSampler::sampleAsync(std::vector<GeoPoint> points, const Distance& resolution, const IOOptions& io) const
+    -> Future<std::vector<Result<ElevationSample>>>
+{
+    auto& jobs = io.services().jobs;
+    jobs::context context{ "elevation query", jobs.get_pool("rocky::elevation", 2) };
 
-    return Failure{};
+    return jobs.dispatch(
+        [points(std::move(points)), resolution, layer(layer), cache(cache), requests(_requests), radius(prefetchRadius), io](Cancelable& c)
+        {
+            auto clamped = clampBatch(points, resolution, layer, cache, *requests, radius, io.with(c));
+
+            // report heights relative to the geodetic SRS of each input point, like sample()
+            std::vector<Result<ElevationSample>> results;
+            results.reserve(clamped.size());
+            for (auto& p : clamped)
+            {
+                if (p.failed())
+                    results.emplace_back(p.error());
+                else if (p.value().srs.isGeodetic())
+                    results.emplace_back(ElevationSample{ (float)p.value().z });
+                else
+                    results.emplace_back(ElevationSample{ (float)p.value().transform(p.value().srs.geodeticSRS()).z });
+            }
+            return results;
+        },
+        context);
+}
+
+std::size_t
+ElevationSampler::coalescedRequests() const
+{
+    std::scoped_lock lock(_requests->mutex);
+    return _requests->coalesced;
 }
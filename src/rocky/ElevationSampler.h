@@ -5,12 +5,20 @@
  */
 #pragma once
 #include <rocky/ElevationLayer.h>
+#include <algorithm>
 #include <array>
+#include <iterator>
+#include <vector>
 
 namespace ROCKY_NAMESPACE
 {
     class ElevationSession;
 
+    namespace detail
+    {
+        struct ElevationRequests;
+    }
+
     /**
     * A sample of elevation data.
     */
@@ -36,6 +44,20 @@ namespace ROCKY_NAMESPACE
     *   auto session = sampler.session(io);
     *   session.srs = mySRS; // required, SRS of incoming points
     *   session.clampRange(points.begin(), points.end(); // clamps a range of points
+    *
+    * To clamp as many points as possible instead of stopping at the first one
+    * without data, pass a vector to receive per-point results:
+    *
+    *   std::vector<bool> clamped;
+    *   auto count = session.clampRange(points.begin(), points.end(), clamped);
+    *
+    * To keep the calling thread free of tile I/O, query a batch of points
+    * asynchronously and collect the results later (e.g., on the next frame):
+    *
+    *   auto results = sampler.sampleAsync(points, io);
+    *   ...
+    *   if (results.available())
+    *      // results.value()[i] holds the sample for points[i].
     */
     class ROCKY_EXPORT ElevationSampler
     {
@@ -49,7 +71,13 @@ namespace ROCKY_NAMESPACE
         //! Optional cache for fetching elevation tiles
         std::shared_ptr<Cache<TileKey, Result<GeoImage>>> cache;
 
+        //! Number of rings of neighboring tiles to prefetch around the tiles
+        //! that an asynchronous query needs (0 = no prefetching)
+        unsigned prefetchRadius = 1u;
+
     public:
+        //! Construct a sampler. Copies of a sampler share their asynchronous requests.
+        ElevationSampler();
 
         //! Is this sampler OK to use?
         inline bool ok() const {
@@ -69,6 +97,37 @@ namespace ROCKY_NAMESPACE
         template<class VEC3_ITER>
         inline Result<> clampRange(const SRS& srs, VEC3_ITER begin, VEC3_ITER end, const IOOptions& io) const;
 
+        //! Clamp a vector of 3D points, continuing past points for which there is no data.
+        //! @param results Set to true for each point that was clamped, false for each point left as is
+        //! @return Number of points clamped
+        template<class VEC3_ITER>
+        inline std::size_t clampRange(const SRS& srs, VEC3_ITER begin, VEC3_ITER end, std::vector<bool>& results, const IOOptions& io) const;
+
+
+        //! Asynchronously computes the heights at a batch of points (in any SRS).
+        //! Tile requests are shared by all pending asynchronous queries on this sampler
+        //! (and its copies), and recently loaded tiles are kept for subsequent queries.
+        //! @param points Points to sample
+        //! @param resolution Resolution of the elevation data to sample (zero = best available)
+        //! @param io IO options
+        //! @return Future result holding one sample, or a failure, per point
+        Future<std::vector<Result<ElevationSample>>> sampleAsync(std::vector<GeoPoint> points,
+            const Distance& resolution, const IOOptions& io) const;
+
+        //! Asynchronously computes the heights at a batch of points at the best available resolution.
+        inline Future<std::vector<Result<ElevationSample>>> sampleAsync(std::vector<GeoPoint> points, const IOOptions& io) const {
+            return sampleAsync(std::move(points), Distance{}, io);
+        }
+
+        //! Asynchronously clamps a batch of points (in any SRS) to the elevation data.
+        //! Shares tile requests like sampleAsync.
+        //! @return Future result holding one clamped point, or a failure, per point
+        Future<std::vector<Result<GeoPoint>>> clampAsync(std::vector<GeoPoint> points,
+            const Distance& resolution, const IOOptions& io) const;
+
+        //! Number of tile requests served by an asynchronous request already
+        //! pending or loaded instead of a new fetch (for diagnostics)
+        std::size_t coalescedRequests() const;
 
         //! Construct a new query envelope.
         //! This is more efficient when you plan to query multiple points in a localized area.
@@ -82,6 +141,8 @@ namespace ROCKY_NAMESPACE
         //! Fetches a new heightfield for a key.
         Result<GeoImage> fetch(const TileKey&, const IOOptions& io) const;
         friend class ElevationSession;
+
+        std::shared_ptr<detail::ElevationRequests> _requests;
     };
 
 
@@ -107,10 +168,33 @@ namespace ROCKY_NAMESPACE
         //! Reference latitude for resolution calculations (optional).
         Angle referenceLatitude = {};
 
+        //! Number of elevation tiles to keep in the session's working set. A few tiles
+        //! go a long way when points straddle tile boundaries.
+        unsigned workingSetSize = 8u;
+
+        //! Whether to sample the points of a range grouped by tile instead of in order.
+        //! This helps with scattered points that would otherwise cycle through more
+        //! tiles than the working set holds. Only the sampling order changes; the
+        //! points themselves are not reordered.
+        bool sortByTile = false;
+
         //! Clamps a range of points. All points are expected to be in the "srs" SRS.
+        //! @return False as soon as a point cannot be clamped
         template<class VEC3_ITER>
         inline bool clampRange(VEC3_ITER begin, VEC3_ITER end) const;
 
+        //! Clamps a range of points, continuing past points for which there is no data.
+        //! All points are expected to be in the "srs" SRS.
+        //! @param results Set to true for each point that was clamped, false for each point left as is
+        //! @return Number of points clamped
+        template<class VEC3_ITER>
+        inline std::size_t clampRange(VEC3_ITER begin, VEC3_ITER end, std::vector<bool>& results) const;
+
+        //! Number of tile fetches made by this session (for diagnostics)
+        inline std::size_t fetches() const {
+            return _fetches;
+        }
+
         //! Force a cache purge if you changed the lod or resolution.
         inline void dirty() {
             _pw = -1.0;
@@ -132,14 +216,16 @@ namespace ROCKY_NAMESPACE
         mutable SRSOperation _xform;
         const ElevationSampler* _sampler = nullptr;
 
-        // cache:
-        struct {
-            mutable std::uint32_t tx = UINT_MAX, ty = UINT_MAX;
-            mutable TileKey key;
-            mutable Status status;
-            mutable GeoImage hf;
-        }
-        _cache;
+        // working set of tiles, most recently used first:
+        struct CachedTile
+        {
+            std::uint32_t tx = UINT_MAX, ty = UINT_MAX;
+            TileKey key;
+            Status status;
+            GeoImage hf;
+        };
+        mutable std::vector<CachedTile> _tiles;
+        mutable std::size_t _fetches = 0;
 
         friend class ElevationSampler;
 
@@ -150,8 +236,14 @@ namespace ROCKY_NAMESPACE
             return { out_tx, out_ty };
         }
 
+        inline void prepare() const;
+
+        inline const CachedTile& tileAt(std::uint32_t tx, std::uint32_t ty) const;
+
+        inline bool sampleTransformed(double x, double y, const CachedTile& tile, float& height) const;
+
         template<typename VEC3_ITER>
-        inline bool clampTransformedRange(VEC3_ITER begin, VEC3_ITER end) const;
+        inline std::size_t clampTransformedRange(VEC3_ITER begin, VEC3_ITER end, std::vector<bool>* results) const;
     };
 
 
@@ -226,6 +318,20 @@ namespace ROCKY_NAMESPACE
         return sesh.clampRange(begin, end);
     }
 
+    template<class VEC3_ITER>
+    std::size_t ElevationSampler::clampRange(const SRS& srs, VEC3_ITER begin, VEC3_ITER end, std::vector<bool>& results, const IOOptions& io) const
+    {
+        results.assign(std::distance(begin, end), false);
+
+        if (!layer || !layer->status().ok() || begin == end)
+            return 0;
+
+        auto sesh = session(io);
+        sesh.srs = srs;
+        sesh.referenceLatitude = begin->y;
+        return sesh.clampRange(begin, end, results);
+    }
+
     template<class VEC3_ITER>
     bool ElevationSession::clampRange(VEC3_ITER begin, VEC3_ITER end) const
     {
@@ -242,7 +348,7 @@ namespace ROCKY_NAMESPACE
 
         _xform.transformRange(begin, end);
 
-        bool result = clampTransformedRange(begin, end);
+        bool result = clampTransformedRange(begin, end, nullptr) == (std::size_t)std::distance(begin, end);
 
         if (result)
             _xform.inverseRange(begin, end);
@@ -251,74 +357,156 @@ namespace ROCKY_NAMESPACE
     }
 
     template<class VEC3_ITER>
-    bool ElevationSession::clampTransformedRange(VEC3_ITER begin, VEC3_ITER end) const
+    std::size_t ElevationSession::clampRange(VEC3_ITER begin, VEC3_ITER end, std::vector<bool>& results) const
+    {
+        results.assign(std::distance(begin, end), false);
+
+        if (!_sampler->layer || !_sampler->layer->status().ok() || begin == end)
+            return 0;
+
+        if (_xform.from() != srs)
+        {
+            _xform = srs.to(_sampler->layer->profile.srs());
+        }
+
+        _xform.transformRange(begin, end);
+
+        auto count = clampTransformedRange(begin, end, &results);
+
+        // unlike the all-or-nothing version, always restore the input SRS
+        _xform.inverseRange(begin, end);
+
+        return count;
+    }
+
+    void ElevationSession::prepare() const
+    {
+        if (_pw <= 0.0)
+        {
+            auto& profile = _sampler->layer->profile;
+
+            if (level == UINT_MAX)
+            {
+                double r = profile.srs().transformDistance(resolution, profile.srs().units(), referenceLatitude);
+                const_cast<ElevationSession*>(this)->level = profile.levelOfDetailForHorizResolution(r, _sampler->layer->tileSize);
+            }
+
+            _pw = profile.extent().width();
+            _ph = profile.extent().height();
+            _pxmin = profile.extent().xmin();
+            _pymin = profile.extent().ymin();
+            _numtiles = profile.numTiles(level);
+            _tiles.clear();
+        }
+    }
+
+    auto ElevationSession::tileAt(std::uint32_t tx, std::uint32_t ty) const -> const CachedTile&
     {
-        for (auto iter = begin; iter != end; ++iter)
+        // most recently used tile first; the working set is small so a linear search wins.
+        for (auto i = _tiles.begin(); i != _tiles.end(); ++i)
         {
-            if (_pw <= 0.0)
+            if (i->tx == tx && i->ty == ty)
             {
-                auto& profile = _sampler->layer->profile;
-
-                if (level == UINT_MAX)
-                {
-                    double r = profile.srs().transformDistance(resolution, profile.srs().units(), referenceLatitude);
-                    const_cast<ElevationSession*>(this)->level = profile.levelOfDetailForHorizResolution(r, _sampler->layer->tileSize);
-                }
-
-                _pw = profile.extent().width();
-                _ph = profile.extent().height();
-                _pxmin = profile.extent().xmin();
-                _pymin = profile.extent().ymin();
-                _numtiles = profile.numTiles(level);
-                _cache.tx = UINT_MAX;
-                _cache.ty = UINT_MAX;
-                _cache.status = Failure{};
+                if (i != _tiles.begin())
+                    std::rotate(_tiles.begin(), i, i + 1);
+                return _tiles.front();
             }
+        }
+
+        // miss: reuse the least recently used slot if the working set is full.
+        if (_tiles.size() >= std::max(workingSetSize, 1u))
+            _tiles.pop_back();
+
+        CachedTile tile;
+        tile.tx = tx, tile.ty = ty;
+        tile.key = _sampler->layer->bestAvailableTileKey(TileKey(level, tx, ty, _sampler->layer->profile));
+        if (tile.key.valid())
+        {
+            ++_fetches;
+            auto r = _sampler->fetch(tile.key, *_io);
+            if (r.ok())
+                tile.hf = std::move(r.value());
+            else
+                tile.status = r.error();
+        }
+        else
+        {
+            // no data here; remember that too so we don't ask again.
+            tile.status = Failure{};
+        }
+
+        _tiles.emplace(_tiles.begin(), std::move(tile));
+        return _tiles.front();
+    }
+
+    bool ElevationSession::sampleTransformed(double x, double y, const CachedTile& tile, float& height) const
+    {
+        if (tile.status.failed())
+            return false;
 
-            auto& x = iter->x;
-            auto& y = iter->y;
-            auto& z = iter->z;
+        auto r = GeoHeightfield(tile.hf).read(x, y);
+        if (r.ok())
+            height = r.value();
+        return r.ok();
+    }
 
-            // simple ONE TILE caching internally.
-            auto [new_tx, new_ty] = tile(x, y);
+    template<class VEC3_ITER>
+    std::size_t ElevationSession::clampTransformedRange(VEC3_ITER begin, VEC3_ITER end, std::vector<bool>* results) const
+    {
+        prepare();
 
-            if (new_tx != _cache.tx || _cache.ty != new_ty)
+        std::size_t count = 0;
+
+        if (sortByTile)
+        {
+            // bucket the points by tile so each tile is visited once.
+            struct Entry {
+                std::uint64_t tile;
+                std::size_t index;
+                decltype(&*begin) point;
+            };
+            std::vector<Entry> entries;
+            std::size_t index = 0;
+            for (auto iter = begin; iter != end; ++iter, ++index)
             {
-                _cache.status.clear();
-
-                _cache.key = _sampler->layer->bestAvailableTileKey(TileKey(level, new_tx, new_ty, _sampler->layer->profile));
-                if (_cache.key.valid())
-                {
-                    auto r = _sampler->fetch(_cache.key, *_io);
-                    if (r.ok())
-                        _cache.hf = std::move(r.value());
-                    else
-                        _cache.status = r.error();
-
-                    _cache.tx = new_tx, _cache.ty = new_ty;
-                }
-                else
-                {
-                    // invalid data
-                    _cache.tx = UINT_MAX, _cache.ty = UINT_MAX;
-                    _cache.status = Failure{};
-                }
+                auto [tx, ty] = tile(iter->x, iter->y);
+                entries.emplace_back(Entry{ ((std::uint64_t)ty << 32) | tx, index, &*iter });
             }
 
-            if (_cache.status.ok())
+            std::stable_sort(entries.begin(), entries.end(),
+                [](const Entry& lhs, const Entry& rhs) { return lhs.tile < rhs.tile; });
+
+            for (auto& entry : entries)
             {
-                auto r = GeoHeightfield(_cache.hf).read(x, y);
-                if (r.ok())
-                    z = r.value();
-                else
-                    return false;
+                auto& cached = tileAt((std::uint32_t)(entry.tile & 0xffffffff), (std::uint32_t)(entry.tile >> 32));
+                float height;
+                bool ok = sampleTransformed(entry.point->x, entry.point->y, cached, height);
+                if (ok)
+                    entry.point->z = height, ++count;
+                if (results)
+                    (*results)[entry.index] = ok;
+                else if (!ok)
+                    return count;
             }
-            else
+        }
+        else
+        {
+            std::size_t index = 0;
+            for (auto iter = begin; iter != end; ++iter, ++index)
             {
-                return false;
+                auto [tx, ty] = tile(iter->x, iter->y);
+                auto& cached = tileAt(tx, ty);
+                float height;
+                bool ok = sampleTransformed(iter->x, iter->y, cached, height);
+                if (ok)
+                    iter->z = height, ++count;
+                if (results)
+                    (*results)[index] = ok;
+                else if (!ok)
+                    return count;
             }
         }
 
-        return true;
+        return count;
     }
 }
@@ -18,6 +18,8 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::detail;
@@ -237,6 +239,80 @@ namespace ROCKY_NAMESPACE
 
             return (err == CE_None);
         }
+
+        // Source pixels and weights contributing to one interpolated sample along one axis
+        struct Taps
+        {
+            int index[4];
+            float weight[4];
+            int count = 0;
+        };
+
+        // Computes the taps for pixel coordinate p (pixel i covers [i, i+1)) in a raster of the
+        // given size, relative to the window origin. Kernels center on pixel centers, i.e. apply
+        // the half-pixel DEM offset, and clamp to the raster edge like InterpolateAtPoint.
+        inline Taps makeTaps(double p, int size, int origin, Interpolation interpolation)
+        {
+            Taps t;
+            auto clamp = [&](int i) { return std::clamp(i, 0, size - 1) - origin; };
+
+            if (interpolation == Interpolation::Nearest)
+            {
+                t.index[0] = clamp((int)std::floor(p));
+                t.weight[0] = 1.0f;
+                t.count = 1;
+                return t;
+            }
+
+            double u = p - 0.5;
+            int i0 = (int)std::floor(u);
+            double f = u - (double)i0;
+
+            if (interpolation == Interpolation::Cubic || interpolation == Interpolation::CubicSpline)
+            {
+                // Keys (a = -0.5) or cubic B-spline kernel, evaluated at distances 1+f, f, 1-f, 2-f
+                auto kernel = [&](double x)
+                    {
+                        x = std::abs(x);
+                        if (interpolation == Interpolation::Cubic)
+                            return x <= 1.0 ? (1.5 * x - 2.5) * x * x + 1.0 : x < 2.0 ? ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0 : 0.0;
+                        else
+                            return x <= 1.0 ? (4.0 - 6.0 * x * x + 3.0 * x * x * x) / 6.0 : x < 2.0 ? (2.0 - x) * (2.0 - x) * (2.0 - x) / 6.0 : 0.0;
+                    };
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    t.index[k] = clamp(i0 - 1 + k);
+                    t.weight[k] = (float)kernel(f + 1.0 - (double)k);
+                }
+                t.count = 4;
+            }
+            else // Bilinear, Average
+            {
+                t.index[0] = clamp(i0);
+                t.index[1] = clamp(i0 + 1);
+                t.weight[0] = (float)(1.0 - f);
+                t.weight[1] = (float)f;
+                t.count = 2;
+            }
+            return t;
+        }
+
+        // Interpolates one sample from a window of source values in which nodata values are NaN.
+        // Returns NaN if any of the taps is nodata.
+        inline float interpolate(const float* window, int stride, const Taps& tx, const Taps& ty)
+        {
+            float sum = 0.0f;
+            for (int j = 0; j < ty.count; ++j)
+            {
+                const float* row = window + (std::ptrdiff_t)ty.index[j] * stride;
+                for (int i = 0; i < tx.count; ++i)
+                {
+                    sum += ty.weight[j] * tx.weight[i] * row[tx.index[i]];
+                }
+            }
+            return sum;
+        }
     }
 
     namespace GDAL_detail
@@ -1323,6 +1399,129 @@ GDAL_detail::Driver::getInterpolatedDEMValue(GDALRasterBand* band, double x, dou
     return result;
 }
 
+#if GDAL_VERSION_NUM >= 3100000 // 3.10+, for InterpolateAtPoint
+
+namespace
+{
+    GDALRIOResampleAlg resampleAlg(Interpolation interpolation)
+    {
+        return
+            interpolation == Interpolation::Average ? GRIORA_Bilinear : // Average not accepted by InterpolateAtPoint
+            interpolation == Interpolation::Bilinear ? GRIORA_Bilinear :
+            interpolation == Interpolation::Cubic ? GRIORA_Cubic :
+            interpolation == Interpolation::CubicSpline ? GRIORA_CubicSpline :
+            GRIORA_NearestNeighbour;
+    }
+}
+
+bool
+GDAL_detail::Driver::sampleHeightfield(GDALRasterBand* band, const GeoExtent& intersection,
+    double xmin, double ymin, double dx, double dy, unsigned tileSize, float* out)
+{
+    // only works when columns map to pixel columns and rows to pixel rows:
+    if (_igt[2] != 0.0 || _igt[4] != 0.0)
+        return false;
+
+    int xsize = band->GetXSize();
+    int ysize = band->GetYSize();
+
+    auto toPixel = [](double p, double size)
+        {
+            if (glm::epsilonEqual(p, 0.0, 0.0001)) p = 0.0;
+            if (glm::epsilonEqual(p, size, 0.0001)) p = size;
+            return std::clamp(p, 0.0, size - 1.0);
+        };
+
+    // Which columns and rows fall inside the intersection, and their pixel coordinates:
+    double xmid = 0.5 * (intersection.xmin() + intersection.xmax());
+    double ymid = 0.5 * (intersection.ymin() + intersection.ymax());
+
+    std::vector<double> px(tileSize), py(tileSize);
+    std::vector<char> colInside(tileSize), rowInside(tileSize);
+    for (unsigned i = 0; i < tileSize; ++i)
+    {
+        double x = xmin + dx * (double)i;
+        double y = ymin + dy * (double)i;
+        colInside[i] = intersection.contains(x, ymid);
+        rowInside[i] = intersection.contains(xmid, y);
+        px[i] = toPixel(_igt[0] + _igt[1] * x, (double)xsize);
+        py[i] = toPixel(_igt[3] + _igt[5] * y, (double)ysize);
+    }
+
+    // The source window covering every sample, with room for the cubic kernels:
+    auto [pxmin, pxmax] = std::minmax_element(px.begin(), px.end());
+    auto [pymin, pymax] = std::minmax_element(py.begin(), py.end());
+    int x0 = std::max((int)std::floor(*pxmin) - 2, 0);
+    int y0 = std::max((int)std::floor(*pymin) - 2, 0);
+    int x1 = std::min((int)std::floor(*pxmax) + 2, xsize - 1);
+    int y1 = std::min((int)std::floor(*pymax) + 2, ysize - 1);
+    int width = x1 - x0 + 1;
+    int height = y1 - y0 + 1;
+
+    // When the source is much finer than the tile, reading the whole window costs more
+    // than sampling point by point.
+    if ((double)width * (double)height > 16.0 * (double)tileSize * (double)tileSize)
+        return false;
+
+    std::vector<float> window((std::size_t)width * (std::size_t)height);
+    if (band->RasterIO(GF_Read, x0, y0, width, height, window.data(), width, height, GDT_Float32, 0, 0, nullptr) != CE_None)
+        return false;
+
+    // Flag the band's nodata values once. Samples that touch one are left to
+    // InterpolateAtPoint, so nodata is handled exactly as on the per-point path
+    // (other invalid values are interpolated as is, also like that path).
+    int hasNoData;
+    float bandNoData = (float)band->GetNoDataValue(&hasNoData);
+    if (hasNoData)
+    {
+        for (auto& v : window)
+        {
+            if (v == bandNoData)
+                v = std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+
+    auto interpolation = _layer->interpolation.value();
+    auto alg = resampleAlg(interpolation);
+
+    std::vector<detail::Taps> colTaps(tileSize);
+    for (unsigned c = 0; c < tileSize; ++c)
+    {
+        colTaps[c] = detail::makeTaps(px[c], xsize, x0, interpolation);
+    }
+
+    for (unsigned r = 0; r < tileSize; ++r)
+    {
+        if (!rowInside[r])
+            continue;
+
+        auto rowTaps = detail::makeTaps(py[r], ysize, y0, interpolation);
+        float* outRow = out + (std::size_t)r * tileSize;
+
+        for (unsigned c = 0; c < tileSize; ++c)
+        {
+            if (!colInside[c])
+                continue;
+
+            float value = detail::interpolate(window.data(), width, colTaps[c], rowTaps);
+            if (!std::isnan(value))
+            {
+                outRow[c] = value * (float)_linearUnits;
+            }
+            else
+            {
+                double realPart;
+                if (band->InterpolateAtPoint(px[c], py[r], alg, &realPart, nullptr) == CE_None)
+                    outRow[c] = (float)realPart * (float)_linearUnits;
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif
+
 Result<std::shared_ptr<Image>>
 GDAL_detail::Driver::createHeightfield(const TileKey& key, unsigned tileSize, const IOOptions& io)
 {
@@ -1369,12 +1568,7 @@ GDAL_detail::Driver::createHeightfield(const TileKey& key, unsigned tileSize, co
 
 #if GDAL_VERSION_NUM >= 3100000 // 3.10+
 
-    GDALRIOResampleAlg alg =
-        _layer->interpolation == Interpolation::Average ? GRIORA_Bilinear : // Average not accepted by InterpolateAtPoint
-        _layer->interpolation == Interpolation::Bilinear ? GRIORA_Bilinear :
-        _layer->interpolation == Interpolation::Cubic ? GRIORA_Cubic :
-        _layer->interpolation == Interpolation::CubicSpline ? GRIORA_CubicSpline :
-        GRIORA_NearestNeighbour;
+    GDALRIOResampleAlg alg = resampleAlg(_layer->interpolation.value());
 
     double px, py;
     double realPart;
@@ -1395,24 +1589,28 @@ GDAL_detail::Driver::createHeightfield(const TileKey& key, unsigned tileSize, co
 
     if (_layer->precise == true || (intersection != key.extent()))
     {
-        // in precise mode, we sample every single point separately
-        for (unsigned r = 0; r < tileSize; ++r)
+        // in precise mode, we sample every single point separately; from a single
+        // read of the source window when possible, otherwise point by point.
+        if (!sampleHeightfield(band, intersection, tile_xmin, tile_ymin, dx, dy, tileSize, hf_raw))
         {
-            double y = tile_ymin + (dy * (double)r);
-
-            for (unsigned c = 0; c < tileSize; ++c)
+            for (unsigned r = 0; r < tileSize; ++r)
             {
-                double x = tile_xmin + (dx * (double)c);
+                double y = tile_ymin + (dy * (double)r);
 
-                if (intersection.contains(x, y))
+                for (unsigned c = 0; c < tileSize; ++c)
                 {
-                    geo2pixel(x, y, px, py);
+                    double x = tile_xmin + (dx * (double)c);
 
-                    // this function applies the 1/2 pixel offset for us for DEMs
-                    auto err = band->InterpolateAtPoint(px, py, alg, &realPart, nullptr);
-                    if (err == CE_None)
+                    if (intersection.contains(x, y))
                     {
-                        hf.heightAt(c, r) = (float)realPart * _linearUnits;
+                        geo2pixel(x, y, px, py);
+
+                        // this function applies the 1/2 pixel offset for us for DEMs
+                        auto err = band->InterpolateAtPoint(px, py, alg, &realPart, nullptr);
+                        if (err == CE_None)
+                        {
+                            hf.heightAt(c, r) = (float)realPart * _linearUnits;
+                        }
                     }
                 }
             }
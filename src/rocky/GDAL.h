@@ -123,6 +123,8 @@ namespace ROCKY_NAMESPACE
             bool isValidValue(float, float) const;
             float getValidElevationValue(float value, float nodataValueFromBand, float replacement);
             float getInterpolatedDEMValue(GDALRasterBand* band, double x, double y);
+            bool sampleHeightfield(GDALRasterBand* band, const GeoExtent& intersection,
+                double xmin, double ymin, double dx, double dy, unsigned tileSize, float* out);
             bool intersects(const TileKey&);
 
             bool _open = false;
@@ -63,6 +63,10 @@ void
 GDALElevationLayer::construct(std::string_view JSON, const IOOptions& io)
 {
     setLayerTypeName("GDALElevation");
+
+    // close the datasets of threads that stop using them, to bound open file handles
+    _drivers.idleTimeout = std::chrono::seconds(30);
+
     const auto j = parse_json(JSON);
     get_to(j, "uri", uri, io);
     get_to(j, "connection", connection);
@@ -108,11 +112,11 @@ GDALElevationLayer::openImplementation(const IOOptions& io)
     // So we just encapsulate the entire setup once per thread.
     // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
 
-    auto& driver = _drivers.value();
+    auto driver = _drivers.access();
 
     DataExtentList dataExtents;
 
-    auto s = openOnThisThread(this, driver, &new_profile, &dataExtents, io);
+    auto s = openOnThisThread(this, *driver, &new_profile, &dataExtents, io);
     if (s.failed())
         return s;
 
@@ -142,19 +146,19 @@ GDALElevationLayer::createTileImplementation(const TileKey& key, const IOOptions
     if (status().failed())
         return status().error();
 
-    auto& driver = _drivers.value();
-    if (!driver.isOpen())
+    auto driver = _drivers.access();
+    if (!driver->isOpen())
     {
         // calling openImpl with NULL params limits the setup
         // since we already called this during openImplementation
-        auto r = openOnThisThread(this, driver, nullptr, nullptr, io);
+        auto r = openOnThisThread(this, *driver, nullptr, nullptr, io);
         if (r.failed())
             return fail(r.error());
     }
 
-    if (driver.isOpen())
+    if (driver->isOpen())
     {
-        auto r = driver.createHeightfield(key, tileSize, io);
+        auto r = driver->createHeightfield(key, tileSize, io);
 
         if (r.ok())
         {
@@ -162,7 +166,7 @@ GDALElevationLayer::createTileImplementation(const TileKey& key, const IOOptions
         }
         else
         {
-            r = driver.createImage(key, tileSize, io);
+            r = driver->createImage(key, tileSize, io);
             if (r.ok())
                 return GeoImage(r.value(), key.extent());
         }
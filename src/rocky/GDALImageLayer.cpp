@@ -72,6 +72,10 @@ void
 GDALImageLayer::construct(std::string_view JSON, const IOOptions& io)
 {
     setLayerTypeName("GDALImage");
+
+    // close the datasets of threads that stop using them, to bound open file handles
+    _drivers.idleTimeout = std::chrono::seconds(30);
+
     const auto j = parse_json(JSON);
     get_to(j, "uri", uri, io);
     get_to(j, "connection", connection);
@@ -111,11 +115,11 @@ GDALImageLayer::openImplementation(const IOOptions& io)
     // So we just encapsulate the entire setup once per thread.
     // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
 
-    auto& driver = _drivers.value();
+    auto driver = _drivers.access();
 
     DataExtentList dataExtents;
 
-    auto s = openOnThisThread(this, driver, &new_profile, &dataExtents, io);
+    auto s = openOnThisThread(this, *driver, &new_profile, &dataExtents, io);
     if (s.failed())
         return s;
 
@@ -145,12 +149,12 @@ GDALImageLayer::createTileImplementation(const TileKey& key, const IOOptions& io
     if (status().failed())
         return status().error();
 
-    auto& driver = _drivers.value();
-    if (!driver.isOpen())
+    auto driver = _drivers.access();
+    if (!driver->isOpen())
     {
         // calling openImpl with NULL params limits the setup
         // since we already called this during openImplementation
-        auto r = openOnThisThread(this, driver, nullptr, nullptr, io);
+        auto r = openOnThisThread(this, *driver, nullptr, nullptr, io);
         if (r.failed())
         {            
             fail(r.error());
@@ -158,9 +162,9 @@ GDALImageLayer::createTileImplementation(const TileKey& key, const IOOptions& io
         }
     }
 
-    if (driver.isOpen())
+    if (driver->isOpen())
     {
-        auto r = driver.createImage(key, tileSize, io);
+        auto r = driver->createImage(key, tileSize, io);
         if (r.ok())
         {
             return GeoImage(r.value(), key.extent());
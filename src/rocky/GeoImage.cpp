@@ -7,6 +7,8 @@
 #include "Math.h"
 #include "Image.h"
 #include "Heightfield.h"
+#include "IOTypes.h"
+#include <limits>
 
 #ifdef ROCKY_HAS_GDAL
 #include <gdal.h>
@@ -110,53 +112,202 @@ GeoImage::getPixel(double x, double y, int& s, int& t) const
     return true;
 }
 
+namespace
+{
+    // One source of a composite, with the location in the source image of
+    // every pixel in the destination image.
+    struct CompositeSource
+    {
+        const Image* image = nullptr;
+        float opacity = 1.0f;
+        bool rgba8 = false; // eligible for the direct RGBA8 sampler
+        std::vector<glm::fvec2> uv; // normalized source coords per destination pixel; NaN = no data
+    };
+
+    // Address of the RGBA8 pixel at s, t, layer. (Image::data<T>(s, t, layer) indexes
+    // in units of T, so it only works when T is the size of a whole pixel.)
+    inline std::uint8_t* rgba8_at(const Image& image, unsigned s, unsigned t, unsigned layer)
+    {
+        return reinterpret_cast<std::uint8_t*>(image.data<std::uint32_t>(s, t, layer));
+    }
+
+    // Bilinear sample of an R8G8B8A8_UNORM image, equivalent to Image::read_bilinear
+    // without the per-texel format dispatch and no-data checks (which never match 8-bit colors).
+    inline glm::fvec4 sample_rgba8(const Image& image, float u, float v, unsigned layer)
+    {
+        constexpr float denorm = 1.0f / 255.0f;
+
+        float sizeS = (float)(image.width() - 1);
+        float s = u * sizeS;
+        float s0 = std::floor(s);
+        float s1 = std::min(s0 + 1.0f, sizeS);
+        float smix = s0 < s1 ? s - s0 : 0.0f;
+
+        float sizeT = (float)(image.height() - 1);
+        float t = v * sizeT;
+        float t0 = std::floor(t);
+        float t1 = std::min(t0 + 1.0f, sizeT);
+        float tmix = t0 < t1 ? t - t0 : 0.0f;
+
+        auto* row0 = rgba8_at(image, (unsigned)s0, (unsigned)t0, layer);
+        auto* row1 = rgba8_at(image, (unsigned)s0, (unsigned)t1, layer);
+        unsigned ds = s0 < s1 ? 4 : 0;
+
+        glm::fvec4 UL(row0[0], row0[1], row0[2], row0[3]);
+        glm::fvec4 UR(row0[ds], row0[ds + 1], row0[ds + 2], row0[ds + 3]);
+        glm::fvec4 LL(row1[0], row1[1], row1[2], row1[3]);
+        glm::fvec4 LR(row1[ds], row1[ds + 1], row1[ds + 2], row1[ds + 3]);
+
+        glm::fvec4 top = UL + (UR - UL) * smix;
+        glm::fvec4 bot = LL + (LR - LL) * smix;
+        return (top + (bot - top) * tmix) * denorm;
+    }
+}
+
 void
-GeoImage::composite(const std::vector<GeoImage>& sources, const std::vector<float>& opacities)
+GeoImage::composite(const std::vector<GeoImage>& sources, const std::vector<float>& opacities, const IOOptions* io)
 {
-    double x, y;
+    ROCKY_SOFT_ASSERT_AND_RETURN(valid(), void());
+
+    const unsigned width = _image->width();
+    const unsigned height = _image->height();
+    const unsigned depth = _image->depth();
     bool have_opacities = opacities.size() == sources.size();
 
-    std::vector<SRSOperation> xforms;
-    xforms.reserve(sources.size());
-    for (auto& source : sources)
-        xforms.emplace_back(srs().to(source.srs()));
+    // Location of each destination pixel in our own SRS, computed once and shared by all sources.
+    std::vector<glm::dvec3> coords(width * height);
+    for (unsigned t = 0; t < height; ++t)
+    {
+        double y = _extent.ymin() + (height > 1 ? (double)t / (double)(height - 1) : 0.0) * _extent.height();
+        for (unsigned s = 0; s < width; ++s)
+        {
+            double x = _extent.xmin() + (width > 1 ? (double)s / (double)(width - 1) : 0.0) * _extent.width();
+            coords[t * width + s] = glm::dvec3(x, y, 0.0);
+        }
+    }
 
-    std::vector<glm::fvec4> pixels;
-    pixels.reserve(sources.size());
+    // Precompute the sampling grid for each source with a single batched transform,
+    // instead of transforming every pixel for every source in the inner loop.
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    constexpr double eps = 1e-6;
+    std::vector<CompositeSource> grids;
+    grids.reserve(sources.size());
+    std::vector<glm::dvec3> points;
 
-    for (unsigned s = 0; s < _image->width(); ++s)
+    for (unsigned i = 0; i < sources.size(); ++i)
     {
-        for (unsigned t = 0; t < _image->height(); ++t)
+        auto& source = sources[i];
+        if (!source.valid())
+            continue;
+
+        CompositeSource grid;
+        grid.image = source.image().get();
+        grid.opacity = have_opacities ? opacities[i] : 1.0f;
+        grid.rgba8 = grid.image->pixelFormat() == Image::R8G8B8A8_UNORM && grid.image->depth() >= depth;
+        grid.uv.resize(coords.size());
+
+        points = coords;
+        auto xform = srs().to(source.srs());
+        if (!xform.noop())
+            xform.transformArray(points.data(), points.size()); // failed points come back non-finite
+
+        auto& ex = source.extent();
+        for (std::size_t p = 0; p < points.size(); ++p)
         {
-            getCoord(s, t, x, y);
+            double u = (points[p].x - ex.xmin()) / ex.width();
+            double v = (points[p].y - ex.ymin()) / ex.height();
+
+            // out of bounds? Use a small epsilon to tolerate floating-point
+            // precision at exact tile boundaries (same as GeoImage::read).
+            if (std::isfinite(u) && std::isfinite(v) && u >= -eps && u <= 1.0 + eps && v >= -eps && v <= 1.0 + eps)
+                grid.uv[p] = glm::fvec2((float)std::clamp(u, 0.0, 1.0), (float)std::clamp(v, 0.0, 1.0));
+            else
+                grid.uv[p] = glm::fvec2(nan, nan);
+        }
 
-            for (unsigned layer = 0; layer < _image->depth(); ++layer)
+        grids.emplace_back(std::move(grid));
+    }
+
+    const bool dest_rgba8 = _image->pixelFormat() == Image::R8G8B8A8_UNORM;
+    Image* dest = _image.get();
+
+    // Composite one row of the destination image. Sources are visited from the top
+    // down until one is opaque, then blended back up; same result as blending every
+    // source bottom to top, without sampling sources that would be covered.
+    auto composite_row = [&](unsigned t, std::vector<glm::fvec4>& samples)
+        {
+            for (unsigned layer = 0; layer < depth; ++layer)
             {
-                pixels.clear();
+                auto* out = dest_rgba8 ? rgba8_at(*dest, 0, t, layer) : nullptr;
 
-                for (int i = (int)sources.size() - 1; i >= 0; --i)
+                for (unsigned s = 0; s < width; ++s)
                 {
-                    auto r = sources[i].read(xforms[i], x, y, layer);
-                    if (r.ok())
+                    unsigned p = t * width + s;
+                    unsigned n = 0;
+
+                    for (int i = (int)grids.size() - 1; i >= 0; --i)
                     {
-                        r.value().a *= opacities[i];
-                        float a = r.value().a;
-                        pixels.emplace_back(std::move(r.value()));
-                        if (a >= 1.0f)
+                        auto& grid = grids[i];
+                        auto& uv = grid.uv[p];
+                        if (std::isnan(uv.x))
+                            continue;
+
+                        glm::fvec4 pixel = grid.rgba8 ?
+                            sample_rgba8(*grid.image, uv.x, uv.y, layer) :
+                            grid.image->read_bilinear(uv.x, uv.y, layer);
+
+                        pixel.a *= grid.opacity;
+                        samples[n++] = pixel;
+                        if (pixel.a >= 1.0f)
                             break;
                     }
-                }
-                
-                glm::fvec4 pixel(0, 0, 0, 0);
-                auto n = (int)pixels.size();
-                for (int i = n - 1; i >= 0; --i)
-                {
-                    pixel = i == (n - 1) ? pixels[i] : glm::mix(pixel, pixels[i], pixels[i].a);
-                }
 
-                _image->write(pixel, s, t, layer);
+                    glm::fvec4 pixel(0, 0, 0, 0);
+                    if (n > 0)
+                    {
+                        pixel = samples[n - 1];
+                        for (int i = (int)n - 2; i >= 0; --i)
+                            pixel = glm::mix(pixel, samples[i], samples[i].a);
+                    }
+
+                    if (out)
+                    {
+                        // same conversion as Image::write for R8G8B8A8_UNORM
+                        *out++ = (std::uint8_t)(pixel.r * 255.0f);
+                        *out++ = (std::uint8_t)(pixel.g * 255.0f);
+                        *out++ = (std::uint8_t)(pixel.b * 255.0f);
+                        *out++ = (std::uint8_t)(pixel.a * 255.0f);
+                    }
+                    else
+                    {
+                        dest->write(pixel, s, t, layer);
+                    }
+                }
             }
-        }
+        };
+
+    // Split the rows into bands, each with its own sample buffer.
+    constexpr unsigned rows_per_band = 32;
+    std::vector<std::function<void()>> bands;
+    for (unsigned t0 = 0; t0 < height; t0 += rows_per_band)
+    {
+        bands.emplace_back([&, t0]()
+            {
+                std::vector<glm::fvec4> samples(std::max(grids.size(), (std::size_t)1));
+                for (unsigned t = t0; t < std::min(t0 + rows_per_band, height); ++t)
+                    composite_row(t, samples);
+            });
+    }
+
+    if (io)
+    {
+        auto& jobs = io->services().jobs;
+        detail::runConcurrently(bands, jobs, jobs.get_pool(), "composite");
+    }
+    else
+    {
+        for (auto& band : bands)
+            band();
     }
 }
 
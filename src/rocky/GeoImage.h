@@ -17,6 +17,7 @@ namespace ROCKY_NAMESPACE
 {
     class Image;
     class GeoPoint;
+    class IOOptions;
 
     /**
      * A georeferenced image; i.e. an Image coupled with a GeoExtent.
@@ -55,7 +56,10 @@ namespace ROCKY_NAMESPACE
         //! Composites one or more source images into this image, overwriting the existing image.
         //! @param sources GeoImages to composite, from bottom to top.
         //! @param opacities Opacities to apply to each source image (defaults to 1.0f if vector sizes don't match)
-        void composite(const std::vector<GeoImage>& sources, const std::vector<float>& opacities = {});
+        //! @param io If set, split the rows across the default job pool. The calling
+        //!    thread always works on rows too, so it's safe to call this from inside a job.
+        void composite(const std::vector<GeoImage>& sources, const std::vector<float>& opacities = {},
+            const IOOptions* io = nullptr);
 
         //! Gets the units per pixel of this geoimage
         double getUnitsPerPixel() const;
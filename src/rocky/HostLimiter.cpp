@@ -0,0 +1,172 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#include "HostLimiter.h"
+#include <algorithm>
+
+using namespace ROCKY_NAMESPACE;
+
+HostLimiter::HostLimiter(WEEJOBS_NAMESPACE::runtime* metricsRuntime) :
+    _runtime(metricsRuntime)
+{
+    //nop
+}
+
+HostLimiter::~HostLimiter()
+{
+    detachMetrics(_runtime);
+}
+
+void
+HostLimiter::detachMetrics(WEEJOBS_NAMESPACE::runtime* metricsRuntime)
+{
+    std::scoped_lock lock(_mutex);
+    if (_runtime && _runtime == metricsRuntime)
+    {
+        for (auto& [name, host] : _hosts)
+            _runtime->remove_metrics(&host->metrics);
+        _runtime = nullptr;
+    }
+}
+
+HostLimiter::Host&
+HostLimiter::host(const std::string& name)
+{
+    auto& host = _hosts[name];
+    if (!host)
+    {
+        host = std::make_unique<Host>();
+        host->name = name;
+        host->metrics.name = name;
+        host->tokens = (double)std::max(burst, 1u);
+        host->refilled = std::chrono::steady_clock::now();
+        if (_runtime)
+            _runtime->add_metrics(&host->metrics);
+    }
+    return *host;
+}
+
+void
+HostLimiter::drain(Host& host, std::vector<std::function<void()>>& ready)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto limit = std::max(maxRequestsPerHost, 1u);
+    host.metrics.concurrency = limit;
+
+    if (requestsPerSecond > 0.0)
+    {
+        double elapsed = std::chrono::duration<double>(now - host.refilled).count();
+        host.tokens = std::min(host.tokens + elapsed * requestsPerSecond, (double)std::max(burst, 1u));
+        host.refilled = now;
+    }
+
+    while (!host.queue.empty() && host.active < limit)
+    {
+        if (requestsPerSecond > 0.0)
+        {
+            if (host.tokens < 1.0)
+            {
+                // come back when the next token is due
+                auto wait = std::chrono::duration<double>((1.0 - host.tokens) / requestsPerSecond);
+                wakeAt(host, now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(wait));
+                break;
+            }
+            host.tokens -= 1.0;
+        }
+
+        auto& next = host.queue.front();
+        ++host.active;
+        host.metrics.pending--;
+        host.metrics.running++;
+        host.metrics.dequeued++;
+        host.metrics.wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(now - next.queued).count();
+        ready.emplace_back(std::move(next.start));
+        host.queue.pop_front();
+    }
+}
+
+void
+HostLimiter::wakeAt(Host& host, std::chrono::steady_clock::time_point when)
+{
+    if (host.wakeScheduled)
+        return;
+
+    host.wakeScheduled = true;
+
+    std::weak_ptr<HostLimiter> weak = weak_from_this();
+    auto wake = [weak, this, name(host.name)]()
+        {
+            auto self = weak.lock();
+            if (!self)
+                return;
+
+            std::vector<std::function<void()>> ready;
+            {
+                std::scoped_lock lock(_mutex);
+                auto& h = this->host(name);
+                h.wakeScheduled = false;
+                drain(h, ready);
+            }
+            for (auto& start : ready)
+                start();
+        };
+
+    // without a shared owner the timer can't tell if we're still alive;
+    // the next admit() or finish() will try again.
+    if (weak.expired())
+        host.wakeScheduled = false;
+    else
+        detail::callAt(when, std::move(wake));
+}
+
+void
+HostLimiter::admit(const std::string& name, std::function<void()> start)
+{
+    std::vector<std::function<void()>> ready;
+    {
+        std::scoped_lock lock(_mutex);
+        auto& h = host(name);
+        h.queue.emplace_back(Waiting{ std::move(start), std::chrono::steady_clock::now() });
+        h.metrics.total++;
+        auto pending = ++h.metrics.pending;
+        if (pending > h.metrics.peak_pending)
+            h.metrics.peak_pending = pending;
+        drain(h, ready);
+    }
+
+    for (auto& f : ready)
+        f();
+}
+
+void
+HostLimiter::finish(const std::string& name, std::chrono::steady_clock::duration latency, bool failed)
+{
+    std::vector<std::function<void()>> ready;
+    {
+        std::scoped_lock lock(_mutex);
+        auto& h = host(name);
+        if (h.active > 0)
+        {
+            --h.active;
+            h.metrics.running--;
+        }
+        h.metrics.completed++;
+        h.metrics.run_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        if (failed)
+            h.metrics.errors++;
+        drain(h, ready);
+    }
+
+    for (auto& f : ready)
+        f();
+}
+
+const WEEJOBS_NAMESPACE::jobpool::metrics_t*
+HostLimiter::metrics(const std::string& name) const
+{
+    std::scoped_lock lock(_mutex);
+    auto i = _hosts.find(name);
+    return i != _hosts.end() ? &i->second->metrics : nullptr;
+}
@@ -0,0 +1,100 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/Common.h>
+#include <rocky/Threading.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+    * Admission control for remote requests, per host ("scheme://host:port").
+    *
+    * Limits how many requests to one host are in flight at once and, optionally,
+    * how fast new ones start (a token bucket), so a slow or rate-limiting server
+    * can't tie up the network for everyone else. A request over a limit waits in
+    * its host's queue without occupying a thread.
+    *
+    * Each host reports metrics through the jobs runtime, in an entry named after
+    * the host: concurrency is the in-flight limit; running and pending count the
+    * requests in flight and queued; avg_wait_ns() is the time spent queued,
+    * avg_run_ns() the request latency, and errors the number of failed requests.
+    */
+    class ROCKY_EXPORT HostLimiter : public std::enable_shared_from_this<HostLimiter>
+    {
+    public:
+        //! Maximum number of requests in flight to one host
+        unsigned maxRequestsPerHost = 8u;
+
+        //! Sustained number of new requests per second to one host; zero for no limit.
+        //! Requests held back by the rate start on a timer, which requires the limiter
+        //! to be owned by a std::shared_ptr.
+        double requestsPerSecond = 0.0;
+
+        //! Number of requests that can start back to back before requestsPerSecond applies
+        unsigned burst = 8u;
+
+        //! Construct a limiter.
+        //! \param metricsRuntime Jobs runtime that lists the per-host metrics. The limiter
+        //!    removes them when it's destroyed; if it might outlive the runtime, call
+        //!    detachMetrics() before the runtime goes away.
+        HostLimiter(WEEJOBS_NAMESPACE::runtime* metricsRuntime = nullptr);
+
+        //! Removes the per-host metrics from the jobs runtime.
+        ~HostLimiter();
+
+        //! Removes the per-host metrics from the given jobs runtime, if it's the one
+        //! this limiter reports to, and stops reporting to it.
+        void detachMetrics(WEEJOBS_NAMESPACE::runtime* metricsRuntime);
+
+        //! Calls start once the host has room for another request: right away on the
+        //! calling thread, or later on whichever thread makes room. The start function
+        //! should return quickly; and every admitted request must call finish().
+        void admit(const std::string& host, std::function<void()> start);
+
+        //! Reports that an admitted request is done, making room for the next one.
+        //! \param latency Time from admission to completion
+        //! \param failed Whether the request counts as an error in the metrics
+        void finish(const std::string& host, std::chrono::steady_clock::duration latency, bool failed);
+
+        //! Metrics for a host, or nullptr if no request to it was ever admitted.
+        const WEEJOBS_NAMESPACE::jobpool::metrics_t* metrics(const std::string& host) const;
+
+    private:
+        struct Waiting
+        {
+            std::function<void()> start;
+            std::chrono::steady_clock::time_point queued;
+        };
+
+        struct Host
+        {
+            std::string name;
+            WEEJOBS_NAMESPACE::jobpool::metrics_t metrics;
+            std::deque<Waiting> queue;
+            unsigned active = 0;
+            double tokens = 0.0;
+            std::chrono::steady_clock::time_point refilled;
+            bool wakeScheduled = false;
+        };
+
+        mutable std::mutex _mutex;
+        std::unordered_map<std::string, std::unique_ptr<Host>> _hosts;
+        WEEJOBS_NAMESPACE::runtime* _runtime = nullptr;
+
+        Host& host(const std::string& name);
+        void drain(Host& host, std::vector<std::function<void()>>& ready);
+        void wakeAt(Host& host, std::chrono::steady_clock::time_point when);
+    };
+}
@@ -6,6 +6,9 @@
 #include "IOTypes.h"
 #include "Context.h"
 #include "json.h"
+#include "ImageCodecs.h"
+#include "URI.h"
+#include "Utils.h"
 
 using namespace ROCKY_NAMESPACE;
 
@@ -21,4 +24,18 @@ Services::Services()
 
     readImageFromStream = [](std::istream& stream, std::string contentType, const IOOptions& io) {
         return Failure(Failure::ServiceUnavailable, "Services.readImageFromStream is not implemented"); };
+
+    readImageFromBuffer = [](std::string_view buffer, std::string contentType, const IOOptions& io) {
+        auto result = detail::decodeImage(buffer);
+        if (result.failed() && result.error().type == Failure::ServiceUnavailable)
+        {
+            detail::MemoryInputStream stream(buffer.data(), buffer.size());
+            result = io.services().readImageFromStream(stream, contentType, io);
+        }
+        return result;
+    };
+
+    uriReads = std::make_shared<detail::SingleFlight<std::string, Result<URIResponse>>>();
+
+    hostLimiter = std::make_shared<HostLimiter>(&jobs);
 }
@@ -8,9 +8,13 @@
 #include <rocky/Result.h>
 #include <rocky/Threading.h>
 #include <rocky/Cache.h>
+#include <rocky/DiskCache.h>
+#include <rocky/HostLimiter.h>
+#include <rocky/TileKey.h>
 #include <rocky/Units.h>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <chrono>
 
@@ -24,6 +28,7 @@ namespace ROCKY_NAMESPACE
     class Layer;
     class ContextImpl;
     class GeoExtent;
+    struct URIResponse;
 
     //! Service for reading an image from a URI
     using ReadImageURIService = std::function<
@@ -33,12 +38,16 @@ namespace ROCKY_NAMESPACE
     using ReadImageStreamService = std::function<
         Result<std::shared_ptr<Image>>(std::istream& stream, std::string contentType, const IOOptions& io)>;
 
+    //! Service for decoding an image from a buffer in memory
+    using ReadImageBufferService = std::function<
+        Result<std::shared_ptr<Image>>(std::string_view buffer, std::string contentType, const IOOptions& io)>;
+
     //! Service for writing an image to a stream
     using WriteImageStreamService = std::function<
         Result<>(std::shared_ptr<Image> image, std::ostream& stream, std::string contentType, const IOOptions& io)>;
 
     //! Service for tracking invalid request URIs
-    using DealpoolService = rocky::detail::LRUCache<std::string, Failure>;
+    using DealpoolService = rocky::detail::ShardedCache<std::string, Failure>;
 
     //! Holds a generic content buffer and its type.
     struct Content {
@@ -47,8 +56,28 @@ namespace ROCKY_NAMESPACE
         std::chrono::system_clock::time_point timestamp;
     };
 
-    //! A cache that stores Content objects by URI.
-    using ContentCache = rocky::detail::LRUCache<std::string, Result<Content>>;
+    //! A cache that stores Content objects by URI, bounded by their total size in bytes.
+    //! It uses 4 shards, so a single response may use up to a quarter of the capacity
+    //! (16 MB by default); larger responses are not cached.
+    class ContentCache : public rocky::detail::ShardedCache<std::string, Result<Content>>
+    {
+    public:
+        //! Construct a content cache that holds up to capacityBytes of data.
+        ContentCache(std::size_t capacityBytes = 64u * 1024u * 1024u) :
+            ShardedCache(capacityBytes, [](const std::string& uri, const Result<Content>& r) {
+                return sizeof(Content) + uri.size() + (r.ok() ? r.value().type.size() + r.value().data.size() : 0u); }, 4) { }
+    };
+
+    //! Identifies one layer's tile in the resident image cache.
+    struct ResidentTileKey {
+        TileId tile;
+        UID layer = -1;
+        Revision revision = 0;
+
+        inline bool operator == (const ResidentTileKey& rhs) const {
+            return tile == rhs.tile && layer == rhs.layer && revision == rhs.revision;
+        }
+    };
 
     /**
     * Collection of service available to rocky classes that perform IO operations.
@@ -66,6 +95,9 @@ namespace ROCKY_NAMESPACE
 #ifdef ROCKY_DEBUG_MEMCHECK
             Log()->debug("~Services");
 #endif
+            // the limiter can outlive us, but its metrics can't outlive our runtime
+            if (hostLimiter)
+                hostLimiter->detachMetrics(&jobs);
         }
 
         //! Decodes an Image::Ptr from a URI
@@ -74,17 +106,28 @@ namespace ROCKY_NAMESPACE
         //! Decodes an Image::Ptr from a std::istream
         ReadImageStreamService readImageFromStream;
 
+        //! Decodes an Image::Ptr from a buffer without copying it. By default this uses
+        //! the native decoders rocky was built with, then falls back on readImageFromStream.
+        ReadImageBufferService readImageFromBuffer;
+
         //! Encodes an Image::Ptr to a std::ostream
         WriteImageStreamService writeImageToStream;
 
-        //! Serializes reads from identical URIs
-        detail::Gate<std::string> uriGate;
+        //! Coalesces concurrent reads of identical URIs into one; URI will use this if available.
+        std::shared_ptr<detail::SingleFlight<std::string, Result<URIResponse>>> uriReads;
+
+        //! Limits concurrent and per-second requests to each remote host; URI will use this if available.
+        std::shared_ptr<HostLimiter> hostLimiter;
 
         //! Caches raw context coming from a URI (like a browser cache)
         std::shared_ptr<ContentCache> contentCache;
 
+        //! Persistent cache of remote content and tiles that survives a restart;
+        //! URI and TileLayer will use this if available.
+        std::shared_ptr<DiskCache> diskCache;
+
         //! Provides fast access to Image data that is resident somwehere in memory
-        std::shared_ptr<detail::ResidentCache<std::string, Image, GeoExtent>> residentImageCache;
+        std::shared_ptr<detail::ResidentCache<ResidentTileKey, Image, GeoExtent>> residentImageCache;
 
         //! URI deadpool; URI will use this if available.
         std::shared_ptr<DealpoolService> deadpool;
@@ -173,3 +216,15 @@ namespace ROCKY_NAMESPACE
         return *_services;
     }
 }
+
+namespace std {
+    // std::hash specialization for ResidentTileKey
+    template<> struct hash<rocky::ResidentTileKey> {
+        inline size_t operator()(const rocky::ResidentTileKey& value) const {
+            rocky::TileId mixed;
+            mixed.value = value.tile.value ^ ((std::uint64_t)(std::uint32_t)value.layer * 0x9e3779b97f4a7c15ull) ^
+                ((std::uint64_t)(std::uint32_t)value.revision << 32);
+            return hash<rocky::TileId>()(mixed);
+        }
+    };
+}
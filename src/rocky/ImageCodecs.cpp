@@ -0,0 +1,143 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#include "ImageCodecs.h"
+#include "Image.h"
+#include <cstring>
+
+#ifdef ROCKY_HAS_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+#ifdef ROCKY_HAS_PNG
+#include <png.h>
+#endif
+
+#ifdef ROCKY_HAS_WEBP
+#include <webp/decode.h>
+#endif
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    inline bool startsWith(std::string_view buffer, std::size_t offset, const char* magic, std::size_t len)
+    {
+        return buffer.size() >= offset + len && std::memcmp(buffer.data() + offset, magic, len) == 0;
+    }
+
+#ifdef ROCKY_HAS_TURBOJPEG
+    Result<std::shared_ptr<Image>> decodeJPEG(std::string_view buffer)
+    {
+        // one decompressor per thread; they are not thread-safe but are reusable.
+        struct Handle {
+            tjhandle value = tj3Init(TJINIT_DECOMPRESS);
+            ~Handle() { if (value) tj3Destroy(value); }
+        };
+        thread_local Handle handle;
+        if (!handle.value)
+            return Failure(Failure::ServiceUnavailable, "Cannot initialize libjpeg-turbo");
+
+        auto* data = (const unsigned char*)buffer.data();
+        if (tj3DecompressHeader(handle.value, data, buffer.size()) != 0)
+            return Failure(Failure::GeneralError, tj3GetErrorStr(handle.value));
+
+        int width = tj3Get(handle.value, TJPARAM_JPEGWIDTH);
+        int height = tj3Get(handle.value, TJPARAM_JPEGHEIGHT);
+        if (width <= 0 || height <= 0)
+            return Failure(Failure::GeneralError, "Invalid JPEG dimensions");
+
+        auto image = Image::create(Image::R8G8B8A8_UNORM, (unsigned)width, (unsigned)height);
+
+        tj3Set(handle.value, TJPARAM_BOTTOMUP, 1);
+        if (tj3Decompress8(handle.value, data, buffer.size(), image->data<unsigned char>(), 0, TJPF_RGBA) != 0 &&
+            tj3GetErrorCode(handle.value) == TJERR_FATAL)
+        {
+            return Failure(Failure::GeneralError, tj3GetErrorStr(handle.value));
+        }
+
+        return image;
+    }
+#endif
+
+#ifdef ROCKY_HAS_PNG
+    Result<std::shared_ptr<Image>> decodePNG(std::string_view buffer)
+    {
+        png_image png;
+        std::memset(&png, 0, sizeof(png));
+        png.version = PNG_IMAGE_VERSION;
+
+        if (!png_image_begin_read_from_memory(&png, buffer.data(), buffer.size()))
+            return Failure(Failure::GeneralError, png.message);
+
+        // 16-bit data (e.g. encoded elevation) would lose precision here; leave it to the general reader.
+        if (png.format & PNG_FORMAT_FLAG_LINEAR)
+        {
+            png_image_free(&png);
+            return Failure(Failure::ServiceUnavailable, "16-bit PNG");
+        }
+
+        png.format = PNG_FORMAT_RGBA;
+        auto image = Image::create(Image::R8G8B8A8_UNORM, png.width, png.height);
+
+        // a negative stride writes the rows bottom-up:
+        auto stride = -(png_int_32)PNG_IMAGE_ROW_STRIDE(png);
+        if (!png_image_finish_read(&png, nullptr, image->data<unsigned char>(), stride, nullptr))
+            return Failure(Failure::GeneralError, png.message);
+
+        return image;
+    }
+#endif
+
+#ifdef ROCKY_HAS_WEBP
+    Result<std::shared_ptr<Image>> decodeWebP(std::string_view buffer)
+    {
+        WebPDecoderConfig config;
+        if (!WebPInitDecoderConfig(&config))
+            return Failure(Failure::ServiceUnavailable, "Cannot initialize libwebp");
+
+        auto* data = (const std::uint8_t*)buffer.data();
+        if (WebPGetFeatures(data, buffer.size(), &config.input) != VP8_STATUS_OK)
+            return Failure(Failure::GeneralError, "Invalid WebP data");
+
+        auto image = Image::create(Image::R8G8B8A8_UNORM, (unsigned)config.input.width, (unsigned)config.input.height);
+
+        config.options.flip = 1;
+        config.output.colorspace = MODE_RGBA;
+        config.output.is_external_memory = 1;
+        config.output.u.RGBA.rgba = image->data<std::uint8_t>();
+        config.output.u.RGBA.stride = (int)image->rowSizeInBytes();
+        config.output.u.RGBA.size = image->sizeInBytes();
+
+        auto status = WebPDecode(data, buffer.size(), &config);
+        WebPFreeDecBuffer(&config.output);
+        if (status != VP8_STATUS_OK)
+            return Failure(Failure::GeneralError, "WebP decoding failed");
+
+        return image;
+    }
+#endif
+}
+
+Result<std::shared_ptr<Image>>
+ROCKY_NAMESPACE::detail::decodeImage(std::string_view buffer)
+{
+#ifdef ROCKY_HAS_TURBOJPEG
+    if (startsWith(buffer, 0, "\xFF\xD8\xFF", 3))
+        return decodeJPEG(buffer);
+#endif
+
+#ifdef ROCKY_HAS_PNG
+    if (startsWith(buffer, 0, "\x89PNG\r\n\x1A\n", 8))
+        return decodePNG(buffer);
+#endif
+
+#ifdef ROCKY_HAS_WEBP
+    if (startsWith(buffer, 0, "RIFF", 4) && startsWith(buffer, 8, "WEBP", 4))
+        return decodeWebP(buffer);
+#endif
+
+    return Failure(Failure::ServiceUnavailable, "No native decoder for this data");
+}
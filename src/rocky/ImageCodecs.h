@@ -0,0 +1,23 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#include <rocky/Result.h>
+#include <string_view>
+
+namespace ROCKY_NAMESPACE
+{
+    class Image;
+
+    namespace detail
+    {
+        //! Decodes a JPEG, PNG or WebP image in memory straight into a new R8G8B8A8 Image
+        //! (bottom row first), using whichever of libjpeg-turbo, libpng and libwebp rocky
+        //! was built with. Returns ServiceUnavailable for data it has no decoder for, so
+        //! the caller can fall back on a general-purpose reader.
+        extern ROCKY_EXPORT Result<std::shared_ptr<Image>> decodeImage(std::string_view buffer);
+    }
+}
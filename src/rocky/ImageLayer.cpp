@@ -9,6 +9,7 @@
 #include "GeoImage.h"
 #include "Image.h"
 #include "TileKey.h"
+#include "Reprojection.h"
 #include "json.h"
 
 #include <cinttypes>
@@ -254,9 +255,6 @@ ImageLayer::assembleTile(const TileKey& key, const IOOptions& io) const
                 layers = std::max(layers, source.image()->depth());
             }
 
-            // assume all tiles to mosaic are in the same SRS.
-            SRSOperation xform = key.extent().srs().to(sources[0].srs());
-
             // new output:
             output = Mosaic::create(sources[0].image()->pixelFormat(), cols, rows, layers);
 
@@ -265,41 +263,22 @@ ImageLayer::assembleTile(const TileKey& key, const IOOptions& io) const
             for (auto& source : sources)
                 output->dependencies.emplace_back(source.image());
 
-            // Working set of points. it's much faster to xform an entire vector all at once.
-            std::vector<glm::dvec3> points;
-            points.resize(cols * rows);
-
-            double minx, miny, maxx, maxy;
-            key.extent().getBounds(minx, miny, maxx, maxy);
-            double dx = (maxx - minx) / (double)(cols);
-            double dy = (maxy - miny) / (double)(rows);
-
-            // build a grid of sample points:
-            for (unsigned r = 0; r < rows; ++r)
-            {
-                double y = miny + (0.5*dy) + (dy * (double)r);
-                for (unsigned c = 0; c < cols; ++c)
-                {
-                    double x = minx + (0.5*dx) + (dx * (double)c);
-                    points[r * cols + c] = { x, y, 0.0 };
-                }
-            }
-
             // Working bounds of the SRS itself so we can clamp out-of-bounds points.
             // This is especially important when going from Mercator to Geographic
             // where there's no data beyond +/- 85 degrees.
             auto keyExtentInSourceSRS = key.extent().transform(sources[0].srs());
 
-            // transform the sample points to the SRS of our source data tiles:
-            if (xform.valid())
+            // sample locations (pixel centers) in the SRS of our source data tiles;
+            // we assume all tiles to mosaic are in the same SRS.
+            detail::ReprojectionGrid grid(key.extent(), cols, rows, true, sources[0].srs(), keyExtentInSourceSRS);
+
+            // fast path for separable reprojections (e.g. geographic <-> mercator):
+            if (detail::mosaicImages(grid, sources, *output, io))
             {
-                xform.transformArray(&points[0], points.size());
+                if (io.canceled())
+                    return {};
 
-                // clamp the transformed points to the profile SRS.
-                if (keyExtentInSourceSRS.valid())
-                {
-                    keyExtentInSourceSRS.clamp(points.begin(), points.end());
-                }
+                return output;
             }
 
             // Indirect indexing lets us do a basic "LRU" cache when looping through multiple images.
@@ -315,7 +294,7 @@ ImageLayer::assembleTile(const TileKey& key, const IOOptions& io) const
                 {
                     for (unsigned c = 0; c < cols; ++c)
                     {
-                        unsigned i = r * cols + c;
+                        auto point = grid.point(c, r);
 
                         // check each source (high to low resolution) until we get a valid pixel.
                         bool wrote = false;
@@ -326,7 +305,7 @@ ImageLayer::assembleTile(const TileKey& key, const IOOptions& io) const
 
                             if (layer < sources[k].image()->depth())
                             {
-                                auto pixel = sources[k].read(points[i].x, points[i].y, layer);
+                                auto pixel = sources[k].read(point.x, point.y, layer);
                                 if (pixel.ok() && pixel.value().a > 0.0f)
                                 {
                                     output->write(pixel.value(), c, r, layer);
@@ -9,7 +9,12 @@
 #include "Image.h"
 #include "json.h"
 #include "Context.h"
+#include "Utils.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
+#include <optional>
 
 #include <sqlite3.h>
 ROCKY_ABOUT(sqlite, SQLITE_VERSION);
@@ -20,7 +25,164 @@ using namespace ROCKY_NAMESPACE::detail;
 #undef LC
 #define LC "[MBTiles] "
 
+namespace
+{
+    const char* tileQuery = "SELECT tile_data from tiles where zoom_level = ? AND tile_column = ? AND tile_row = ?";
+
+    // Content-derived id of a tile blob for the deduplicating schema:
+    // stable 64-bit hash plus the length. Different blobs can share an id, so
+    // TileInserter checks the stored bytes before reusing one.
+    std::string tileId(const std::string& data)
+    {
+        char buf[40];
+        std::snprintf(buf, sizeof(buf), "%016llx-%zx", (unsigned long long)detail::stableHash(data), data.size());
+        return buf;
+    }
+
+    // Prepared insert statement(s) for tiles, for either the plain "tiles" table
+    // or the deduplicating "map" + "images" tables.
+    class TileInserter
+    {
+    public:
+        TileInserter(sqlite3* database, bool deduplicate) :
+            _database(database)
+        {
+            const char* query = deduplicate ?
+                "INSERT OR REPLACE INTO map (zoom_level, tile_column, tile_row, tile_id) VALUES (?, ?, ?, ?)" :
+                "INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES (?, ?, ?, ?)";
+
+            if (sqlite3_prepare_v2(database, query, -1, &_tile, 0L) != SQLITE_OK)
+                _error = std::string("Failed to prepare SQL: ") + query + "; " + sqlite3_errmsg(database);
+
+            if (deduplicate)
+            {
+                query = "INSERT OR IGNORE INTO images (tile_id, tile_data) VALUES (?, ?)";
+                if (sqlite3_prepare_v2(database, query, -1, &_image, 0L) != SQLITE_OK)
+                    _error = std::string("Failed to prepare SQL: ") + query + "; " + sqlite3_errmsg(database);
+
+                query = "SELECT tile_data FROM images WHERE tile_id = ?";
+                if (sqlite3_prepare_v2(database, query, -1, &_stored, 0L) != SQLITE_OK)
+                    _error = std::string("Failed to prepare SQL: ") + query + "; " + sqlite3_errmsg(database);
+            }
+        }
+
+        ~TileInserter()
+        {
+            sqlite3_finalize(_tile);
+            sqlite3_finalize(_image);
+            sqlite3_finalize(_stored);
+        }
+
+        Result<> insert(const TileKey& key, const std::string& data)
+        {
+            if (!_error.empty())
+                return Failure(Failure::GeneralError, _error);
+
+            // flip Y axis
+            auto [numCols, numRows] = key.profile.numTiles(key.level);
+            int y = numRows - key.y - 1;
+
+            sqlite3_bind_int(_tile, 1, key.level);
+            sqlite3_bind_int(_tile, 2, key.x);
+            sqlite3_bind_int(_tile, 3, y);
+
+            std::string id;
+            if (_image)
+            {
+                auto r = storeImage(data, id);
+                if (r.failed())
+                    return r;
+
+                sqlite3_bind_text(_tile, 4, id.c_str(), (int)id.length(), SQLITE_STATIC);
+            }
+            else
+            {
+                sqlite3_bind_blob(_tile, 4, data.data(), (int)data.length(), SQLITE_STATIC);
+            }
 
+            return step(_tile);
+        }
+
+    private:
+        sqlite3* _database = nullptr;
+        sqlite3_stmt* _tile = nullptr;
+        sqlite3_stmt* _image = nullptr;
+        sqlite3_stmt* _stored = nullptr;
+        std::string _error;
+
+        // Stores a blob in "images", or finds the identical blob already there, and
+        // returns its id. A blob whose id is taken by different data gets the next
+        // free "-N" suffix instead.
+        Result<> storeImage(const std::string& data, std::string& id)
+        {
+            const std::string base = tileId(data);
+            id = base;
+
+            for (unsigned suffix = 1; ; ++suffix)
+            {
+                sqlite3_bind_text(_image, 1, id.c_str(), (int)id.length(), SQLITE_STATIC);
+                sqlite3_bind_blob(_image, 2, data.data(), (int)data.length(), SQLITE_STATIC);
+                auto r = step(_image);
+                if (r.failed())
+                    return r;
+
+                if (sqlite3_changes(_database) > 0)
+                    return ResultVoidOK;
+
+                // the id was taken; reuse it only if it holds the same bytes.
+                sqlite3_bind_text(_stored, 1, id.c_str(), (int)id.length(), SQLITE_STATIC);
+                int rc = sqlite3_step(_stored);
+                bool same = false;
+                if (rc == SQLITE_ROW)
+                {
+                    auto size = (std::size_t)sqlite3_column_bytes(_stored, 0);
+                    auto stored = (const char*)sqlite3_column_blob(_stored, 0);
+                    same = size == data.size() && (size == 0 || std::memcmp(stored, data.data(), size) == 0);
+                }
+                sqlite3_reset(_stored);
+
+                if (rc != SQLITE_ROW)
+                {
+                    return Failure(Failure::GeneralError, "Failed query: " + std::string(sqlite3_sql(_stored)) +
+                        "(" + std::to_string(rc) + ")" + sqlite3_errstr(rc) + "; " + sqlite3_errmsg(_database));
+                }
+
+                if (same)
+                    return ResultVoidOK;
+
+                id = base + "-" + std::to_string(suffix);
+            }
+        }
+
+        Result<> step(sqlite3_stmt* statement)
+        {
+            int rc = sqlite3_step(statement);
+            sqlite3_reset(statement);
+            if (rc != SQLITE_OK && rc != SQLITE_DONE)
+            {
+                return Failure(Failure::GeneralError, "Failed query: " + std::string(sqlite3_sql(statement)) +
+                    "(" + std::to_string(rc) + ")" + sqlite3_errstr(rc) + "; " + sqlite3_errmsg(_database));
+            }
+            return ResultVoidOK;
+        }
+    };
+}
+
+MBTiles::Driver::Reader::Reader(Reader&& rhs) noexcept :
+    database(rhs.database),
+    select(rhs.select)
+{
+    rhs.database = nullptr;
+    rhs.select = nullptr;
+}
+
+MBTiles::Driver::Reader::~Reader()
+{
+    if (select)
+        sqlite3_finalize((sqlite3_stmt*)select);
+    if (database)
+        sqlite3_close_v2((sqlite3*)database);
+}
 
 MBTiles::Driver::Driver() :
     _minLevel(0),
@@ -39,6 +201,18 @@ MBTiles::Driver::~Driver()
 void
 MBTiles::Driver::close()
 {
+    // land any tiles still queued by writeAsync.
+    if (_bulk)
+    {
+        auto r = flush();
+        if (r.failed())
+            Log()->warn(LC "Failed to write tiles to " + _name + ": " + r.error().message);
+        _bulk = nullptr;
+    }
+
+    // safely shut down all per-thread connections.
+    _readers.clear();
+
     if (_database != nullptr)
     {
         sqlite3* database = (sqlite3*)_database;
@@ -57,8 +231,10 @@ MBTiles::Driver::open(
     const IOOptions& io)
 {
     _name = name;
+    _options = options;
 
     std::string fullFilename = options.uri->full();
+    _filename = fullFilename;
 
     bool readWrite = isWritingRequested;
 
@@ -99,12 +275,26 @@ MBTiles::Driver::open(
         return Failure(Failure::ResourceUnavailable, "Database \"" + fullFilename + "\": " + sqlite3_errmsg(database));
     }
 
+    // In WAL mode the per-thread readers never block on, or get blocked by, the writer,
+    // and a commit only needs to sync the log.
+    if (readWrite)
+    {
+        sqlite3_exec((sqlite3*)_database, "PRAGMA journal_mode=WAL", nullptr, nullptr, nullptr);
+        sqlite3_exec((sqlite3*)_database, "PRAGMA synchronous=NORMAL", nullptr, nullptr, nullptr);
+        sqlite3_busy_timeout((sqlite3*)_database, 5000);
+
+        _bulk = std::make_shared<BulkWriter>();
+        _bulk->batchSize = std::max(options.batchSize.value(), 1u);
+    }
+
     // New database setup:
     if (isNewDatabase)
     {
         // Make sure we have a readerwriter for the underlying tile format:
         _tileFormat = options.format.value();
 
+        _deduplicate = options.deduplicate.value();
+
         // create necessary db tables:
         createTables();
 
@@ -129,6 +319,14 @@ MBTiles::Driver::open(
     // If the database pre-existed, read in the information from the metadata.
     else // !isNewDatabase
     {
+        // a "map" table means tiles are stored with the deduplicating schema
+        sqlite3_stmt* select = nullptr;
+        if (sqlite3_prepare_v2((sqlite3*)_database, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'map'", -1, &select, 0L) == SQLITE_OK)
+        {
+            _deduplicate = (sqlite3_step(select) == SQLITE_ROW);
+        }
+        sqlite3_finalize(select);
+
         computeLevels();
         //Log::info() << "Got levels from database " << _minLevel << ", " << _maxLevel << std::endl;
 
@@ -291,11 +489,43 @@ MBTiles::Driver::readMaxLevel()
     return result;
 }
 
+Result<>
+MBTiles::Driver::openReader(Reader& reader) const
+{
+    sqlite3* database = nullptr;
+    int rc = sqlite3_open_v2(_filename.c_str(), &database, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, 0L);
+    if (rc != SQLITE_OK)
+    {
+        Failure failure(Failure::ResourceUnavailable, "Database \"" + _filename + "\": " + sqlite3_errstr(rc));
+        sqlite3_close_v2(database);
+        return failure;
+    }
+
+    // wait out a writer's lock instead of failing the read.
+    sqlite3_busy_timeout(database, 1000);
+
+    // let sqlite read tile pages straight from a memory map.
+    sqlite3_exec(database, "PRAGMA mmap_size=268435456", nullptr, nullptr, nullptr);
+
+    sqlite3_stmt* select = nullptr;
+    rc = sqlite3_prepare_v3(database, tileQuery, -1, SQLITE_PREPARE_PERSISTENT, &select, 0L);
+    if (rc != SQLITE_OK)
+    {
+        // leave the reader empty so this thread's next read tries again
+        Failure failure(Failure::GeneralError, std::string("Failed to prepare SQL: ") + tileQuery + "; " + sqlite3_errmsg(database));
+        sqlite3_close_v2(database);
+        return failure;
+    }
+
+    reader.database = database;
+    reader.select = select;
+
+    return ResultVoidOK;
+}
+
 Result<std::shared_ptr<Image>>
 MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
 {
-    std::scoped_lock lock(_mutex);
-
     int z = key.level;
     int x = key.x;
     int y = key.y;
@@ -314,41 +544,39 @@ MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
     auto [numCols, numRows] = key.profile.numTiles(key.level);
     y = numRows - y - 1;
 
-    sqlite3* database = (sqlite3*)_database;
-
-    //Get the image
-    sqlite3_stmt* select = NULL;
-    std::string query = "SELECT tile_data from tiles where zoom_level = ? AND tile_column = ? AND tile_row = ?";
-    int rc = sqlite3_prepare_v2(database, query.c_str(), -1, &select, 0L);
-    if (rc != SQLITE_OK)
+    // each thread reads through its own connection and prepared query:
+    auto reader = _readers.access();
+    if (!reader->select)
     {
-        return Failure(Failure::GeneralError, "Failed to prepare SQL: " + query + "; " + sqlite3_errmsg(database));
+        auto r = openReader(*reader);
+        if (r.failed())
+            return r.error();
     }
 
-    bool valid = true;
+    sqlite3_stmt* select = (sqlite3_stmt*)reader->select;
 
     sqlite3_bind_int(select, 1, z);
     sqlite3_bind_int(select, 2, x);
     sqlite3_bind_int(select, 3, y);
 
+    bool valid = true;
     Image::Ptr result;
     std::string errorMessage;
 
-    rc = sqlite3_step(select);
+    int rc = sqlite3_step(select);
     if (rc == SQLITE_ROW)
     {
-        // the pointer returned from _blob gets freed internally by sqlite, supposedly
+        // the blob belongs to sqlite and stays valid until the statement is reset,
+        // so decode it in place rather than copying it.
         const char* data = (const char*)sqlite3_column_blob(select, 0);
         int dataLen = sqlite3_column_bytes(select, 0);
 
-        std::string dataBuffer(data, dataLen);
-
 #ifdef ROCKY_HAS_ZLIB
         // decompress if necessary:
+        std::string value;
         if (_options.compress == true)
         {
-            std::istringstream inputStream(dataBuffer);
-            std::string value;
+            MemoryInputStream inputStream(data, dataLen);
 
             if (!ZLibCompressor().decompress(inputStream, value))
             {
@@ -357,7 +585,8 @@ MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
             }
             else
             {
-                dataBuffer = value;
+                data = value.data();
+                dataLen = (int)value.size();
             }
         }
 #endif // ROCKY_HAS_ZLIB
@@ -365,14 +594,14 @@ MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
         // decode the raw image data:
         if (valid)
         {
-            std::istringstream inputStream(dataBuffer);
-            auto r = io.services().readImageFromStream(inputStream, {}, io);
+            auto r = io.services().readImageFromBuffer(std::string_view(data, dataLen), {}, io);
             if (r.ok())
                 result = r.value();
         }
     }
 
-    sqlite3_finalize(select);
+    // ready the statement for this thread's next read
+    sqlite3_reset(select);
 
     if (!valid)
     {
@@ -385,18 +614,31 @@ MBTiles::Driver::read(const TileKey& key, const IOOptions& io) const
         return Failure_GeneralError;
 }
 
-
-Result<>
-MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const IOOptions& io) const
+Result<std::size_t>
+MBTiles::Driver::imageCount() const
 {
-    if (!key.valid() || !input)
-        return Failure_AssertionFailure;
+    std::scoped_lock lock(_mutex);
 
-    if (!io.services().writeImageToStream)
-        return Failure_ServiceUnavailable;
+    sqlite3* database = (sqlite3*)_database;
+    std::string query = _deduplicate ? "SELECT COUNT(*) FROM images" : "SELECT COUNT(*) FROM tiles";
 
-    std::scoped_lock lock(_mutex);
+    sqlite3_stmt* select = nullptr;
+    if (sqlite3_prepare_v2(database, query.c_str(), -1, &select, 0L) != SQLITE_OK)
+    {
+        return Failure(Failure::GeneralError, "Failed to prepare SQL: " + query + "; " + sqlite3_errmsg(database));
+    }
 
+    std::size_t count = 0;
+    if (sqlite3_step(select) == SQLITE_ROW)
+        count = (std::size_t)sqlite3_column_int64(select, 0);
+
+    sqlite3_finalize(select);
+    return count;
+}
+
+Result<std::string>
+MBTiles::Driver::encode(std::shared_ptr<Image> input, const IOOptions& io) const
+{
     // encode the data stream:
     std::stringstream buf;
 
@@ -413,7 +655,7 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
         );
     }
 
-    auto wr = io.services().writeImageToStream(image_to_write, buf, _options.format, io);
+    auto wr = io.services().writeImageToStream(image_to_write, buf, _tileFormat, io);
 
     if (wr.failed())
         return wr.error();
@@ -433,49 +675,30 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
     }
 #endif // ROCKY_HAS_ZLIB
 
-    int z = key.level;
-    int x = key.x;
-    int y = key.y;
-
-    // flip Y axis
-    auto [numCols, numRows] = key.profile.numTiles(key.level);
-    y = numRows - y - 1;
-
-    sqlite3* database = (sqlite3*)_database;
+    return value;
+}
 
-    // Prep the insert statement:
-    sqlite3_stmt* insert = NULL;
-    std::string query = "INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES (?, ?, ?, ?)";
-    int rc = sqlite3_prepare_v2(database, query.c_str(), -1, &insert, 0L);
-    if (rc != SQLITE_OK)
-    {
-        auto a = "Failed to prepare SQL: " + query + "; " + sqlite3_errmsg(database);
-        return Failure(Failure::GeneralError, a);
-    }
+Result<>
+MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const IOOptions& io) const
+{
+    if (!key.valid() || !input)
+        return Failure_AssertionFailure;
 
-    // bind parameters:
-    sqlite3_bind_int(insert, 1, z);
-    sqlite3_bind_int(insert, 2, x);
-    sqlite3_bind_int(insert, 3, y);
+    if (!io.services().writeImageToStream)
+        return Failure_ServiceUnavailable;
 
-    // bind the data blob:
-    sqlite3_bind_blob(insert, 4, value.c_str(), (int)value.length(), SQLITE_STATIC);
+    // encode outside the lock so concurrent writers only serialize on the insert
+    auto value = encode(input, io);
+    if (value.failed())
+        return value.error();
 
-    // run the sql.
-    bool ok = true;
-    int tries = 0;
-    do {
-        rc = sqlite3_step(insert);
-    } while (++tries < 100 && (rc == SQLITE_BUSY || rc == SQLITE_LOCKED));
+    std::scoped_lock lock(_mutex);
 
-    if (SQLITE_OK != rc && SQLITE_DONE != rc)
-    {
-        auto a = "Failed query: " + query + "(" + std::to_string(rc) + ")" + sqlite3_errstr(rc) + "; " + sqlite3_errmsg(database);
-        return Failure(Failure::GeneralError, a);
-        ok = false;
-    }
+    TileInserter inserter((sqlite3*)_database, _deduplicate);
 
-    sqlite3_finalize(insert);
+    auto r = inserter.insert(key, value.value());
+    if (r.failed())
+        return r;
 
     // adjust the max level if necessary
     if (key.level > _maxLevel)
@@ -490,6 +713,168 @@ MBTiles::Driver::write(const TileKey& key, std::shared_ptr<Image> input, const I
     return ResultVoidOK;
 }
 
+struct MBTiles::Driver::BulkWriter
+{
+    struct Tile
+    {
+        TileKey key;
+        std::string data;
+    };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<Tile> queue;        // encoded, waiting to be committed
+    unsigned inFlight = 0;          // queued by writeAsync and not yet committed
+    unsigned batchSize = 1024;
+    bool committing = false;
+    std::optional<Failure> error;
+
+    // Inserts a batch of tiles in one transaction. Called from one thread at a time.
+    void commit(Driver& driver, std::vector<Tile>& tiles)
+    {
+        Result<> r = ResultVoidOK;
+        {
+            std::scoped_lock lock(driver._mutex);
+
+            sqlite3* database = (sqlite3*)driver._database;
+            sqlite3_exec(database, "BEGIN", nullptr, nullptr, nullptr);
+
+            TileInserter inserter(database, driver._deduplicate);
+
+            for (auto& tile : tiles)
+            {
+                r = inserter.insert(tile.key, tile.data);
+                if (r.failed())
+                    break;
+
+                if (tile.key.level > driver._maxLevel)
+                    driver._maxLevel = tile.key.level;
+                if (tile.key.level < driver._minLevel)
+                    driver._minLevel = tile.key.level;
+            }
+
+            if (r.ok())
+            {
+                int rc = sqlite3_exec(database, "COMMIT", nullptr, nullptr, nullptr);
+                if (rc != SQLITE_OK)
+                    r = Failure(Failure::GeneralError, std::string("Failed to commit tiles: ") + sqlite3_errmsg(database));
+            }
+
+            if (r.failed())
+                sqlite3_exec(database, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+
+        std::scoped_lock lock(mutex);
+        inFlight -= (unsigned)tiles.size();
+        if (r.failed() && !error.has_value())
+            error = r.error();
+        condition.notify_all();
+    }
+};
+
+Result<>
+MBTiles::Driver::writeAsync(const TileKey& key, std::shared_ptr<Image> input, const IOOptions& io)
+{
+    if (!key.valid() || !input)
+        return Failure_AssertionFailure;
+
+    if (!io.services().writeImageToStream)
+        return Failure_ServiceUnavailable;
+
+    if (!_bulk)
+        return Failure(Failure::ResourceUnavailable, "Database is not open");
+
+    auto bulk = _bulk;
+
+    // bound the memory held by tiles waiting to be committed:
+    {
+        std::unique_lock lock(bulk->mutex);
+        bulk->condition.wait(lock, [&]() { return bulk->inFlight < bulk->batchSize * 4; });
+        ++bulk->inFlight;
+    }
+
+    auto& jobs = io.services().jobs;
+    jobs::context encodeContext{ "mbtiles encode", jobs.get_pool("rocky::mbtiles_encode") };
+    jobs::context commitContext{ "mbtiles commit", jobs.get_pool("rocky::mbtiles_commit", 1) };
+
+    jobs.dispatch([this, bulk, key, input, io, commitContext]()
+        {
+            auto value = encode(input, io);
+
+            std::scoped_lock lock(bulk->mutex);
+
+            if (value.failed())
+            {
+                --bulk->inFlight;
+                if (!bulk->error.has_value())
+                    bulk->error = value.error();
+                bulk->condition.notify_all();
+                return;
+            }
+
+            bulk->queue.emplace_back(BulkWriter::Tile{ key, std::move(value.value()) });
+
+            // hand full batches to the single writer:
+            if (bulk->queue.size() >= bulk->batchSize && !bulk->committing)
+            {
+                bulk->committing = true;
+
+                io.services().jobs.dispatch([this, bulk]()
+                    {
+                        for (;;)
+                        {
+                            std::vector<BulkWriter::Tile> tiles;
+                            {
+                                std::scoped_lock lock(bulk->mutex);
+                                if (bulk->queue.size() < bulk->batchSize)
+                                {
+                                    bulk->committing = false;
+                                    bulk->condition.notify_all();
+                                    return;
+                                }
+                                tiles.swap(bulk->queue);
+                            }
+                            bulk->commit(*this, tiles);
+                        }
+                    },
+                    commitContext);
+            }
+        },
+        encodeContext);
+
+    return ResultVoidOK;
+}
+
+Result<>
+MBTiles::Driver::flush()
+{
+    if (!_bulk)
+        return ResultVoidOK;
+
+    auto bulk = _bulk;
+    std::vector<BulkWriter::Tile> tiles;
+
+    // wait for every queued tile to be encoded and any running commit to finish,
+    // then commit the partial batch that remains.
+    {
+        std::unique_lock lock(bulk->mutex);
+        bulk->condition.wait(lock, [&]() { return bulk->inFlight == bulk->queue.size() && !bulk->committing; });
+        tiles.swap(bulk->queue);
+    }
+
+    if (!tiles.empty())
+        bulk->commit(*this, tiles);
+
+    std::scoped_lock lock(bulk->mutex);
+    if (bulk->error.has_value())
+    {
+        Failure failure = bulk->error.value();
+        bulk->error.reset();
+        return failure;
+    }
+    return ResultVoidOK;
+}
+
 bool
 MBTiles::Driver::getMetaData(const std::string& key, std::string& value)
 {
@@ -602,6 +987,49 @@ MBTiles::Driver::createTables()
         return false;
     }
 
+    char* errorMsg = 0L;
+
+    if (_deduplicate)
+    {
+        // each distinct tile blob is stored once in "images", and "map" points
+        // every tile address at one; "tiles" becomes a view over the two.
+        const char* queries[] = {
+            "CREATE TABLE IF NOT EXISTS map ("
+            " zoom_level integer,"
+            " tile_column integer,"
+            " tile_row integer,"
+            " tile_id text)",
+
+            "CREATE TABLE IF NOT EXISTS images ("
+            " tile_data blob,"
+            " tile_id text)",
+
+            "CREATE UNIQUE INDEX IF NOT EXISTS map_index ON map ("
+            " zoom_level, tile_column, tile_row)",
+
+            "CREATE UNIQUE INDEX IF NOT EXISTS images_id ON images (tile_id)",
+
+            "CREATE VIEW IF NOT EXISTS tiles AS SELECT"
+            " map.zoom_level AS zoom_level,"
+            " map.tile_column AS tile_column,"
+            " map.tile_row AS tile_row,"
+            " images.tile_data AS tile_data"
+            " FROM map JOIN images ON images.tile_id = map.tile_id"
+        };
+
+        for (auto q : queries)
+        {
+            if (SQLITE_OK != sqlite3_exec(database, q, 0L, 0L, &errorMsg))
+            {
+                Log()->warn(LC "Failed to create tables: " + std::string(errorMsg));
+                sqlite3_free(errorMsg);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     query =
         "CREATE TABLE IF NOT EXISTS tiles ("
         " zoom_level integer,"
@@ -609,8 +1037,6 @@ MBTiles::Driver::createTables()
         " tile_row integer,"
         " tile_data blob)";
 
-    char* errorMsg = 0L;
-
     if (SQLITE_OK != sqlite3_exec(database, query.c_str(), 0L, 0L, &errorMsg))
     {
         Log()->warn(LC "Failed to create table [tiles]: " + std::string(errorMsg));
@@ -10,6 +10,8 @@
 #include <rocky/Result.h>
 #include <rocky/URI.h>
 #include <rocky/TileKey.h>
+#include <rocky/Threading.h>
+#include <atomic>
 
 namespace ROCKY_NAMESPACE
 {
@@ -30,6 +32,13 @@ namespace ROCKY_NAMESPACE
 
             //! Whether to use compression on individual tile data
             option<bool> compress = false;
+
+            //! When creating a database, whether to store identical tiles (like empty
+            //! ocean tiles) only once, using the MBTiles "map" and "images" tables
+            option<bool> deduplicate = false;
+
+            //! Number of tiles committed per transaction by Driver::writeAsync
+            option<unsigned> batchSize = 1024u;
         };
 
         /**
@@ -60,26 +69,67 @@ namespace ROCKY_NAMESPACE
                 std::shared_ptr<Image> image,
                 const IOOptions& io) const;
 
+            //! Queues a tile for writing, for seeding large numbers of tiles.
+            //! Tiles are encoded and compressed in parallel on the jobs runtime and
+            //! committed in batched transactions by a single writer. Blocks while
+            //! too many tiles are waiting to be committed.
+            //! Call flush() to wait for the queued tiles to reach the database.
+            Result<> writeAsync(
+                const TileKey& key,
+                std::shared_ptr<Image> image,
+                const IOOptions& io);
+
+            //! Waits until every tile queued with writeAsync is committed.
+            //! @return The first failure since the last flush, if any
+            Result<> flush();
+
+            //! Number of distinct tile images stored in the database; the same as
+            //! the number of tiles unless the database deduplicates them.
+            Result<std::size_t> imageCount() const;
+
             void setDataExtents(const DataExtentList&);
             bool getMetaData(const std::string& name, std::string& value);
             bool putMetaData(const std::string& name, const std::string& value);
 
         private:
+            //! Read-only connection and prepared tile query owned by a single thread
+            struct Reader
+            {
+                Reader() = default;
+                Reader(Reader&&) noexcept;
+                Reader& operator=(Reader&&) = delete;
+                ~Reader();
+                void* database = nullptr;
+                void* select = nullptr;
+            };
+
+            struct BulkWriter;
+
             void* _database;
-            mutable unsigned _minLevel;
-            mutable unsigned _maxLevel;
+            mutable std::atomic<unsigned> _minLevel;
+            mutable std::atomic<unsigned> _maxLevel;
             std::shared_ptr<Image> _emptyImage;
             Options _options;
             std::string _tileFormat;
             bool _forceRGB;
             std::string _name;
+            std::string _filename;
+            bool _deduplicate = false;
 
-            // because no one knows if/when sqlite3 is threadsafe.
+            // serializes use of the main connection (metadata and writes).
             mutable std::mutex _mutex;
 
+            // tile reads use a separate connection per thread so they can run in parallel.
+            mutable detail::ThreadLocal<Reader> _readers;
+
+            // queue and batching state for writeAsync
+            std::shared_ptr<BulkWriter> _bulk;
+
             bool createTables();
             void computeLevels();
             Result<int> readMaxLevel();
+            Result<> openReader(Reader&) const;
+            Result<std::string> encode(std::shared_ptr<Image> image, const IOOptions& io) const;
         };
     }
 }
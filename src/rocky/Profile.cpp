@@ -8,6 +8,7 @@
 #include "Math.h"
 #include "Utils.h"
 #include "json.h"
+#include <mutex>
 
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::detail;
@@ -81,6 +82,26 @@ Profile::setup(const SRS& srs, const Box& bounds, unsigned width0, unsigned heig
     }
 }
 
+namespace
+{
+    // Every distinct profile that has been asked for its index; index N is at N-1.
+    struct ProfileIndex
+    {
+        std::mutex mutex;
+        std::vector<Profile> profiles;
+        bool reportedFull = false;
+    };
+
+    // Data::index of a profile that did not fit in the registry
+    constexpr unsigned noIndex = ~0u;
+
+    ProfileIndex& profileIndex()
+    {
+        static ProfileIndex instance;
+        return instance;
+    }
+}
+
 // invalid profile
 Profile::Profile()
 {
@@ -117,6 +138,51 @@ Profile::equivalentTo(const Profile& rhs) const
     return _shared->extent.srs().horizontallyEquivalentTo(rhs._shared->extent.srs());
 }
 
+unsigned
+Profile::index() const
+{
+    auto index = _shared->index.load(std::memory_order_relaxed);
+    if (index == noIndex)
+        return 0;
+    if (index > 0 || !valid())
+        return index;
+
+    auto& registry = profileIndex();
+    std::scoped_lock lock(registry.mutex);
+
+    // unlike equivalentTo(), the vertical datum counts here: TileIds key caches of
+    // data (e.g. elevation) whose values depend on it.
+    for (unsigned i = 0; i < registry.profiles.size() && index == 0; ++i)
+    {
+        auto& entry = registry.profiles[i];
+        if (entry.equivalentTo(*this) && entry.srs().equivalentTo(srs()))
+            index = i + 1;
+    }
+
+    if (index == 0)
+    {
+        if (registry.profiles.size() < TileId::maxProfileIndex)
+        {
+            registry.profiles.emplace_back(*this);
+            index = (unsigned)registry.profiles.size();
+        }
+        else
+        {
+            if (!registry.reportedFull)
+            {
+                Log()->error("Profile index is full ({} profiles); tiles in profile {} have no TileId "
+                    "and cannot be paged or cached by id", TileId::maxProfileIndex, to_json());
+                registry.reportedFull = true;
+            }
+            _shared->index = noIndex;
+            return 0;
+        }
+    }
+
+    _shared->index = index;
+    return index;
+}
+
 Profile::Profile(const std::string& wellKnownName)
 {
     _shared = std::make_shared<Data>();
@@ -7,6 +7,7 @@
 
 #include <rocky/Common.h>
 #include <rocky/GeoExtent.h>
+#include <atomic>
 #include <vector>
 #include <string>
 
@@ -142,6 +143,12 @@ namespace ROCKY_NAMESPACE
         //! Get the hash code for this profile
         inline std::size_t hash() const;
 
+        //! Small number (1-31) identifying this profile, and all profiles equivalent
+        //! to it with the same vertical datum, for the life of the process; used to pack
+        //! TileIds. Zero if the profile is invalid or the process has already seen 31
+        //! other profiles, which is logged as an error.
+        unsigned index() const;
+
     protected:
 
         struct Data
@@ -153,6 +160,7 @@ namespace ROCKY_NAMESPACE
             unsigned    numTilesBaseY = 1u;
             std::size_t hash = 0;
             std::vector<Profile> subprofiles;
+            mutable std::atomic_uint index = { 0 };
         };
         std::shared_ptr<Data> _shared;
 
@@ -0,0 +1,379 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#include "Reprojection.h"
+#include "Image.h"
+#include "Heightfield.h"
+#include "IOTypes.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::detail;
+
+namespace
+{
+    inline bool same(double a, double b, double tolerance)
+    {
+        return std::abs(a - b) <= tolerance || (std::isnan(a) && std::isnan(b));
+    }
+
+    // Sample coordinates along one axis of the output raster
+    std::vector<double> axis_coords(double min, double max, unsigned count, bool pixelCenters)
+    {
+        std::vector<double> coords(count);
+        if (pixelCenters)
+        {
+            double d = (max - min) / (double)count;
+            for (unsigned i = 0; i < count; ++i)
+                coords[i] = min + (0.5 * d) + (d * (double)i);
+        }
+        else
+        {
+            double d = count > 1 ? (max - min) / (double)(count - 1) : 0.0;
+            for (unsigned i = 0; i < count; ++i)
+                coords[i] = min + (d * (double)i);
+        }
+        return coords;
+    }
+
+    // Per-column or per-row lookup table into one source image: the two texels
+    // to interpolate and the weight of the second, or i0 < 0 if outside the source.
+    struct Axis
+    {
+        std::vector<int> i0, i1;
+        std::vector<float> mix;
+    };
+
+    // Same bounds test and texel math as GeoImage::read + Image::read_bilinear.
+    void build_axis(const std::vector<double>& coords, double min, double size, unsigned texels, Axis& axis)
+    {
+        constexpr double eps = 1e-6;
+        const float last = (float)(texels - 1);
+
+        axis.i0.resize(coords.size());
+        axis.i1.resize(coords.size());
+        axis.mix.resize(coords.size());
+
+        for (unsigned i = 0; i < coords.size(); ++i)
+        {
+            double u = (coords[i] - min) / size;
+            if (!(u >= -eps && u <= 1.0 + eps))
+            {
+                axis.i0[i] = -1;
+                continue;
+            }
+
+            float s = (float)std::clamp(u, 0.0, 1.0) * last;
+            float s0 = std::max(std::floor(s), 0.0f);
+            float s1 = std::min(s0 + 1.0f, last);
+            axis.i0[i] = (int)s0;
+            axis.i1[i] = (int)s1;
+            axis.mix[i] = s0 < s1 ? (s - s0) / (s1 - s0) : 0.0f;
+        }
+    }
+
+    struct Source
+    {
+        const Image* image = nullptr;
+        Axis cols, rows;
+    };
+
+    std::vector<Source> build_sources(const ReprojectionGrid& grid, const std::vector<GeoImage>& sources)
+    {
+        std::vector<Source> result(sources.size());
+        for (unsigned i = 0; i < sources.size(); ++i)
+        {
+            auto& extent = sources[i].extent();
+            result[i].image = sources[i].image().get();
+            build_axis(grid.x, extent.xmin(), extent.width(), result[i].image->width(), result[i].cols);
+            build_axis(grid.y, extent.ymin(), extent.height(), result[i].image->height(), result[i].rows);
+        }
+        return result;
+    }
+
+    // Image::read_bilinear for a single float channel, including its no-data handling
+    inline float bilinear(float UL, float UR, float LL, float LR, float smix, float tmix, float nodata)
+    {
+        float top = UL == nodata ? UR : UR == nodata ? UL : UL * (1.0f - smix) + UR * smix;
+        float bot = LL == nodata ? LR : LR == nodata ? LL : LL * (1.0f - smix) + LR * smix;
+
+        if (top == nodata && bot == nodata)
+            return nodata;
+
+        return top == nodata ? bot : bot == nodata ? top : top * (1.0f - tmix) + bot * tmix;
+    }
+}
+
+ReprojectionGrid::ReprojectionGrid(const GeoExtent& extent, unsigned in_cols, unsigned in_rows,
+    bool pixelCenters, const SRS& sourceSRS, const GeoExtent& clampTo) :
+    cols(in_cols),
+    rows(in_rows)
+{
+    double minx, miny, maxx, maxy;
+    extent.getBounds(minx, miny, maxx, maxy);
+
+    auto xs = axis_coords(minx, maxx, cols, pixelCenters);
+    auto ys = axis_coords(miny, maxy, rows, pixelCenters);
+
+    SRSOperation xform = extent.srs().to(sourceSRS);
+
+    if (!xform.valid() || xform.noop())
+    {
+        separable = true;
+    }
+    else if (cols > 2 && rows > 2)
+    {
+        // Probe the first, middle and last rows and columns. The mapping is separable
+        // if source x only varies along the rows, source y only along the columns,
+        // and the vertical datum offset is constant.
+        const unsigned probeRows[3] = { 0u, rows / 2, rows - 1 };
+        const unsigned probeCols[3] = { 0u, cols / 2, cols - 1 };
+
+        // quick rejection test on a 3x3 subset first:
+        glm::dvec3 corners[9];
+        for (unsigned j = 0; j < 3; ++j)
+            for (unsigned i = 0; i < 3; ++i)
+                corners[j * 3 + i] = { xs[probeCols[i]], ys[probeRows[j]], 0.0 };
+        xform.transformArray(&corners[0], 9);
+
+        const double tolx = 1e-6 * std::abs(corners[2].x - corners[0].x) / (double)cols;
+        const double toly = 1e-6 * std::abs(corners[6].y - corners[0].y) / (double)rows;
+        const double tolz = 1e-6;
+
+        separable = std::isfinite(tolx) && std::isfinite(toly);
+        for (unsigned j = 0; j < 3 && separable; ++j)
+        {
+            for (unsigned i = 0; i < 3 && separable; ++i)
+            {
+                auto& p = corners[j * 3 + i];
+                separable =
+                    same(p.x, corners[i].x, tolx) &&
+                    same(p.y, corners[j * 3].y, toly) &&
+                    same(p.z, corners[0].z, tolz);
+            }
+        }
+
+        if (separable)
+        {
+            // full probe rows and columns:
+            std::vector<glm::dvec3> probe;
+            probe.reserve(3 * (cols + rows));
+            for (auto r : probeRows)
+                for (unsigned c = 0; c < cols; ++c)
+                    probe.emplace_back(xs[c], ys[r], 0.0);
+            for (auto c : probeCols)
+                for (unsigned r = 0; r < rows; ++r)
+                    probe.emplace_back(xs[c], ys[r], 0.0);
+
+            xform.transformArray(probe.data(), probe.size());
+
+            const glm::dvec3* rowProbes = probe.data();
+            const glm::dvec3* colProbes = probe.data() + 3 * cols;
+
+            for (unsigned j = 0; j < 3 && separable; ++j)
+            {
+                for (unsigned c = 0; c < cols && separable; ++c)
+                {
+                    auto& p = rowProbes[j * cols + c];
+                    separable =
+                        same(p.x, rowProbes[c].x, tolx) &&
+                        same(p.y, rowProbes[j * cols].y, toly) &&
+                        same(p.z, corners[0].z, tolz);
+                }
+            }
+
+            for (unsigned i = 0; i < 3 && separable; ++i)
+            {
+                for (unsigned r = 0; r < rows && separable; ++r)
+                {
+                    auto& p = colProbes[i * rows + r];
+                    separable =
+                        same(p.y, colProbes[r].y, toly) &&
+                        same(p.x, colProbes[i * rows].x, tolx) &&
+                        same(p.z, corners[0].z, tolz);
+                }
+            }
+
+            if (separable)
+            {
+                for (unsigned c = 0; c < cols; ++c)
+                    xs[c] = rowProbes[c].x;
+                for (unsigned r = 0; r < rows; ++r)
+                    ys[r] = colProbes[r].y;
+                z = corners[0].z;
+            }
+        }
+    }
+
+    if (separable)
+    {
+        if (xform.valid() && clampTo.valid())
+        {
+            for (auto& v : xs)
+                v = std::clamp(v, clampTo.xmin(), clampTo.xmax());
+            for (auto& v : ys)
+                v = std::clamp(v, clampTo.ymin(), clampTo.ymax());
+        }
+
+        x = std::move(xs);
+        y = std::move(ys);
+    }
+    else
+    {
+        // generic: transform every sample point.
+        points.resize(cols * rows);
+        for (unsigned r = 0; r < rows; ++r)
+            for (unsigned c = 0; c < cols; ++c)
+                points[r * cols + c] = { xs[c], ys[r], 0.0 };
+
+        if (xform.valid())
+        {
+            xform.transformArray(&points[0], points.size());
+
+            if (clampTo.valid())
+                clampTo.clamp(points.begin(), points.end());
+        }
+    }
+}
+
+bool
+ROCKY_NAMESPACE::detail::mosaicHeightfields(const ReprojectionGrid& grid,
+    const std::vector<GeoImage>& sources, Image& output, const IOOptions& io)
+{
+    if (!grid.separable)
+        return false;
+
+    if (output.pixelFormat() != HF_WRITABLE_FORMAT || output.width() != grid.cols || output.height() != grid.rows)
+        return false;
+
+    for (auto& source : sources)
+        if (!source.valid() || source.image()->pixelFormat() != HF_WRITABLE_FORMAT)
+            return false;
+
+    auto tables = build_sources(grid, sources);
+
+    for (unsigned r = 0; r < grid.rows; ++r)
+    {
+        float* out = output.data<float>() + r * grid.cols;
+
+        for (unsigned c = 0; c < grid.cols; ++c)
+        {
+            float height = NO_DATA_VALUE;
+
+            for (auto& source : tables)
+            {
+                int s0 = source.cols.i0[c], t0 = source.rows.i0[r];
+                if (s0 < 0 || t0 < 0)
+                    continue;
+
+                int s1 = source.cols.i1[c], t1 = source.rows.i1[r];
+                const float* data = source.image->data<float>();
+                unsigned w = source.image->width();
+
+                height = bilinear(
+                    data[t0 * w + s0], data[t0 * w + s1],
+                    data[t1 * w + s0], data[t1 * w + s1],
+                    source.cols.mix[c], source.rows.mix[r],
+                    source.image->noDataValue());
+
+                if (height != NO_DATA_VALUE)
+                    break;
+            }
+
+            if (height != NO_DATA_VALUE)
+            {
+                height -= (float)grid.z; // apply reverse vdatum offset
+            }
+
+            out[c] = height;
+        }
+
+        if (io.canceled())
+            return true;
+    }
+
+    return true;
+}
+
+bool
+ROCKY_NAMESPACE::detail::mosaicImages(const ReprojectionGrid& grid,
+    const std::vector<GeoImage>& sources, Image& output, const IOOptions& io)
+{
+    if (!grid.separable)
+        return false;
+
+    if (output.pixelFormat() != Image::R8G8B8A8_UNORM || output.width() != grid.cols || output.height() != grid.rows)
+        return false;
+
+    for (auto& source : sources)
+        if (!source.valid() || source.image()->pixelFormat() != Image::R8G8B8A8_UNORM)
+            return false;
+
+    auto tables = build_sources(grid, sources);
+
+    constexpr float denorm = 1.0f / 255.0f;
+
+    for (unsigned layer = 0; layer < output.depth(); ++layer)
+    {
+        for (unsigned r = 0; r < grid.rows; ++r)
+        {
+            // data<uint32_t> so that indexing is by whole pixels
+            auto* out = reinterpret_cast<std::uint8_t*>(output.data<std::uint32_t>(0, r, layer));
+
+            for (unsigned c = 0; c < grid.cols; ++c, out += 4)
+            {
+                bool wrote = false;
+
+                for (auto& source : tables)
+                {
+                    int s0 = source.cols.i0[c], t0 = source.rows.i0[r];
+                    if (s0 < 0 || t0 < 0 || layer >= source.image->depth())
+                        continue;
+
+                    int s1 = source.cols.i1[c], t1 = source.rows.i1[r];
+                    float smix = source.cols.mix[c], tmix = source.rows.mix[r];
+
+                    auto* UL = reinterpret_cast<const std::uint8_t*>(source.image->data<std::uint32_t>(s0, t0, layer));
+                    auto* UR = reinterpret_cast<const std::uint8_t*>(source.image->data<std::uint32_t>(s1, t0, layer));
+                    auto* LL = reinterpret_cast<const std::uint8_t*>(source.image->data<std::uint32_t>(s0, t1, layer));
+                    auto* LR = reinterpret_cast<const std::uint8_t*>(source.image->data<std::uint32_t>(s1, t1, layer));
+
+                    // same arithmetic as Image::read_bilinear on normalized components
+                    float pixel[4];
+                    for (int k = 3; k >= 0; --k)
+                    {
+                        float top = (float)UL[k] * denorm * (1.0f - smix) + (float)UR[k] * denorm * smix;
+                        float bot = (float)LL[k] * denorm * (1.0f - smix) + (float)LR[k] * denorm * smix;
+                        pixel[k] = top * (1.0f - tmix) + bot * tmix;
+
+                        // transparent; try the next source
+                        if (k == 3 && !(pixel[3] > 0.0f))
+                            break;
+                    }
+
+                    if (pixel[3] > 0.0f)
+                    {
+                        // same conversion as Image::write
+                        for (int k = 0; k < 4; ++k)
+                            out[k] = (std::uint8_t)(pixel[k] * 255.0f);
+                        wrote = true;
+                        break;
+                    }
+                }
+
+                if (!wrote)
+                {
+                    out[0] = out[1] = out[2] = out[3] = 0;
+                }
+            }
+
+            if (io.canceled())
+                return true;
+        }
+    }
+
+    return true;
+}
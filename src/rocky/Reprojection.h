@@ -0,0 +1,89 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/GeoImage.h>
+#include <rocky/GeoExtent.h>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    class IOOptions;
+
+    namespace detail
+    {
+        /**
+        * Locations, in the SRS of a set of source tiles, of the samples of an
+        * output raster. Used to reproject and mosaic tiles from a layer's native
+        * profile into the profile of a requested tile key.
+        *
+        * When the mapping between the two SRSs is separable (every output column
+        * maps to a single source x, and every output row to a single source y, as
+        * with geographic and spherical mercator) only cols + rows points are
+        * transformed and the resamplers below can use per-column and per-row lookup
+        * tables. Otherwise every sample point is transformed individually.
+        */
+        class ROCKY_EXPORT ReprojectionGrid
+        {
+        public:
+            //! Build the grid.
+            //! @param extent Extent of the output raster
+            //! @param cols Output raster width
+            //! @param rows Output raster height
+            //! @param pixelCenters True to sample pixel centers (imagery), false to
+            //!   sample edge to edge (heightfields)
+            //! @param sourceSRS SRS of the source tiles
+            //! @param clampTo Extent in sourceSRS to which to clamp the sample points, if valid
+            ReprojectionGrid(const GeoExtent& extent, unsigned cols, unsigned rows,
+                bool pixelCenters, const SRS& sourceSRS, const GeoExtent& clampTo = {});
+
+            //! Output raster width
+            unsigned cols = 0;
+
+            //! Output raster height
+            unsigned rows = 0;
+
+            //! Whether the grid is separable; if so "x", "y" and "z" are populated
+            //! instead of "points".
+            bool separable = false;
+
+            //! Source x for each output column (separable grids only)
+            std::vector<double> x;
+
+            //! Source y for each output row (separable grids only)
+            std::vector<double> y;
+
+            //! Vertical datum offset common to all points (separable grids only)
+            double z = 0.0;
+
+            //! Source location of each output sample, row by row (non-separable grids only).
+            //! The z component holds the vertical datum offset, if any.
+            std::vector<glm::dvec3> points;
+
+            //! Source location of the sample at output column c, row r
+            inline glm::dvec3 point(unsigned c, unsigned r) const {
+                return separable ? glm::dvec3(x[c], y[r], z) : points[r * cols + c];
+            }
+        };
+
+        //! Mosaics R32_SFLOAT heightfields into an R32_SFLOAT output the size of the
+        //! grid, taking each sample from the first source (in order) that has data there
+        //! and removing the vertical datum offset. Same result as GeoImage::read on
+        //! each source in turn.
+        //! @return False if the grid is not separable or the images are not all
+        //!   R32_SFLOAT, in which case the caller must use the generic path.
+        extern ROCKY_EXPORT bool mosaicHeightfields(const ReprojectionGrid& grid,
+            const std::vector<GeoImage>& sources, Image& output, const IOOptions& io);
+
+        //! Mosaics R8G8B8A8_UNORM images into an R8G8B8A8_UNORM output the size of the
+        //! grid, taking each pixel from the first source (in order) whose sample has a
+        //! non-zero alpha. Same result as GeoImage::read on each source in turn.
+        //! @return False if the grid is not separable or the images are not all
+        //!   R8G8B8A8_UNORM, in which case the caller must use the generic path.
+        extern ROCKY_EXPORT bool mosaicImages(const ReprojectionGrid& grid,
+            const std::vector<GeoImage>& sources, Image& output, const IOOptions& io);
+    }
+}
@@ -8,6 +8,11 @@
 #include "Context.h"
 
 #include <proj.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 #define LC "[SRS] "
@@ -52,6 +57,106 @@ namespace
     }
 
 
+    //! A definition string interned in the SRSRegistry, along with the properties
+    //! of it that don't depend on the thread (established lazily).
+    struct SRSDefinition
+    {
+        std::string definition;
+        std::atomic_int valid = { -1 };        // -1 = unknown
+        std::atomic_int horizCrsType = { -1 }; // PJ_TYPE, -1 = unknown
+    };
+
+    //! Results of comparing pairs of SRS's, by the pair of handles
+    struct SRSComparisons
+    {
+        std::shared_mutex mutex;
+        std::unordered_map<std::uint64_t, bool> results;
+
+        std::optional<bool> get(std::uint32_t a, std::uint32_t b)
+        {
+            std::shared_lock lock(mutex);
+            auto iter = results.find(((std::uint64_t)a << 32) | b);
+            return iter != results.end() ? std::optional<bool>(iter->second) : std::nullopt;
+        }
+
+        bool put(std::uint32_t a, std::uint32_t b, bool value)
+        {
+            std::unique_lock lock(mutex);
+            results[((std::uint64_t)a << 32) | b] = value;
+            return value;
+        }
+    };
+
+    //! Global registry of SRS definition strings, each identified by a handle.
+    //! Definitions are added but never changed or removed, so resolving a
+    //! handle takes no lock.
+    class SRSRegistry
+    {
+    public:
+        //! Intentionally never destroyed, since static and thread-local SRS's
+        //! may still be in use during static destruction.
+        static SRSRegistry& instance()
+        {
+            static SRSRegistry* registry = new SRSRegistry();
+            return *registry;
+        }
+
+        //! Handle of a definition, adding it if necessary; zero for an empty definition.
+        std::uint32_t intern(std::string_view definition)
+        {
+            if (definition.empty())
+                return 0u;
+
+            std::string key(definition);
+
+            std::scoped_lock lock(_mutex);
+
+            auto iter = _handles.find(key);
+            if (iter != _handles.end())
+                return iter->second;
+
+            auto handle = _count;
+            auto chunk = handle >> chunkBits;
+            if (chunk >= maxChunks)
+            {
+                Log()->warn(LC "Too many distinct SRS definitions; \"{}\" will be invalid", key);
+                return 0u;
+            }
+
+            if (_chunks[chunk].load(std::memory_order_relaxed) == nullptr)
+                _chunks[chunk].store(new SRSDefinition[chunkSize], std::memory_order_release);
+
+            get(handle).definition = key;
+            _handles.emplace(std::move(key), handle);
+            ++_count;
+            return handle;
+        }
+
+        //! Definition for a handle returned by intern().
+        SRSDefinition& get(std::uint32_t handle)
+        {
+            return _chunks[handle >> chunkBits].load(std::memory_order_acquire)[handle & (chunkSize - 1)];
+        }
+
+        SRSComparisons equivalent;
+        SRSComparisons horizontallyEquivalent;
+
+    private:
+        static constexpr std::uint32_t chunkBits = 10u;
+        static constexpr std::uint32_t chunkSize = 1u << chunkBits;
+        static constexpr std::uint32_t maxChunks = 4096u;
+
+        std::mutex _mutex;
+        std::unordered_map<std::string, std::uint32_t> _handles;
+        std::atomic<SRSDefinition*> _chunks[maxChunks] = { };
+        std::uint32_t _count = 1u; // zero is the empty definition
+
+        SRSRegistry()
+        {
+            _chunks[0] = new SRSDefinition[chunkSize];
+        }
+    };
+
     //! Per thread proj threading context.
     thread_local PJ_CONTEXT* g_pj_thread_local_context = nullptr;
 
@@ -60,7 +165,6 @@ namespace
 
     const Ellipsoid default_ellipsoid = { };
     const Box empty_box = { };
-    const std::string empty_string = { };
 
     //! Entry in the per-thread SRS data cache
     struct SRSEntry
@@ -82,23 +186,31 @@ namespace
     };
 
     //! SRS data factory and PROJ main interface
-    struct SRSFactory : public std::unordered_map<std::string, SRSEntry>
+    struct SRSFactory
     {
+        //! SRS entries by SRS handle
+        std::unordered_map<std::uint32_t, SRSEntry> srs;
+
+        //! Operation entries by pair of SRS handles
+        std::unordered_map<std::uint64_t, SRSEntry> operations;
+
         SRSFactory() = default;
 
         //! destroy cache entries and threading context upon descope
         ~SRSFactory()
         {
-            for (auto iter = begin(); iter != end(); ++iter)
+            for (auto& iter : srs)
             {
-                if (iter->second.pj)
-                {
-                    proj_destroy(iter->second.pj);
-                }
-                if (iter->second.pj_geodetic)
-                {
-                    proj_destroy(iter->second.pj_geodetic);
-                }
+                if (iter.second.pj)
+                    proj_destroy(iter.second.pj);
+                if (iter.second.pj_geodetic)
+                    proj_destroy(iter.second.pj_geodetic);
+            }
+
+            for (auto& iter : operations)
+            {
+                if (iter.second.pj)
+                    proj_destroy(iter.second.pj);
             }
 
             if (g_pj_thread_local_context)
@@ -117,25 +229,24 @@ namespace
             return g_pj_thread_local_context;
         }
 
-        const std::string& get_error_message(const std::string& def)
+        const std::string& get_error_message(std::uint32_t handle)
         {
-            auto iter = find(def);
-            if (iter == end())
-                return empty_string; // shouldn't happen
-            else
-                return iter->second.error;
+            // SRS validity is shared across threads, so this thread may not have tried yet
+            return get_or_create(handle).error;
         }
 
         //! retrieve or create a PJ projection object based on the provided definition string,
         //! which may be a proj string, a WKT string, an espg identifer, or a well-known alias
         //! like "spherical-mercator" or "wgs84".
-        SRSEntry& get_or_create(const std::string& def)
+        SRSEntry& get_or_create(std::uint32_t handle)
         {
             auto ctx = threading_context();
 
-            auto iter = find(def);
-            if (iter == end())
+            auto iter = srs.find(handle);
+            if (iter == srs.end())
             {
+                const std::string& def = SRSRegistry::instance().get(handle).definition;
+
                 PJ* pj = nullptr;
 
                 std::string to_try = trim(def);
@@ -201,7 +312,7 @@ namespace
                 }
 
                 // store in the cache (even if it failed)
-                SRSEntry& new_entry = (*this)[def];
+                SRSEntry& new_entry = srs[handle];
                 new_entry.pj = pj;
 
                 if (pj == nullptr)
@@ -310,7 +421,7 @@ namespace
                         {
                             // always returns lat/long, so transform back to this srs
                             std::string geo_def = proj_as_proj_string(ctx, new_entry.pj_geodetic, PJ_PROJ_5, nullptr);
-                            auto xform = get_or_create_operation(geo_def, def); // don't call proj_destroy on this
+                            auto xform = get_or_create_operation(SRS(geo_def).handle(), handle); // don't call proj_destroy on this
                             PJ_COORD LL = proj_trans(xform, PJ_FWD, PJ_COORD{ west_lon, south_lat, 0.0, 0.0 });
                             PJ_COORD UR = proj_trans(xform, PJ_FWD, PJ_COORD{ east_lon, north_lat, 0.0, 0.0 });
                             new_entry.bounds = Box(LL.xyz.x, LL.xyz.y, UR.xyz.x, UR.xyz.y);
@@ -349,7 +460,7 @@ namespace
                     if (new_entry.bounds.has_value() && !new_entry.geodeticBounds.has_value())
                     {
                         std::string geo_def = proj_as_proj_string(ctx, new_entry.pj_geodetic, PJ_PROJ_5, nullptr);
-                        auto xform = get_or_create_operation(def, geo_def); // don't call proj_destroy on this
+                        auto xform = get_or_create_operation(handle, SRS(geo_def).handle()); // don't call proj_destroy on this
                         PJ_COORD LL = proj_trans(xform, PJ_FWD, PJ_COORD{ new_entry.bounds->xmin, new_entry.bounds->ymin, 0.0, 0.0 });
                         PJ_COORD UR = proj_trans(xform, PJ_FWD, PJ_COORD{ new_entry.bounds->xmax, new_entry.bounds->ymax, 0.0, 0.0 });
                         new_entry.geodeticBounds = Box(LL.xyz.x, LL.xyz.y, UR.xyz.x, UR.xyz.y);
@@ -370,22 +481,22 @@ namespace
         }
 
         //! fetch the projection type
-        PJ_TYPE get_horiz_crs_type(const std::string& def)
+        PJ_TYPE get_horiz_crs_type(std::uint32_t handle)
         {
-            return get_or_create(def).horiz_crs_type;
+            return get_or_create(handle).horiz_crs_type;
         }
 
         //! fetch the ellipsoid associated with an SRS definition
         //! that was previously created
-        const Ellipsoid& get_ellipsoid(const std::string& def)
+        const Ellipsoid& get_ellipsoid(std::uint32_t handle)
         {
-            return get_or_create(def).ellipsoid;
+            return get_or_create(handle).ellipsoid;
         };
 
         //! Get the geodetic bounds of a projection if possible
-        const Box& get_geodetic_bounds(const std::string& def)
+        const Box& get_geodetic_bounds(std::uint32_t handle)
         {
-            SRSEntry& entry = get_or_create(def);
+            SRSEntry& entry = get_or_create(handle);
 
             if (entry.pj == nullptr || !entry.geodeticBounds.has_value())
                 return empty_box;
@@ -393,9 +504,9 @@ namespace
                 return entry.geodeticBounds.value();
         }
 
-        const Box& get_bounds(const std::string& def)
+        const Box& get_bounds(std::uint32_t handle)
         {
-            SRSEntry& entry = get_or_create(def);
+            SRSEntry& entry = get_or_create(handle);
 
             if (entry.pj == nullptr || !entry.bounds.has_value())
                 return empty_box;
@@ -403,21 +514,13 @@ namespace
                 return entry.bounds.value();
         }
 
-        const std::string& get_wkt(const std::string& def)
+        const std::string& get_wkt(std::uint32_t handle)
         {
-            auto iter = find(def);
-            if (iter == end())
-            {
-                get_or_create(def);
-                iter = find(def);
-                if (iter == end())
-                    return empty_string;
-            }
-            return iter->second.wkt;
+            return get_or_create(handle).wkt;
         }
 
         //! retrieve or create a transformation object
-        PJ* get_or_create_operation(const std::string& firstDef, const std::string& secondDef)
+        PJ* get_or_create_operation(std::uint32_t first, std::uint32_t second)
         {
             auto ctx = threading_context();
 
@@ -426,14 +529,14 @@ namespace
             std::string error;
 
             // make a unique identifer for the transformation
-            std::string def = firstDef + "->" + secondDef;
+            std::uint64_t id = ((std::uint64_t)first << 32) | second;
 
-            auto iter = find(def);
+            auto iter = operations.find(id);
 
-            if (iter == end())
+            if (iter == operations.end())
             {
-                auto& p1_def = get_or_create(firstDef);
-                auto& p2_def = get_or_create(secondDef);
+                auto& p1_def = get_or_create(first);
+                auto& p2_def = get_or_create(second);
                 PJ* p1 = p1_def.pj;
                 PJ* p2 = p2_def.pj;
                 if (p1 && p2)
@@ -452,6 +555,8 @@ namespace
                         // process the Z input.
                         if (p1_type == PJ_TYPE_GEOGRAPHIC_2D_CRS && p2_type == PJ_TYPE_COMPOUND_CRS)
                         {
+                            auto& registry = SRSRegistry::instance();
+                            std::string def = registry.get(first).definition + "->" + registry.get(second).definition;
                             std::string warning = "Warning, \"" + def + "\" transforms from GEOGRAPHIC_2D_CRS to COMPOUND_CRS. Z values will be discarded. Use a GEOGRAPHIC_3D_CRS instead";
                             redirect_proj_log(nullptr, 0, warning.c_str());
                         }
@@ -544,7 +649,7 @@ namespace
                     }
                 }
 
-                auto& new_entry = (*this)[def];
+                auto& new_entry = operations[id];
                 new_entry.pj = pj;
                 new_entry.proj = proj;
                 new_entry.error = error;
@@ -570,15 +675,21 @@ SRS::projVersion()
 }
 
 SRS::SRS(std::string_view h) :
-    _definition(h)
+    _handle(SRSRegistry::instance().intern(h))
 {
     //nop
 }
 
+const std::string&
+SRS::definition() const
+{
+    return SRSRegistry::instance().get(_handle).definition;
+}
+
 const char*
 SRS::name() const
 {
-    PJ* pj = g_srs_factory.get_or_create(_definition).pj;
+    PJ* pj = g_srs_factory.get_or_create(_handle).pj;
     if (!pj) return "";
     return proj_get_name(pj);
 }
@@ -586,8 +697,32 @@ SRS::name() const
 bool
 SRS::_establish_valid() const
 {
-    _valid = !_definition.empty() && g_srs_factory.get_or_create(_definition).pj != nullptr;
-    return _valid.value();
+    auto& def = SRSRegistry::instance().get(_handle);
+
+    int valid = def.valid.load(std::memory_order_relaxed);
+    if (valid < 0)
+    {
+        valid = g_srs_factory.get_or_create(_handle).pj != nullptr ? 1 : 0;
+        def.valid.store(valid, std::memory_order_relaxed);
+    }
+    return valid == 1;
+}
+
+namespace
+{
+    // horizontal CRS type of a valid SRS
+    inline PJ_TYPE horiz_crs_type(std::uint32_t handle)
+    {
+        auto& def = SRSRegistry::instance().get(handle);
+
+        int type = def.horizCrsType.load(std::memory_order_relaxed);
+        if (type < 0)
+        {
+            type = (int)g_srs_factory.get_horiz_crs_type(handle);
+            def.horizCrsType.store(type, std::memory_order_relaxed);
+        }
+        return (PJ_TYPE)type;
+    }
 }
 
 bool
@@ -596,14 +731,11 @@ SRS::isGeodetic() const
     if (!valid())
         return false;
 
-    if (!_crs_type.has_value())
-    {
-        _crs_type = g_srs_factory.get_horiz_crs_type(_definition);
-    }
+    auto type = horiz_crs_type(_handle);
 
     return
-        (PJ_TYPE)_crs_type.value() == PJ_TYPE_GEOGRAPHIC_2D_CRS ||
-        (PJ_TYPE)_crs_type.value() == PJ_TYPE_GEOGRAPHIC_3D_CRS;
+        type == PJ_TYPE_GEOGRAPHIC_2D_CRS ||
+        type == PJ_TYPE_GEOGRAPHIC_3D_CRS;
 }
 
 bool
@@ -612,12 +744,7 @@ SRS::isGeocentric() const
     if (!valid())
         return false;
 
-    if (!_crs_type.has_value())
-    {
-        _crs_type = (int)g_srs_factory.get_horiz_crs_type(_definition);
-    }
-
-    return (PJ_TYPE)_crs_type.value() == PJ_TYPE_GEOCENTRIC_CRS;
+    return horiz_crs_type(_handle) == PJ_TYPE_GEOCENTRIC_CRS;
 }
 
 bool
@@ -626,12 +753,7 @@ SRS::isProjected() const
     if (!valid())
         return false;
 
-    if (!_crs_type.has_value())
-    {
-        _crs_type = (int)g_srs_factory.get_horiz_crs_type(_definition);
-    }
-
-    return (PJ_TYPE)_crs_type.value() == PJ_TYPE_PROJECTED_CRS;
+    return horiz_crs_type(_handle) == PJ_TYPE_PROJECTED_CRS;
 }
 
 bool
@@ -640,7 +762,7 @@ SRS::isQSC() const
     if (!valid())
         return false;
 
-    return g_srs_factory.get_or_create(definition()).isQSC;
+    return g_srs_factory.get_or_create(_handle).isQSC;
 }
 
 bool
@@ -649,52 +771,70 @@ SRS::hasVerticalDatumShift() const
     if (!valid())
         return false;
 
-    return g_srs_factory.get_or_create(definition()).vert_crs_type != PJ_TYPE_UNKNOWN;
+    return g_srs_factory.get_or_create(_handle).vert_crs_type != PJ_TYPE_UNKNOWN;
 }
 
 bool
 SRS::equivalentTo(const SRS& rhs) const
 {
-    if (definition().empty() || rhs.definition().empty())
+    if (_handle == 0u || rhs._handle == 0u)
         return false;
 
-    PJ* pj1 = g_srs_factory.get_or_create(definition()).pj;
+    if (_handle == rhs._handle)
+        return valid();
+
+    auto& comparisons = SRSRegistry::instance().equivalent;
+
+    auto cached = comparisons.get(_handle, rhs._handle);
+    if (cached.has_value())
+        return cached.value();
+
+    PJ* pj1 = g_srs_factory.get_or_create(_handle).pj;
     if (!pj1)
-        return false;
+        return comparisons.put(_handle, rhs._handle, false);
 
-    PJ* pj2 = g_srs_factory.get_or_create(rhs.definition()).pj;
+    PJ* pj2 = g_srs_factory.get_or_create(rhs._handle).pj;
     if (!pj2)
-        return false;
+        return comparisons.put(_handle, rhs._handle, false);
 
     PJ_COMPARISON_CRITERION criterion =
         isGeodetic() ? PJ_COMP_EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS :
         PJ_COMP_EQUIVALENT;
 
-    return proj_is_equivalent_to_with_ctx(
-        g_srs_factory.threading_context(), pj1, pj2, criterion);
+    return comparisons.put(_handle, rhs._handle, proj_is_equivalent_to_with_ctx(
+        g_srs_factory.threading_context(), pj1, pj2, criterion));
 }
 
 bool
 SRS::horizontallyEquivalentTo(const SRS& rhs) const
 {
-    if (definition().empty() || rhs.definition().empty())
+    if (_handle == 0u || rhs._handle == 0u)
         return false;
 
+    if (_handle == rhs._handle)
+        return valid();
+
+    auto& comparisons = SRSRegistry::instance().horizontallyEquivalent;
+
+    auto cached = comparisons.get(_handle, rhs._handle);
+    if (cached.has_value())
+        return cached.value();
+
     if (isGeodetic() && rhs.isGeodetic() && ellipsoid() == rhs.ellipsoid())
-        return true;
+        return comparisons.put(_handle, rhs._handle, true);
 
-    auto& lhs_entry = g_srs_factory.get_or_create(definition());
+    auto& lhs_entry = g_srs_factory.get_or_create(_handle);
     PJ* pj1 = lhs_entry.pj;
     if (!pj1)
-        return false;
+        return comparisons.put(_handle, rhs._handle, false);
 
-    auto& rhs_entry = g_srs_factory.get_or_create(rhs.definition());
+    auto& rhs_entry = g_srs_factory.get_or_create(rhs._handle);
     PJ* pj2 = rhs_entry.pj;
     if (!pj2)
-        return false;
+        return comparisons.put(_handle, rhs._handle, false);
 
     if (lhs_entry.crs_type != rhs_entry.crs_type)
-        return false;
+        return comparisons.put(_handle, rhs._handle, false);
 
     // compare only the horizontal CRS components:
     PJ* lhs_horiz_pj = nullptr;
@@ -710,14 +850,14 @@ SRS::horizontallyEquivalentTo(const SRS& rhs) const
         isGeodetic() ? PJ_COMP_EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS :
         PJ_COMP_EQUIVALENT;
 
-    return proj_is_equivalent_to_with_ctx(
-        g_srs_factory.threading_context(), lhs_horiz_pj, rhs_horiz_pj, criterion);
+    return comparisons.put(_handle, rhs._handle, proj_is_equivalent_to_with_ctx(
+        g_srs_factory.threading_context(), lhs_horiz_pj, rhs_horiz_pj, criterion));
 }
 
 const std::string&
 SRS::wkt() const
 {
-    return g_srs_factory.get_wkt(definition());
+    return g_srs_factory.get_wkt(_handle);
 }
 
 UnitsType
@@ -729,19 +869,19 @@ SRS::units() const
 const Ellipsoid&
 SRS::ellipsoid() const
 {
-    return g_srs_factory.get_ellipsoid(definition());
+    return g_srs_factory.get_ellipsoid(_handle);
 }
 
 const Box&
 SRS::bounds() const
 {
-    return g_srs_factory.get_bounds(definition());
+    return g_srs_factory.get_bounds(_handle);
 }
 
 const Box&
 SRS::geodeticBounds() const
 {
-    return g_srs_factory.get_geodetic_bounds(definition());
+    return g_srs_factory.get_geodetic_bounds(_handle);
 }
 
 SRSOperation
@@ -753,13 +893,13 @@ SRS::to(const SRS& rhs) const
 const SRS&
 SRS::geodeticSRS() const
 {
-    return isGeodetic() ? *this : g_srs_factory.get_or_create(_definition).geodeticSRS;
+    return isGeodetic() ? *this : g_srs_factory.get_or_create(_handle).geodeticSRS;
 }
 
 const SRS&
 SRS::geocentricSRS() const
 {
-    return isGeocentric() ? *this : g_srs_factory.get_or_create(_definition).geocentricSRS;
+    return isGeocentric() ? *this : g_srs_factory.get_or_create(_handle).geocentricSRS;
 }
 
 glm::dmat4
@@ -875,124 +1015,275 @@ SRS::transformDistance(const Distance& input, const UnitsType& outputUnits, cons
 const std::string&
 SRS::errorMessage() const
 {
-    return g_srs_factory.get_error_message(definition());
+    return g_srs_factory.get_error_message(_handle);
 }
 
 std::string
 SRS::string() const
 {
     if (valid())
-        return g_srs_factory.get_or_create(definition()).proj;
+        return g_srs_factory.get_or_create(_handle).proj;
     else
         return "";
 }
 
+namespace
+{
+    // Built-in transforms between WGS84 and ECEF or spherical mercator, the SRS pairs
+    // rocky uses the most. Each one returns false for a point it doesn't handle (which
+    // then goes to PROJ), and is exact to well under a millimeter otherwise.
+    namespace kernels
+    {
+        enum Path : std::uint8_t
+        {
+            NONE = 0,
+            GEODETIC_TO_GEOCENTRIC = 1,
+            GEOCENTRIC_TO_GEODETIC = 2,
+            GEODETIC_TO_MERCATOR = 3,
+            MERCATOR_TO_GEODETIC = 4
+        };
+
+        //! The path running the opposite direction
+        inline std::uint8_t inverse_of(std::uint8_t path) {
+            if (path == NONE) return NONE;
+            return (std::uint8_t)((path & 1) ? path + 1 : path - 1);
+        }
+
+        // WGS84 ellipsoid
+        constexpr double a = 6378137.0;
+        constexpr double f = 1.0 / 298.257223563;
+        constexpr double b = a * (1.0 - f);
+        constexpr double e2 = f * (2.0 - f);
+        constexpr double ep2 = e2 / (1.0 - e2);
+
+        // spherical mercator (EPSG:3857) sphere radius
+        constexpr double R = 6378137.0;
+
+        constexpr double to_rad = 3.14159265358979323846 / 180.0;
+        constexpr double to_deg = 180.0 / 3.14159265358979323846;
+
+        inline bool geodetic_to_geocentric(double& x, double& y, double& z)
+        {
+            if (!(std::abs(y) <= 90.0) || !std::isfinite(x) || !std::isfinite(z))
+                return false;
+
+            double lon = x * to_rad, lat = y * to_rad;
+            double sin_lat = std::sin(lat), cos_lat = std::cos(lat);
+            double N = a / std::sqrt(1.0 - e2 * sin_lat * sin_lat);
+
+            x = (N + z) * cos_lat * std::cos(lon);
+            y = (N + z) * cos_lat * std::sin(lon);
+            z = (N * (1.0 - e2) + z) * sin_lat;
+            return true;
+        }
+
+        // Heikkinen's closed form (no iteration)
+        inline bool geocentric_to_geodetic(double& x, double& y, double& z)
+        {
+            double p2 = x * x + y * y;
+            double p = std::sqrt(p2);
+
+            // the closed form falls apart near the center of the earth
+            if (!(p + std::abs(z) > 1.0e5) || !std::isfinite(p2 + z))
+                return false;
+
+            double z2 = z * z;
+            double F = 54.0 * b * b * z2;
+            double G = p2 + (1.0 - e2) * z2 - e2 * (a * a - b * b);
+            double c = e2 * e2 * F * p2 / (G * G * G);
+            double s = std::cbrt(1.0 + c + std::sqrt(c * c + 2.0 * c));
+            double k = s + 1.0 + 1.0 / s;
+            double P = F / (3.0 * k * k * G * G);
+            double Q = std::sqrt(1.0 + 2.0 * e2 * e2 * P);
+            double r0 = -(P * e2 * p) / (1.0 + Q) + std::sqrt(std::max(0.0,
+                0.5 * a * a * (1.0 + 1.0 / Q) - P * (1.0 - e2) * z2 / (Q * (1.0 + Q)) - 0.5 * P * p2));
+            double t = p - e2 * r0;
+            double U = std::sqrt(t * t + z2);
+            double V = std::sqrt(t * t + (1.0 - e2) * z2);
+            double z0 = b * b * z / (a * V);
+            double h = U * (1.0 - b * b / (a * V));
+            double lat = std::atan2(z + ep2 * z0, p);
+
+            if (!std::isfinite(lat) || !std::isfinite(h))
+                return false;
+
+            x = std::atan2(y, x) * to_deg;
+            y = lat * to_deg;
+            z = h;
+            return true;
+        }
+
+        inline bool geodetic_to_mercator(double& x, double& y, double& /*z*/)
+        {
+            // PROJ wraps longitudes and rejects the poles; let it.
+            if (!(std::abs(x) <= 180.0) || !(std::abs(y) < 90.0))
+                return false;
+
+            x = R * x * to_rad;
+            y = R * std::asinh(std::tan(y * to_rad));
+            return true;
+        }
+
+        inline bool mercator_to_geodetic(double& x, double& y, double& /*z*/)
+        {
+            if (!(std::abs(x) <= R * 180.0 * to_rad) || !std::isfinite(y))
+                return false;
+
+            x = (x / R) * to_deg;
+            y = std::atan(std::sinh(y / R)) * to_deg;
+            return true;
+        }
+
+        inline bool transform(std::uint8_t path, double& x, double& y, double& z)
+        {
+            switch (path)
+            {
+            case GEODETIC_TO_GEOCENTRIC: return geodetic_to_geocentric(x, y, z);
+            case GEOCENTRIC_TO_GEODETIC: return geocentric_to_geodetic(x, y, z);
+            case GEODETIC_TO_MERCATOR: return geodetic_to_mercator(x, y, z);
+            case MERCATOR_TO_GEODETIC: return mercator_to_geodetic(x, y, z);
+            default: return false;
+            }
+        }
+
+        //! The built-in path between two SRS's, if there is one
+        inline std::uint8_t find(const SRS& from, const SRS& to)
+        {
+            if (from == SRS::WGS84)
+            {
+                if (to == SRS::ECEF) return GEODETIC_TO_GEOCENTRIC;
+                if (to == SRS::SPHERICAL_MERCATOR) return GEODETIC_TO_MERCATOR;
+            }
+            else if (to == SRS::WGS84)
+            {
+                if (from == SRS::ECEF) return GEOCENTRIC_TO_GEODETIC;
+                if (from == SRS::SPHERICAL_MERCATOR) return MERCATOR_TO_GEODETIC;
+            }
+            return NONE;
+        }
+    }
+
+    // transforms one point with PROJ
+    inline bool proj_transform(void* handle, PJ_DIRECTION direction, double& x, double& y, double& z)
+    {
+        if (handle)
+        {
+            proj_errno_reset((PJ*)handle);
+            PJ_COORD out = proj_trans((PJ*)handle, direction, PJ_COORD{ x, y, z });
+            int err = proj_errno((PJ*)handle);
+            if (err != 0)
+            {
+                g_last_operation_error = proj_context_errno_string(g_pj_thread_local_context, err);
+                return false;
+            }
+            x = out.xyz.x, y = out.xyz.y, z = out.xyz.z;
+            return true;
+        }
+        else
+            return false;
+    }
+
+    // transforms an array of points with PROJ
+    inline bool proj_transform(void* handle, PJ_DIRECTION direction, double* x, double* y, double* z, std::size_t stride, std::size_t count)
+    {
+        if (handle)
+        {
+            proj_errno_reset((PJ*)handle);
+
+            proj_trans_generic((PJ*)handle, direction,
+                x, stride, count,
+                y, stride, count,
+                z, stride, count,
+                nullptr, stride, count);
+
+            int err = proj_errno((PJ*)handle);
+            if (err != 0)
+            {
+                g_last_operation_error = proj_context_errno_string(g_pj_thread_local_context, err);
+                return false;
+            }
+            return true;
+        }
+        else
+            return false;
+    }
+
+    // transforms an array of points with a built-in path, handing the points
+    // it can't do over to PROJ one at a time
+    inline bool native_transform(std::uint8_t path, void* handle, PJ_DIRECTION direction,
+        double* x, double* y, double* z, std::size_t stride, std::size_t count)
+    {
+        bool ok = true;
+        double unused = 0.0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::size_t offset = i * stride;
+            double& xi = *(double*)((char*)x + offset);
+            double& yi = *(double*)((char*)y + offset);
+            double& zi = z ? *(double*)((char*)z + offset) : (unused = 0.0);
+
+            if (!kernels::transform(path, xi, yi, zi))
+                ok = proj_transform(handle, direction, xi, yi, zi) && ok;
+        }
+        return ok;
+    }
+}
+
 const std::string&
 SRSOperation::errorMessage() const
 {
     return g_last_operation_error;
 }
 
-SRSOperation::SRSOperation(const SRS& from, const SRS& to) :
+SRSOperation::SRSOperation(const SRS& from, const SRS& to, bool allowNative) :
     _from(from),
     _to(to)
 {
     _nop = (_from == _to);
     if (_from.valid() && _to.valid())
     {
-        _handle = (void*)g_srs_factory.get_or_create_operation(_from.definition(), _to.definition());
+        _handle = (void*)g_srs_factory.get_or_create_operation(_from._handle, _to._handle);
+
+        if (_handle && !_nop && allowNative)
+            _native = kernels::find(_from, _to);
     }
 }
 
 bool
 SRSOperation::forward(void* handle, double& x, double& y, double& z) const
 {
-    if (handle)
-    {
-        proj_errno_reset((PJ*)handle);
-        PJ_COORD out = proj_trans((PJ*)handle, PJ_FWD, PJ_COORD{ x, y, z });
-        int err = proj_errno((PJ*)handle);
-        if (err != 0)
-        {
-            g_last_operation_error = proj_context_errno_string(g_pj_thread_local_context, err);
-            return false;
-        }
-        x = out.xyz.x, y = out.xyz.y, z = out.xyz.z;
+    if (_native && kernels::transform(_native, x, y, z))
         return true;
-    }
-    else
-        return false;
+
+    return proj_transform(handle, PJ_FWD, x, y, z);
 }
 
 bool
 SRSOperation::forward(void* handle, double* x, double* y, double* z, std::size_t stride, std::size_t count) const
 {
-    if (handle)
-    {
-        proj_errno_reset((PJ*)handle);
+    if (_native)
+        return native_transform(_native, handle, PJ_FWD, x, y, z, stride, count);
 
-        proj_trans_generic((PJ*)handle, PJ_FWD,
-            x, stride, count,
-            y, stride, count,
-            z, stride, count,
-            nullptr, stride, count);
-
-        int err = proj_errno((PJ*)handle);
-        if (err != 0)
-        {
-            g_last_operation_error = proj_context_errno_string(g_pj_thread_local_context, err);
-            return false;
-        }
-        return true;
-    }
-    else
-        return false;
+    return proj_transform(handle, PJ_FWD, x, y, z, stride, count);
 }
 
-
 bool
 SRSOperation::inverse(void* handle, double& x, double& y, double& z) const
 {
-    if (handle)
-    {
-        proj_errno_reset((PJ*)handle);
-        PJ_COORD out = proj_trans((PJ*)handle, PJ_INV, PJ_COORD{ x, y, z });
-        int err = proj_errno((PJ*)handle);
-        if (err != 0)
-        {
-            g_last_operation_error = proj_context_errno_string(g_pj_thread_local_context, err);
-            return false;
-        }
-        x = out.xyz.x, y = out.xyz.y, z = out.xyz.z;
+    if (_native && kernels::transform(kernels::inverse_of(_native), x, y, z))
         return true;
-    }
-    else
-        return false;
+
+    return proj_transform(handle, PJ_INV, x, y, z);
 }
 
 bool
 SRSOperation::inverse(void* handle, double* x, double* y, double* z, std::size_t stride, std::size_t count) const
 {
-    if (handle)
-    {
-        proj_errno_reset((PJ*)handle);
+    if (_native)
+        return native_transform(kernels::inverse_of(_native), handle, PJ_INV, x, y, z, stride, count);
 
-        proj_trans_generic((PJ*)handle, PJ_INV,
-            x, stride, count,
-            y, stride, count,
-            z, stride, count,
-            nullptr, stride, count);
-
-        int err = proj_errno((PJ*)handle);
-        if (err != 0)
-        {
-            g_last_operation_error = proj_context_errno_string(g_pj_thread_local_context, err);
-            return false;
-        }
-        return true;
-    }
-    else
-        return false;
+    return proj_transform(handle, PJ_INV, x, y, z, stride, count);
 }
 
 Box
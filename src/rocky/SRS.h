@@ -18,6 +18,11 @@ namespace ROCKY_NAMESPACE
     /**
     * Spatial reference system.
     * An SRS is the context that makes coordinates geospatially meaningful.
+    *
+    * An SRS is a handle to its definition, which is interned in a global registry
+    * the first time it's seen; so copying an SRS copies one integer, and comparing
+    * two SRS's made from the same definition compares integers. The PROJ objects
+    * behind a definition are created lazily on each thread that uses them.
     */
     class ROCKY_EXPORT SRS
     {
@@ -66,8 +71,13 @@ namespace ROCKY_NAMESPACE
 
         //! Definition that was used to initialize this SRS
         //! @return Definition string
-        inline const std::string& definition() const {
-            return _definition;
+        const std::string& definition() const;
+
+        //! Interned handle of this SRS's definition; SRS's with the same definition
+        //! have the same handle for the life of the process.
+        //! @return Handle, or zero for an empty SRS
+        inline std::uint32_t handle() const {
+            return _handle;
         }
 
         //! Whether this is a valid SRS
@@ -218,10 +228,8 @@ namespace ROCKY_NAMESPACE
         static std::function<void(int level, const char* msg)> projMessageCallback;
 
     private:
-        //! Create an SRS from an initialization string.
-        std::string _definition;
-        mutable std::optional<bool> _valid;
-        mutable std::optional<int> _crs_type;
+        //! Handle of the interned definition string (zero = empty)
+        std::uint32_t _handle = 0u;
         friend class SRSOperation;
 
         bool _establish_valid() const;
@@ -246,7 +254,9 @@ namespace ROCKY_NAMESPACE
         //! Construct an operation to transform coordinates from one SRS to another.
         //! @param from Source SRS
         //! @param to Target SRS
-        SRSOperation(const SRS& from, const SRS& to);
+        //! @param allowNative Whether to use built-in math instead of PROJ when the
+        //!    SRS pair supports it (see native())
+        SRSOperation(const SRS& from, const SRS& to, bool allowNative = true);
 
         //! Whether this is a valid and legal operation
         //! @return True if the operation is valid, false if not
@@ -266,6 +276,15 @@ namespace ROCKY_NAMESPACE
             return _nop;
         }
 
+        //! Whether this operation transforms points with built-in math instead of PROJ.
+        //! This is the case for WGS84 to and from ECEF and spherical mercator; points
+        //! the built-in math doesn't handle (like latitudes beyond the poles) still go
+        //! through PROJ.
+        //! @return True if the operation uses built-in math
+        inline bool native() const {
+            return _native != 0u;
+        }
+
         //! Source SRS of the operation
         //! @return Source SRS
         inline const SRS& from() const {
@@ -412,6 +431,7 @@ namespace ROCKY_NAMESPACE
     private:
         void* _handle = nullptr;
         bool _nop = true;
+        std::uint8_t _native = 0u; // built-in transform, zero for none (see SRS.cpp)
         SRS _from, _to;
 
         bool forward(void* handle, double& x, double& y, double& z) const;
@@ -425,10 +445,7 @@ namespace ROCKY_NAMESPACE
 
 
     inline bool SRS::valid() const {
-        if (_valid.has_value())
-            return _valid.value();
-        else
-            return _establish_valid();
+        return _handle != 0u && _establish_valid();
     }
 
     template<typename DVEC3>
@@ -7,6 +7,7 @@
 #include "Map.h"
 #include "ElevationLayer.h"
 #include "ImageLayer.h"
+#include <algorithm>
 
 #define LC "[TerrainTileModelFactory] "
 
@@ -44,18 +45,38 @@ TerrainTileModelFactory::createTileModel(const Map* map, const TileKey& key, con
     model.revision = map->revision();
 
     // assemble all the components:
-    addColorLayers(model, map, key, io);
-
-    unsigned border = 0u;
-    addElevation(model, map, key, io);
+    if (concurrentFetch)
+    {
+        // fetch elevation alongside the color layers; addElevation only touches model.elevation
+        // and addColorLayers only touches model.colorLayers, so they can share the model.
+        std::vector<std::function<void()>> tasks = {
+            [&]() { addColorLayers(model, map, key, io); },
+            [&]() { addElevation(model, map, key, io); }
+        };
+
+        auto& jobs = io.services().jobs;
+        detail::runConcurrently(tasks, jobs, jobs.get_pool(fetchPoolName, fetchConcurrency), "fetch tile data");
+    }
+    else
+    {
+        addColorLayers(model, map, key, io);
+        addElevation(model, map, key, io);
+    }
 
     return model;
 }
 
 namespace
 {
-    // return: true if fallback occurred, false if not.
-    bool addImageLayer(const TileKey& startingKey, std::shared_ptr<ImageLayer> layer, bool fallback, TerrainTileModel& model, const IOOptions& io)
+    struct FetchedImage
+    {
+        GeoImage image;
+        TileKey key;
+        bool fellBack = false;
+    };
+
+    // Fetch the data for one image layer, falling back on ancestor keys if requested.
+    FetchedImage fetchImageLayer(const TileKey& startingKey, std::shared_ptr<ImageLayer> layer, bool fallback, const IOOptions& io)
     {
         GeoImage geoimage;
         Status status;
@@ -88,18 +109,9 @@ namespace
                 status = r.error();
         }
 
-        if (geoimage.valid())
-        {
-            auto& m = model.colorLayers.emplace_back();
-            m.layer = layer;
-            m.revision = layer->revision();
-            m.image = geoimage;
-            m.key = key;
-        }
-
         // ResourceUnavailable just means the driver could not produce data
         // for the tilekey; it is not an actual read error.
-        else if (status.failed())
+        if (!geoimage.valid() && status.failed())
         {
             if (status.error().type != Failure::ResourceUnavailable &&
                 status.error().type != Failure::OperationCanceled)
@@ -108,7 +120,22 @@ namespace
             }
         }
 
-        return fell_back;
+        return FetchedImage{ geoimage, key, fell_back };
+    }
+
+    // return: true if fallback occurred, false if not.
+    bool addImageLayer(FetchedImage& fetched, std::shared_ptr<ImageLayer> layer, TerrainTileModel& model)
+    {
+        if (fetched.image.valid())
+        {
+            auto& m = model.colorLayers.emplace_back();
+            m.layer = layer;
+            m.revision = layer->revision();
+            m.image = std::move(fetched.image);
+            m.key = fetched.key;
+        }
+
+        return fetched.fellBack;
     }
 }
 
@@ -149,16 +176,31 @@ TerrainTileModelFactory::addColorLayers(TerrainTileModel& model, const Map* map,
         {
             // if only one layer intersects we will not need to composite
             // so just get the raw data for this key if there is any.
-            addImageLayer(candidates.front().key, candidates.front().layer, no_fallback, model, io);
+            auto fetched = fetchImageLayer(candidates.front().key, candidates.front().layer, no_fallback, io);
+            addImageLayer(fetched, candidates.front().layer, model);
         }
 
         else if (candidates.size() > 1)
         {
             unsigned num_fallbacks = 0;
 
-            for (auto c : candidates)
+            // fetch all the layers (concurrently if enabled), then add them in order.
+            std::vector<FetchedImage> fetched(candidates.size());
+            std::vector<std::function<void()>> tasks;
+            for (unsigned i = 0; i < candidates.size(); ++i)
             {
-                if (addImageLayer(c.key, c.layer, yes_fallback, model, io))
+                tasks.emplace_back([&, i]() {
+                    fetched[i] = fetchImageLayer(candidates[i].key, candidates[i].layer, yes_fallback, io); });
+            }
+
+            auto& jobs = io.services().jobs;
+            detail::runConcurrently(tasks, jobs,
+                concurrentFetch ? jobs.get_pool(fetchPoolName, fetchConcurrency) : nullptr,
+                "fetch image layer");
+
+            for (unsigned i = 0; i < candidates.size(); ++i)
+            {
+                if (addImageLayer(fetched[i], candidates[i].layer, model))
                 {
                     ++num_fallbacks;
                 }
@@ -185,7 +227,7 @@ TerrainTileModelFactory::addColorLayers(TerrainTileModel& model, const Map* map,
                     opacities.emplace_back(imagelayer ? imagelayer->opacity.value() : 1.0f);
                 }
 
-                image.composite(sources, opacities);
+                image.composite(sources, opacities, &io);
 
                 TerrainTileModel::ColorLayer layer;
                 layer.key = key;
@@ -208,21 +250,199 @@ TerrainTileModelFactory::addColorLayers(TerrainTileModel& model, const Map* map,
 }
 
 
+namespace
+{
+    struct FetchedHeightfield
+    {
+        GeoImage heightfield;
+        TileKey key;
+        Revision revision = -1;
+    };
+
+    // Fetch the heightfield for one elevation layer, falling back on ancestor keys.
+    FetchedHeightfield fetchElevationLayer(const TileKey& startingKey, std::shared_ptr<ElevationLayer> layer, const IOOptions& io)
+    {
+        FetchedHeightfield fetched;
+        fetched.key = startingKey;
+        fetched.revision = layer->revision();
+        Status status;
+
+        while (fetched.key.valid() && !io.canceled())
+        {
+            auto r = layer->createTile(fetched.key, io);
+            if (r.ok())
+            {
+                fetched.heightfield = r.release();
+                break;
+            }
+            status = r.error();
+            fetched.key.makeParent();
+        }
+
+        if (!fetched.heightfield.valid() && status.failed() &&
+            status.error().type != Failure::ResourceUnavailable &&
+            status.error().type != Failure::OperationCanceled)
+        {
+            Log()->warn("Problem getting data from \"" + layer->name + "\" : " + status.error().string());
+        }
+
+        return fetched;
+    }
+
+    // One source heightfield in a blend, with its sample grid cached up front.
+    // All sources share the output tile's profile (createTile guarantees it) so the
+    // mapping from output to source pixels is affine and separable: each output
+    // column maps to the same source columns on every row, and likewise for rows.
+    struct BlendSource
+    {
+        const Image* image = nullptr;
+        bool encoded = false;
+        float minValue = 0.0f, maxValue = 0.0f;
+        std::vector<unsigned> s0, s1, t0, t1;
+        std::vector<float> smix, tmix;
+
+        inline float height(unsigned s, unsigned t) const
+        {
+            if (encoded)
+            {
+                // same decoding as Heightfield::decode, without the generic pixel read
+                float v = (float)image->data<Heightfield::EncodedDataType>()[t * image->width() + s] /
+                    (float)std::numeric_limits<Heightfield::EncodedDataType>::max();
+                return v == 1.0f ? NO_DATA_VALUE : v * (maxValue - minValue) + minValue;
+            }
+            return image->data<float>()[t * image->width() + s];
+        }
+
+        // Bilinear sample at output column c, row r; NO_DATA_VALUE if any corner
+        // is missing so the next source can fill the gap.
+        inline float sample(unsigned c, unsigned r) const
+        {
+            float UL = height(s0[c], t0[r]), UR = height(s1[c], t0[r]);
+            float LL = height(s0[c], t1[r]), LR = height(s1[c], t1[r]);
+            if (UL == NO_DATA_VALUE || UR == NO_DATA_VALUE || LL == NO_DATA_VALUE || LR == NO_DATA_VALUE)
+                return NO_DATA_VALUE;
+            float top = UL + (UR - UL) * smix[c];
+            float bot = LL + (LR - LL) * smix[c];
+            return top + (bot - top) * tmix[r];
+        }
+    };
+
+    // Compute the source pixel indices and weights for sampling "count" points
+    // edge to edge across [outMin, outMax] from a source spanning [srcMin, srcMax].
+    void cacheAxis(unsigned count, double outMin, double outMax, double srcMin, double srcMax, unsigned srcSize,
+        std::vector<unsigned>& i0, std::vector<unsigned>& i1, std::vector<float>& mix)
+    {
+        i0.resize(count), i1.resize(count), mix.resize(count);
+        double last = (double)(srcSize - 1);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            double x = outMin + (outMax - outMin) * (double)i / (double)(count - 1);
+            double p = std::clamp((x - srcMin) / (srcMax - srcMin), 0.0, 1.0) * last;
+            double f = std::min(std::floor(p), std::max(last - 1.0, 0.0));
+            i0[i] = (unsigned)f;
+            i1[i] = std::min(i0[i] + 1u, srcSize - 1u);
+            mix[i] = (float)(p - f);
+        }
+    }
+
+    // Blend heightfields in priority order (first = highest) into a new encoded
+    // heightfield covering the key extent. Each output height comes from the first
+    // source that has data there.
+    Image::Ptr blendHeightfields(const std::vector<FetchedHeightfield>& fetched, const TileKey& key, const IOOptions& io)
+    {
+        // output resolution is the best of the sources that are at full resolution:
+        unsigned cols = 0, rows = 0;
+        for (auto& f : fetched)
+        {
+            if (f.key == key)
+            {
+                cols = std::max(cols, f.heightfield.image()->width());
+                rows = std::max(rows, f.heightfield.image()->height());
+            }
+        }
+
+        if (cols < 2 || rows < 2)
+            return nullptr;
+
+        double xmin, ymin, xmax, ymax;
+        key.extent().getBounds(xmin, ymin, xmax, ymax);
+
+        std::vector<BlendSource> sources(fetched.size());
+        for (unsigned i = 0; i < fetched.size(); ++i)
+        {
+            auto image = fetched[i].heightfield.image();
+            auto& extent = fetched[i].heightfield.extent();
+            auto& source = sources[i];
+            source.image = image.get();
+            source.encoded = image->pixelFormat() == HF_ENCODED_FORMAT;
+            source.minValue = Heightfield(image).minHeight();
+            source.maxValue = Heightfield(image).maxHeight();
+            cacheAxis(cols, xmin, xmax, extent.xmin(), extent.xmax(), image->width(), source.s0, source.s1, source.smix);
+            cacheAxis(rows, ymin, ymax, extent.ymin(), extent.ymax(), image->height(), source.t0, source.t1, source.tmix);
+        }
+
+        Heightfield hf(cols, rows);
+
+        for (unsigned r = 0; r < rows; ++r)
+        {
+            for (unsigned c = 0; c < cols; ++c)
+            {
+                float height = NO_DATA_VALUE;
+                for (auto& source : sources)
+                {
+                    height = source.sample(c, r);
+                    if (height != NO_DATA_VALUE)
+                        break;
+                }
+                hf.heightAt(c, r) = height;
+            }
+
+            if (io.canceled())
+                return nullptr;
+        }
+
+        hf.computeAndSetMinMax();
+        return hf.encode().image;
+    }
+}
+
 bool
 TerrainTileModelFactory::addElevation(TerrainTileModel& model, const Map* map, const TileKey& key, const IOOptions& io) const
 {
+    struct Candidate {
+        ElevationLayer::Ptr layer;
+        TileKey key;
+    };
+
     auto layers = map->layers<ElevationLayer>([&](auto layer) {
         return layer->status().ok(); });
 
     if (layers.empty())
         return false;
 
-    auto layer = layers.front();
+    // Collect the layers with data for this key, highest priority first. Like the
+    // color layers, later layers in the map sit on top of earlier ones.
+    // bestAvailableTileKey consults each layer's data extents index, so a local
+    // DEM drops out here for tiles outside its coverage.
+    std::vector<Candidate> candidates;
+    bool mayHaveData = false;
 
-    auto bestKey = layer->bestAvailableTileKey(key);
+    for (auto layer = layers.rbegin(); layer != layers.rend(); ++layer)
+    {
+        auto bestKey = (*layer)->bestAvailableTileKey(key);
+        if (bestKey.valid())
+        {
+            candidates.emplace_back(Candidate{ *layer, bestKey });
+            mayHaveData = mayHaveData || bestKey == key;
+        }
+    }
+
+    if (!mayHaveData)
+        return false;
 
-    if (bestKey == key)
+    if (candidates.size() == 1)
     {
+        auto layer = candidates.front().layer;
         auto result = layer->createTile(key, io);
 
         if (result.ok())
@@ -244,5 +464,58 @@ TerrainTileModelFactory::addElevation(TerrainTileModel& model, const Map* map, c
         }
     }
 
+    else
+    {
+        // fetch all the layers (concurrently if enabled):
+        std::vector<FetchedHeightfield> fetched(candidates.size());
+        std::vector<std::function<void()>> tasks;
+        for (unsigned i = 0; i < candidates.size(); ++i)
+        {
+            tasks.emplace_back([&, i]() {
+                fetched[i] = fetchElevationLayer(candidates[i].key, candidates[i].layer, io); });
+        }
+
+        auto& jobs = io.services().jobs;
+        detail::runConcurrently(tasks, jobs,
+            concurrentFetch ? jobs.get_pool(fetchPoolName, fetchConcurrency) : nullptr,
+            "fetch elevation layer");
+
+        if (io.canceled())
+            return false;
+
+        // keep the ones that produced data, still in priority order:
+        fetched.erase(std::remove_if(fetched.begin(), fetched.end(),
+            [](const FetchedHeightfield& f) { return !f.heightfield.valid(); }), fetched.end());
+
+        bool anyAtFullResolution = std::any_of(fetched.begin(), fetched.end(),
+            [&](const FetchedHeightfield& f) { return f.key == key; });
+
+        // nothing new at this LOD? Leave it to the parent tile, as with a single layer.
+        if (!anyAtFullResolution)
+            return false;
+
+        if (fetched.size() == 1)
+        {
+            model.elevation.heightfield = std::move(fetched.front().heightfield);
+            model.elevation.revision = fetched.front().revision;
+            model.elevation.key = key;
+        }
+        else
+        {
+            auto image = blendHeightfields(fetched, key, io);
+            if (image)
+            {
+                // any change to a contributing layer changes the sum
+                Revision revision = 0;
+                for (auto& f : fetched)
+                    revision += f.revision;
+
+                model.elevation.heightfield = GeoImage(image, key.extent());
+                model.elevation.revision = revision;
+                model.elevation.key = key;
+            }
+        }
+    }
+
     return model.elevation.heightfield;
 }
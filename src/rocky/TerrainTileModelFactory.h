@@ -24,6 +24,18 @@ namespace ROCKY_NAMESPACE
         //! Whether to composite all color layers into one
         bool compositeColorLayers = true;
 
+        //! Whether to fetch the data for all layers (imagery and elevation) at the
+        //! same time instead of one after another. Tile latency then becomes that of
+        //! the slowest layer instead of the sum of all layers. The calling thread
+        //! takes part in the fetching, and each fetch honors the IOOptions cancelation.
+        bool concurrentFetch = false;
+
+        //! Name of the job pool used for concurrent fetching
+        std::string fetchPoolName = "rocky::layer_fetch";
+
+        //! Number of threads in the concurrent fetching pool (if it's created by this factory)
+        unsigned fetchConcurrency = 8u;
+
     public:
         TerrainTileModelFactory() = default;
 
@@ -6,6 +6,8 @@
 #include "Threading.h"
 #include <cstdlib>
 #include <cstring>
+#include <queue>
+#include <set>
 
 #ifdef _WIN32
 #   include <Windows.h>
@@ -46,3 +48,147 @@ ROCKY_NAMESPACE::detail::setThreadName(const std::string& name)
     }
 #endif
 }
+
+namespace
+{
+    // Hands out thread indices, reusing those of exited threads
+    struct ThreadIndexPool
+    {
+        std::mutex mutex;
+        std::set<unsigned> free;
+        unsigned next = 0;
+        std::uint64_t serials = 0;
+
+        static ThreadIndexPool& instance() {
+            static ThreadIndexPool pool;
+            return pool;
+        }
+    };
+
+    struct ThreadIndex
+    {
+        unsigned value;
+        std::uint64_t serial;
+
+        ThreadIndex() {
+            auto& pool = ThreadIndexPool::instance();
+            std::scoped_lock lock(pool.mutex);
+            serial = ++pool.serials;
+            if (!pool.free.empty()) {
+                value = *pool.free.begin();
+                pool.free.erase(pool.free.begin());
+            }
+            else {
+                value = pool.next++;
+            }
+        }
+
+        ~ThreadIndex() {
+            auto& pool = ThreadIndexPool::instance();
+            std::scoped_lock lock(pool.mutex);
+            pool.free.insert(value);
+        }
+    };
+
+    ThreadIndex& threadIndexHolder()
+    {
+        thread_local ThreadIndex index;
+        return index;
+    }
+}
+
+unsigned
+ROCKY_NAMESPACE::detail::threadIndex()
+{
+    return threadIndexHolder().value;
+}
+
+std::uint64_t
+ROCKY_NAMESPACE::detail::threadSerial()
+{
+    return threadIndexHolder().serial;
+}
+
+namespace
+{
+    // One thread that runs functions at their scheduled times
+    class Timer
+    {
+    public:
+        static Timer& instance() {
+            static Timer timer;
+            return timer;
+        }
+
+        void add(std::chrono::steady_clock::time_point when, std::function<void()>&& function)
+        {
+            std::scoped_lock lock(_mutex);
+            if (!_thread.joinable())
+                _thread = std::thread([this]() { run(); });
+            _queue.push(Entry{ when, _sequence++, std::move(function) });
+            _wake.notify_one();
+        }
+
+    private:
+        struct Entry
+        {
+            std::chrono::steady_clock::time_point when;
+            std::uint64_t sequence; // keeps entries due at the same time in order
+            std::function<void()> function;
+            bool operator < (const Entry& rhs) const {
+                return when != rhs.when ? when > rhs.when : sequence > rhs.sequence;
+            }
+        };
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::priority_queue<Entry> _queue;
+        std::uint64_t _sequence = 0;
+        bool _done = false;
+        std::thread _thread;
+
+        ~Timer()
+        {
+            {
+                std::scoped_lock lock(_mutex);
+                _done = true;
+                _wake.notify_one();
+            }
+            if (_thread.joinable())
+                _thread.join();
+        }
+
+        void run()
+        {
+            ROCKY_NAMESPACE::detail::setThreadName("rocky::timer");
+
+            std::unique_lock lock(_mutex);
+            while (!_done)
+            {
+                if (_queue.empty())
+                {
+                    _wake.wait(lock);
+                }
+                else if (_queue.top().when > std::chrono::steady_clock::now())
+                {
+                    _wake.wait_until(lock, _queue.top().when);
+                }
+                else
+                {
+                    auto function = std::move(const_cast<Entry&>(_queue.top()).function);
+                    _queue.pop();
+                    lock.unlock();
+                    function();
+                    function = nullptr; // release captures before taking the lock again
+                    lock.lock();
+                }
+            }
+        }
+    };
+}
+
+void
+ROCKY_NAMESPACE::detail::callAt(std::chrono::steady_clock::time_point when, std::function<void()> function)
+{
+    Timer::instance().add(when, std::move(function));
+}
@@ -8,7 +8,15 @@
 #include <rocky/weejobs.h>
 #include <vector>
 #include <list>
+#include <chrono>
+#include <cstdint>
+#include <thread>
 #include <algorithm> // for std::remove
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 namespace ROCKY_NAMESPACE
 {
@@ -22,27 +30,173 @@ namespace ROCKY_NAMESPACE
         //! Sets the name of the current thread
         extern ROCKY_EXPORT void setThreadName(const std::string& name);
 
-        /** Per-thread data store */
+        //! Small integer identifying the calling thread, unique among running threads.
+        //! The lowest free index is handed out first, and an exiting thread's index is reused.
+        extern ROCKY_EXPORT unsigned threadIndex();
+
+        //! Number identifying the calling thread that, unlike threadIndex(), is never reused.
+        extern ROCKY_EXPORT std::uint64_t threadSerial();
+
+        //! Calls a function on a shared timer thread once the given time arrives.
+        //! The function should return quickly; dispatch a job for any real work.
+        extern ROCKY_EXPORT void callAt(std::chrono::steady_clock::time_point when, std::function<void()> function);
+
+        /**
+        * Per-thread data store. A thread finds its value directly by its threadIndex(),
+        * so access is O(1) and takes no lock shared with other threads.
+        *
+        * A value is only ever seen by the thread that created it; a new thread that is
+        * handed an exited thread's index starts with a fresh value.
+        *
+        * Set idleTimeout to destroy values that their thread has not accessed for that
+        * long, e.g. to close file handles held by threads that went idle. Idle values are
+        * destroyed during other threads' calls to access(), so hold on to the Access
+        * object while using the value.
+        */
         template<class T>
-        struct ThreadLocal
+        class ThreadLocal
         {
-            T& value() {
-                std::scoped_lock lock(_mutex);
-                auto id = std::this_thread::get_id();
-                for(auto& p : _data)
-                    if (p.first == id)
-                        return p.second;
-                return _data.emplace_back(id, T()).second;
+            struct Slot
+            {
+                T* value = nullptr;
+                std::uint64_t owner = 0; // threadSerial() of the thread that created the value
+                std::atomic<bool> busy = { false };
+                std::atomic<std::int64_t> lastUsed = { 0 };
+
+                inline bool try_lock() {
+                    return !busy.exchange(true, std::memory_order_acquire);
+                }
+                inline void lock() {
+                    while (!try_lock())
+                        std::this_thread::yield();
+                }
+                inline void unlock() {
+                    busy.store(false, std::memory_order_release);
+                }
+            };
+
+        public:
+            using clock = std::chrono::steady_clock;
+
+            //! Destroy values not accessed by their thread for this long; zero = never
+            clock::duration idleTimeout = clock::duration::zero();
+
+            //! Scoped access to the calling thread's value, which stays alive while this exists
+            class Access
+            {
+            public:
+                Access(Access&& rhs) noexcept : _slot(rhs._slot) { rhs._slot = nullptr; }
+                Access(const Access&) = delete;
+                ~Access() { if (_slot) _slot->unlock(); }
+                T& operator*() const { return *_slot->value; }
+                T* operator->() const { return _slot->value; }
+            private:
+                Access(Slot* slot) : _slot(slot) { }
+                Slot* _slot;
+                friend class ThreadLocal;
+            };
+
+            ThreadLocal() {
+                for (auto& segment : _segments)
+                    segment.store(nullptr, std::memory_order_relaxed);
             }
 
+            ThreadLocal(const ThreadLocal&) = delete;
+
+            ~ThreadLocal() {
+                clear();
+                for (auto& segment : _segments)
+                    delete[] segment.load(std::memory_order_acquire);
+            }
+
+            //! The calling thread's value, created on first use
+            Access access() {
+                auto now = clock::now().time_since_epoch().count();
+                auto& slot = slotFor(threadIndex());
+                slot.lock();
+                auto serial = threadSerial();
+                if (slot.owner != serial) {
+                    // the index belonged to a thread that has exited
+                    delete slot.value;
+                    slot.value = nullptr;
+                    slot.owner = serial;
+                }
+                if (!slot.value)
+                    slot.value = new T();
+                slot.lastUsed.store(now, std::memory_order_relaxed);
+                if (idleTimeout > clock::duration::zero())
+                    reapIfDue(now);
+                return Access(&slot);
+            }
+
+            //! Destroys every thread's value, waiting for any that are being accessed.
             void clear() {
-                std::scoped_lock lock(_mutex);
-                _data.clear();
+                forEachSlot([](Slot& slot) {
+                    slot.lock();
+                    delete slot.value;
+                    slot.value = nullptr;
+                    slot.unlock();
+                    });
             }
 
         private:
-            std::mutex _mutex;
-            std::list<std::pair<std::thread::id, T>> _data;
+            static constexpr unsigned FirstSegmentSize = 32;
+            static constexpr unsigned MaxSegments = 26;
+
+            // Slots live in segments of doubling size that are never moved,
+            // so a slot can be used without locking the container.
+            std::atomic<Slot*> _segments[MaxSegments];
+            std::atomic<std::int64_t> _lastReap = { 0 };
+
+            Slot& slotFor(unsigned index) {
+                unsigned s = 0, size = FirstSegmentSize;
+                while (index >= size) {
+                    index -= size;
+                    size <<= 1;
+                    ++s;
+                }
+                auto* segment = _segments[s].load(std::memory_order_acquire);
+                if (!segment) {
+                    auto* fresh = new Slot[size];
+                    if (_segments[s].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel))
+                        segment = fresh;
+                    else
+                        delete[] fresh;
+                }
+                return segment[index];
+            }
+
+            template<class FUNC>
+            void forEachSlot(FUNC&& func) {
+                unsigned size = FirstSegmentSize;
+                for (auto& s : _segments) {
+                    auto* segment = s.load(std::memory_order_acquire);
+                    if (!segment)
+                        break;
+                    for (unsigned i = 0; i < size; ++i)
+                        func(segment[i]);
+                    size <<= 1;
+                }
+            }
+
+            // Destroys idle values, scanning at most a few times per timeout.
+            // Skips (rather than waits for) slots that are being accessed.
+            void reapIfDue(std::int64_t now) {
+                auto timeout = idleTimeout.count();
+                auto last = _lastReap.load(std::memory_order_relaxed);
+                if (now - last < timeout / 4 || !_lastReap.compare_exchange_strong(last, now, std::memory_order_relaxed))
+                    return;
+
+                forEachSlot([&](Slot& slot) {
+                    if (slot.try_lock()) {
+                        if (slot.value && now - slot.lastUsed.load(std::memory_order_relaxed) > timeout) {
+                            delete slot.value;
+                            slot.value = nullptr;
+                        }
+                        slot.unlock();
+                    }
+                    });
+            }
         };
 
         /** Primitive that only allows one thread at a time access to a keyed resourse */
@@ -132,6 +286,136 @@ namespace ROCKY_NAMESPACE
             T _key;
         };
 
+        /**
+        * Coalesces concurrent work on the same key ("single flight"). The first
+        * caller to claim a key becomes its leader and does the work; callers that
+        * claim the key while the work is in flight get the leader's future instead
+        * of repeating the work. Keys hash to independently locked shards, so work
+        * on unrelated keys never contends.
+        *
+        * Usage:
+        *   bool leader;
+        *   auto flight = flights.claim(key, leader);
+        *   if (leader)
+        *       flights.finish(key, doTheWork());
+        *   flight.wait(&cancelable);
+        */
+        template<typename K, typename V, typename HASH = std::hash<K>>
+        class SingleFlight
+        {
+        public:
+            //! Returns the shared future for the key's work. If "leader" comes back
+            //! true, the caller is the one to do the work and must call finish().
+            Future<V> claim(const K& key, bool& leader)
+            {
+                auto& shard = shardFor(key);
+                std::scoped_lock lock(shard.mutex);
+                auto [iter, inserted] = shard.flights.try_emplace(key);
+                leader = inserted;
+                return iter->second;
+            }
+
+            //! Publishes the leader's result to everyone holding the key's future,
+            //! and retires the key so the next claim starts new work.
+            void finish(const K& key, const V& value)
+            {
+                Future<V> flight;
+                {
+                    auto& shard = shardFor(key);
+                    std::scoped_lock lock(shard.mutex);
+                    auto iter = shard.flights.find(key);
+                    if (iter == shard.flights.end())
+                        return;
+                    flight = std::move(iter->second);
+                    shard.flights.erase(iter);
+                }
+                flight.resolve(value);
+            }
+
+            //! Number of keys with work in flight
+            std::size_t size() const
+            {
+                std::size_t count = 0;
+                for (auto& shard : _shards)
+                {
+                    std::scoped_lock lock(shard.mutex);
+                    count += shard.flights.size();
+                }
+                return count;
+            }
+
+        private:
+            struct Shard
+            {
+                mutable std::mutex mutex;
+                std::unordered_map<K, Future<V>, HASH> flights;
+            };
+            Shard _shards[16];
+
+            inline Shard& shardFor(const K& key)
+            {
+                auto h = HASH()(key);
+                h ^= (h >> 17);
+                return _shards[h & 15];
+            }
+        };
+
+        /**
+        * Runs a set of tasks, spreading them across a job pool, and returns when
+        * they are all done. The calling thread claims and runs tasks too, and only
+        * ever waits on tasks another thread has already started. That makes it safe
+        * to call from inside a job in any pool (no deadlock if the pool is busy) and
+        * lets the tasks reference the caller's stack.
+        *
+        * If the pool is null, the tasks run in order on the calling thread.
+        */
+        inline void runConcurrently(
+            std::vector<std::function<void()>>& tasks,
+            WEEJOBS_NAMESPACE::runtime& runtime,
+            WEEJOBS_NAMESPACE::jobpool* pool,
+            const std::string& name = {})
+        {
+            const unsigned count = (unsigned)tasks.size();
+
+            if (pool == nullptr || count < 2)
+            {
+                for (auto& task : tasks)
+                    task();
+                return;
+            }
+
+            // lives on the heap so a helper that starts late finds nothing to claim
+            struct State
+            {
+                std::atomic<unsigned> next = { 0u };
+                unsigned done = 0u;
+                std::mutex mutex;
+                std::condition_variable cv;
+            };
+            auto state = std::make_shared<State>();
+
+            auto work = [state, count, &tasks]()
+                {
+                    // only touch "tasks" after claiming an index
+                    for (unsigned i = state->next++; i < count; i = state->next++)
+                    {
+                        tasks[i]();
+                        std::scoped_lock lock(state->mutex);
+                        if (++state->done == count)
+                            state->cv.notify_all();
+                    }
+                };
+
+            unsigned helpers = std::min(count - 1, std::max(pool->concurrency(), 1u));
+            for (unsigned i = 0; i < helpers; ++i)
+                runtime.dispatch(work, WEEJOBS_NAMESPACE::context{ name, pool });
+
+            work();
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [&]() { return state->done == count; });
+        }
+
         /**
         * Scoped lock that only locks if the predicate returns true
         */
@@ -42,6 +42,12 @@ TileKey::TileKey(unsigned level_, unsigned x_, unsigned y_, const Profile& profi
     //NOP
 }
 
+TileId
+TileKey::id() const
+{
+    return valid() ? TileId(level, x, y, profile.index()) : TileId();
+}
+
 GeoExtent
 TileKey::extent() const
 {
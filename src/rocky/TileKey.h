@@ -7,6 +7,7 @@
 
 #include <rocky/Common.h>
 #include <rocky/Profile.h>
+#include <cstdint>
 #include <string>
 #include <functional> // std::hash
 #include <vector>
@@ -15,6 +16,110 @@ namespace ROCKY_NAMESPACE
 {
     class GeoPoint;
 
+    /**
+     * Compact identifier of a tile: its level, x, and y, and the index of its
+     * profile (Profile::index), packed into 64 bits. Unlike a TileKey it is trivially
+     * copyable and needs no allocation, so it makes a cheap key for tables and caches.
+     * It holds tile indices below 2^27 (i.e., level 26 in the common profiles; see
+     * maxLevel) and up to 31 profiles; beyond that you get an invalid id.
+     *
+     * Ids sort in quadtree order (the order of their quad keys): by profile, then
+     * depth-first, so each tile comes before its children and children follow
+     * their quadrant order.
+     */
+    class TileId
+    {
+    public:
+        //! Packed value; zero means invalid
+        std::uint64_t value = 0;
+
+        //! Construct an invalid id
+        TileId() = default;
+
+        //! Construct an id, which is invalid if it doesn't fit.
+        TileId(unsigned level, unsigned x, unsigned y, unsigned profileIndex) {
+            if (profileIndex > 0 && profileIndex <= maxProfileIndex && level <= maxLevelBits &&
+                x <= maxIndex && y <= maxIndex)
+            {
+                value =
+                    ((std::uint64_t)profileIndex << 59) | ((std::uint64_t)level << 54) |
+                    ((std::uint64_t)x << 27) | (std::uint64_t)y;
+            }
+        }
+
+        //! Whether this id identifies a tile
+        inline bool valid() const { return value != 0; }
+
+        inline unsigned level() const { return (unsigned)(value >> 54) & maxLevelBits; }
+        inline unsigned x() const { return (unsigned)(value >> 27) & maxIndex; }
+        inline unsigned y() const { return (unsigned)value & maxIndex; }
+        inline unsigned profileIndex() const { return (unsigned)(value >> 59); }
+
+        //! Id of the parent tile (invalid for a level zero tile)
+        inline TileId parent() const {
+            return valid() && level() > 0 ? TileId(level() - 1, x() >> 1, y() >> 1, profileIndex()) : TileId();
+        }
+
+        //! Id of a child tile, with quadrants numbered as in TileKey::createChildKey
+        inline TileId child(unsigned quadrant) const {
+            return valid() ? TileId(level() + 1, (x() << 1) | (quadrant & 1), (y() << 1) | (quadrant >> 1), profileIndex()) : TileId();
+        }
+
+        //! Morton code of the tile within its level: the bits of x and y interleaved
+        //! (x in the even bits), so the low two bits are the tile's quadrant.
+        inline std::uint64_t morton() const {
+            return spread(x()) | (spread(y()) << 1);
+        }
+
+        inline bool operator == (const TileId& rhs) const { return value == rhs.value; }
+        inline bool operator != (const TileId& rhs) const { return value != rhs.value; }
+
+        //! Quadtree order
+        inline bool operator < (const TileId& rhs) const {
+            if (profileIndex() != rhs.profileIndex())
+                return profileIndex() < rhs.profileIndex();
+            // compare the tiles' positions at the deeper of the two levels:
+            unsigned a = level(), b = rhs.level();
+            auto ma = morton(), mb = rhs.morton();
+            if (a < b) ma <<= 2 * (b - a);
+            else mb <<= 2 * (a - b);
+            return ma != mb ? ma < mb : a < b;
+        }
+
+        //! Largest tile x or y an id can hold
+        static constexpr unsigned maxIndex = (1u << 27) - 1u;
+
+        //! Largest profile index an id can hold
+        static constexpr unsigned maxProfileIndex = 31u;
+
+        //! Deepest level at which every tile of a profile has an id
+        static inline unsigned maxLevel(const Profile& profile) {
+            if (!profile.valid())
+                return 0;
+            unsigned level = 0;
+            while (level < maxLevelBits) {
+                auto next = profile.numTiles(level + 1);
+                if (next.x - 1u > maxIndex || next.y - 1u > maxIndex)
+                    break;
+                ++level;
+            }
+            return level;
+        }
+
+    private:
+        static constexpr unsigned maxLevelBits = 31u;
+
+        static inline std::uint64_t spread(std::uint64_t v) {
+            v &= maxIndex;
+            v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+            v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+            v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+            v = (v | (v << 2)) & 0x3333333333333333ull;
+            v = (v | (v << 1)) & 0x5555555555555555ull;
+            return v;
+        }
+    };
+
     /**
      * Uniquely identifies a single tile on the map, relative to a Profile.
      * Profiles have an origin of 0,0 at the top left.
@@ -82,6 +187,10 @@ namespace ROCKY_NAMESPACE
             return profile.valid();
         }
 
+        //! Compact id of this key, which is invalid if the key is invalid or
+        //! too deep to pack (see TileId).
+        TileId id() const;
+
         //! Get the quadrant relative to this key's parent.
         unsigned getQuadrant() const;
 
@@ -137,3 +246,17 @@ namespace ROCKY_NAMESPACE
         std::vector<TileKey> intersectingKeys(const Profile& profile) const;
     };
 }
+
+namespace std {
+    // std::hash specialization for TileId
+    template<> struct hash<rocky::TileId> {
+        inline size_t operator()(const rocky::TileId& value) const {
+            // mix the bits so that neighboring tiles spread across buckets
+            std::uint64_t h = value.value;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            return (size_t)h;
+        }
+    };
+}
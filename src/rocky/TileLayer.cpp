@@ -8,6 +8,7 @@
 #include "json.h"
 #include "rtree.h"
 #include "GeoImage.h"
+#include <cstring>
 
 using namespace ROCKY_NAMESPACE;
 
@@ -38,7 +39,8 @@ TileLayer::construct(std::string_view conf)
     get_to(j, "maxDataLevel", maxDataLevel);
     get_to(j, "minLevel", minLevel);
     get_to(j, "tileSize", tileSize);
-    get_to(j, "profile", _originalProfile);        
+    get_to(j, "profile", _originalProfile);
+    get_to(j, "cacheToDisk", cacheToDisk);
 }
 
 std::string
@@ -50,6 +52,7 @@ TileLayer::to_json() const
     set(j, "minLevel", minLevel);
     set(j, "tileSize", tileSize);
     set(j, "profile", _originalProfile);
+    set(j, "cacheToDisk", cacheToDisk);
     return j.dump();
 }
 
@@ -63,6 +66,11 @@ TileLayer::openImplementation(const IOOptions& io)
         {
             profile = _originalProfile;
         }
+
+        // The layer's configuration identifies its tiles from one run to the next
+        // (unlike the uid, which is assigned at runtime). std::hash would differ
+        // between builds, so use a stable hash.
+        _diskCacheKeyPrefix = std::to_string(detail::stableHash(to_json()));
     }
     return result;
 }
@@ -315,12 +323,68 @@ TileLayer::mayHaveData(const TileKey& key) const
     return (key == bestAvailableTileKey(key));
 }
 
+namespace
+{
+    constexpr const char* DISK_CACHE_TILE_TYPE = "application/x-rocky-tile";
+
+    // Serializes a georeferenced tile for the disk cache.
+    // Layout: pixelFormat, width, height, depth, xmin, ymin, xmax, ymax, SRS, pixels
+    std::string encodeTile(const GeoImage& tile)
+    {
+        auto& image = *tile.image();
+        auto& ex = tile.extent();
+        auto& srs = ex.srs().definition();
+
+        std::uint32_t header[5] = {
+            (std::uint32_t)image.pixelFormat(), image.width(), image.height(), image.depth(), (std::uint32_t)srs.size() };
+        double bounds[4] = { ex.xmin(), ex.ymin(), ex.xmax(), ex.ymax() };
+
+        std::string buf;
+        buf.reserve(sizeof(header) + sizeof(bounds) + srs.size() + image.sizeInBytes());
+        buf.append(reinterpret_cast<const char*>(header), sizeof(header));
+        buf.append(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+        buf.append(srs);
+        buf.append(image.data<char>(), image.sizeInBytes());
+        return buf;
+    }
+
+    // Deserializes a tile created by encodeTile.
+    GeoImage decodeTile(const std::string& buf)
+    {
+        std::uint32_t header[5];
+        double bounds[4];
+        if (buf.size() < sizeof(header) + sizeof(bounds))
+            return {};
+
+        std::memcpy(header, buf.data(), sizeof(header));
+        std::memcpy(bounds, buf.data() + sizeof(header), sizeof(bounds));
+
+        auto offset = sizeof(header) + sizeof(bounds);
+        if (header[0] >= Image::NUM_PIXEL_FORMATS || buf.size() < offset + header[4])
+            return {};
+
+        SRS srs(std::string_view(buf.data() + offset, header[4]));
+        offset += header[4];
+
+        auto image = Image::create((Image::PixelFormat)header[0], header[1], header[2], header[3]);
+        if (!image->valid() || buf.size() != offset + image->sizeInBytes())
+            return {};
+
+        std::memcpy(image->data<char>(), buf.data() + offset, image->sizeInBytes());
+
+        return GeoImage(image, GeoExtent(srs, bounds[0], bounds[1], bounds[2], bounds[3]));
+    }
+}
+
 Result<GeoImage>
 TileLayer::getOrCreateTile(const TileKey& key, const IOOptions& io, std::function<Result<GeoImage>()>&& create) const
 {
-    if (io.services().residentImageCache)
+    // keys too deep to pack into a TileId bypass the resident cache
+    auto id = key.id();
+
+    if (io.services().residentImageCache && id.valid())
     {
-        auto cacheKey = key.str() + '-' + std::to_string(key.profile.hash()) + '-' + std::to_string(uid()) + "-" + std::to_string(revision());
+        ResidentTileKey cacheKey{ id, uid(), revision() };
 
         auto cached = io.services().residentImageCache->get(cacheKey);
 
@@ -330,7 +394,7 @@ TileLayer::getOrCreateTile(const TileKey& key, const IOOptions& io, std::functio
             return GeoImage(cached.value().first, cached.value().second);
         }
 
-        auto r = create();
+        auto r = createOrReadFromDisk(key, io, std::move(create));
 
         if (r.ok() && r.value().image())
         {
@@ -340,7 +404,41 @@ TileLayer::getOrCreateTile(const TileKey& key, const IOOptions& io, std::functio
         return r;
     }
     else
+    {
+        return createOrReadFromDisk(key, io, std::move(create));
+    }
+}
+
+Result<GeoImage>
+TileLayer::createOrReadFromDisk(const TileKey& key, const IOOptions& io, std::function<Result<GeoImage>()>&& create) const
+{
+    auto& diskCache = io.services().diskCache;
+
+    if (!diskCache || cacheToDisk != true || _diskCacheKeyPrefix.empty())
     {
         return create();
     }
+
+    auto cacheKey = "tile:" + _diskCacheKeyPrefix + '-' + std::to_string(revision()) + '/' +
+        key.str() + '-' + std::to_string(detail::stableHash(key.profile.to_json()));
+
+    auto cached = diskCache->get(cacheKey);
+    if (cached.has_value() && cached->type == DISK_CACHE_TILE_TYPE)
+    {
+        auto tile = decodeTile(cached->data);
+        if (tile.valid())
+            return tile;
+    }
+
+    auto r = create();
+
+    if (r.ok() && r.value().valid())
+    {
+        DiskCacheEntry entry;
+        entry.type = DISK_CACHE_TILE_TYPE;
+        entry.data = encodeTile(r.value());
+        diskCache->put(cacheKey, entry);
+    }
+
+    return r;
 }
\ No newline at end of file
@@ -40,6 +40,11 @@ namespace ROCKY_NAMESPACE
         //! The extent to which the layer should be cropped.
         option<GeoExtent> crop;
 
+        //! Whether to store the tiles this layer creates in the persistent
+        //! disk cache (if one is installed in the IO services), so they
+        //! do not need to be re-created after a restart.
+        option<bool> cacheToDisk = false;
+
         //! Tiling profile and SRS or the layer.
         Profile profile;
 
@@ -116,6 +121,13 @@ namespace ROCKY_NAMESPACE
         // Post-ctor
         void construct(std::string_view);
 
+        // stable (across runs) prefix for this layer's disk cache keys
+        std::string _diskCacheKeyPrefix;
+
+        // Checks the persistent disk cache for a tile, and if not found, calls the create function.
+        Result<GeoImage> createOrReadFromDisk(const TileKey& key, const IOOptions& io,
+            std::function<Result<GeoImage>()>&& create) const;
+
         // available data extents.
         DataExtentList _dataExtents;
         DataExtent _dataExtentsUnion;
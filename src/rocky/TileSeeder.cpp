@@ -0,0 +1,279 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#include "TileSeeder.h"
+#ifdef ROCKY_HAS_MBTILES
+
+#include "ImageLayer.h"
+#include "ElevationLayer.h"
+#include "Heightfield.h"
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+
+using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::detail;
+
+#undef LC
+#define LC "[TileSeeder] "
+
+namespace
+{
+    const std::string checkpointKey = "rocky_seed_checkpoint";
+
+    // Block of tile keys at one level covering (part of) the seed extent
+    struct Range
+    {
+        unsigned level;
+        unsigned colMin, colMax, rowMin, rowMax; // inclusive
+        inline std::uint64_t count() const {
+            return (std::uint64_t)(colMax - colMin + 1) * (std::uint64_t)(rowMax - rowMin + 1);
+        }
+    };
+
+    bool addRange(const GeoExtent& extent, unsigned level, const Profile& profile, std::vector<Range>& ranges)
+    {
+        if (!extent.valid())
+            return false;
+
+        auto& pe = profile.extent();
+        auto [width, height] = profile.tileDimensions(level);
+        auto [numCols, numRows] = profile.numTiles(level);
+
+        double xmin = std::max(extent.xmin(), pe.xmin()), xmax = std::min(extent.xmax(), pe.xmax());
+        double ymin = std::max(extent.ymin(), pe.ymin()), ymax = std::min(extent.ymax(), pe.ymax());
+        if (xmin >= xmax || ymin >= ymax)
+            return false;
+
+        // rows count down from the top of the profile:
+        auto clamp = [](double v, unsigned n) { return (unsigned)std::min(std::max(v, 0.0), (double)(n - 1)); };
+        Range range;
+        range.level = level;
+        range.colMin = clamp(std::floor((xmin - pe.xmin()) / width), numCols);
+        range.colMax = clamp(std::ceil((xmax - pe.xmin()) / width) - 1.0, numCols);
+        range.rowMin = clamp(std::floor((pe.ymax() - ymax) / height), numRows);
+        range.rowMax = clamp(std::ceil((pe.ymax() - ymin) / height) - 1.0, numRows);
+        ranges.push_back(range);
+        return true;
+    }
+
+    // Elevation tiles come out of the layer encoded for the GPU;
+    // decode them back to real heights for storage.
+    std::shared_ptr<Image> decodeHeightfield(std::shared_ptr<Image> image)
+    {
+        const Heightfield encoded(image);
+        if (!encoded.encoded())
+            return image;
+
+        Heightfield hf(encoded.width(), encoded.height());
+        for (unsigned r = 0; r < hf.height(); ++r)
+            for (unsigned c = 0; c < hf.width(); ++c)
+                hf.heightAt(c, r) = encoded.heightAt(c, r);
+        return hf.image;
+    }
+}
+
+Result<TileSeeder::Progress>
+TileSeeder::run(MBTiles::Driver& output, const IOOptions& io) const
+{
+    if (!layer || !layer->isOpen())
+        return Failure(Failure::ServiceUnavailable, "Layer is not set or not open");
+
+    auto imageLayer = std::dynamic_pointer_cast<ImageLayer>(layer);
+    auto elevationLayer = std::dynamic_pointer_cast<ElevationLayer>(layer);
+    if (!imageLayer && !elevationLayer)
+        return Failure(Failure::ConfigurationError, "Layer must be an ImageLayer or an ElevationLayer");
+
+    auto outputProfile = profile.valid() ? profile : layer->profile;
+    if (!outputProfile.valid())
+        return Failure(Failure::ConfigurationError, "No output profile");
+
+    if (minLevel > maxLevel)
+        return Failure(Failure::ConfigurationError, "minLevel is greater than maxLevel");
+
+    // the key ranges to visit, level by level:
+    auto aoi = (extent.valid() ? extent : layer->extent()).transform(outputProfile.srs());
+    std::vector<GeoExtent> parts;
+    GeoExtent first, second;
+    if (aoi.crossesAntimeridian() && aoi.splitAcrossAntimeridian(first, second))
+        parts = { first, second };
+    else
+        parts = { aoi };
+
+    std::vector<Range> ranges;
+    for (unsigned level = minLevel; level <= maxLevel; ++level)
+        for (auto& part : parts)
+            addRange(part, level, outputProfile, ranges);
+
+    Progress progress;
+    for (auto& range : ranges)
+        progress.total += range.count();
+
+    // resume from the checkpoint of an earlier run with the same settings:
+    std::string signature = make_string()
+        << layer->name << ";" << aoi.toString() << ";" << minLevel << ";" << maxLevel << ";"
+        << outputProfile.to_json() << ";" << upsample;
+
+    std::uint64_t start = 0;
+    std::string checkpoint;
+    if (output.getMetaData(checkpointKey, checkpoint))
+    {
+        auto pos = checkpoint.rfind(';');
+        if (pos != std::string::npos && checkpoint.substr(0, pos) == signature)
+        {
+            start = std::min(std::strtoull(checkpoint.c_str() + pos + 1, nullptr, 10), (unsigned long long)progress.total);
+            if (start > 0)
+                Log()->info(LC "Resuming {} at tile {} of {}", layer->name, start, progress.total);
+        }
+    }
+    progress.done = start;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    unsigned inFlight = 0;
+    std::uint64_t watermark = start;       // every key before this one is written or skipped
+    std::set<std::uint64_t> doneOutOfOrder; // written or skipped keys past the watermark
+    std::uint64_t firstFailure = UINT64_MAX; // the watermark can't pass this key in this run
+    Status writeError;
+
+    // A failed (or canceled) key stops the watermark, so the next run retries it.
+    auto finish = [&](std::uint64_t index, bool written, bool skipped)
+        {
+            std::scoped_lock lock(mutex);
+            ++progress.done;
+            if (written) ++progress.written;
+            else if (skipped) ++progress.skipped;
+            else ++progress.failed;
+
+            if (!written && !skipped)
+            {
+                firstFailure = std::min(firstFailure, index);
+                doneOutOfOrder.erase(doneOutOfOrder.upper_bound(firstFailure), doneOutOfOrder.end());
+            }
+            else if (index < firstFailure)
+            {
+                doneOutOfOrder.insert(index);
+            }
+
+            while (!doneOutOfOrder.empty() && *doneOutOfOrder.begin() == watermark)
+            {
+                doneOutOfOrder.erase(doneOutOfOrder.begin());
+                ++watermark;
+            }
+        };
+
+    auto saveCheckpoint = [&]()
+        {
+            std::uint64_t mark;
+            {
+                std::scoped_lock lock(mutex);
+                mark = watermark;
+            }
+
+            // everything before the watermark was handed to the writer, so flush it first:
+            auto r = output.flush();
+            if (r.failed())
+            {
+                writeError = r.error();
+                return;
+            }
+
+            output.putMetaData(checkpointKey, signature + ";" + std::to_string(mark));
+
+            if (onProgress)
+            {
+                std::scoped_lock lock(mutex);
+                onProgress(progress);
+            }
+        };
+
+    auto& jobs = io.services().jobs;
+    unsigned maxInFlight = std::max(concurrency, 1u);
+    unsigned interval = std::max(checkpointInterval, 1u);
+    jobs::context context{ "seed", jobs.get_pool("rocky::seed", maxInFlight) };
+
+    std::uint64_t index = 0;
+    for (auto& range : ranges)
+    {
+        // skip whole ranges finished in an earlier run
+        if (index + range.count() <= start)
+        {
+            index += range.count();
+            continue;
+        }
+
+        for (unsigned row = range.rowMin; row <= range.rowMax && !io.canceled() && writeError.ok(); ++row)
+        {
+            for (unsigned col = range.colMin; col <= range.colMax && !io.canceled() && writeError.ok(); ++col, ++index)
+            {
+                if (index < start)
+                    continue;
+
+                if (index > start && index % interval == 0)
+                    saveCheckpoint();
+
+                TileKey key(range.level, col, row, outputProfile);
+
+                // rule out keys the layer can't produce real data for:
+                auto best = layer->intersects(key) ? layer->bestAvailableTileKey(key) : TileKey();
+                if (!best.valid() || (!upsample && best != key))
+                {
+                    finish(index, false, true);
+                    continue;
+                }
+
+                {
+                    std::unique_lock lock(mutex);
+                    condition.wait(lock, [&]() { return inFlight < maxInFlight; });
+                    ++inFlight;
+                }
+
+                jobs.dispatch([&, key, index]()
+                    {
+                        auto tile = imageLayer ? imageLayer->createTile(key, io) : elevationLayer->createTile(key, io);
+
+                        bool written = false;
+                        if (tile.ok() && tile.value().image())
+                        {
+                            auto image = tile.value().image();
+                            if (elevationLayer)
+                                image = decodeHeightfield(image);
+
+                            written = output.writeAsync(key, image, io).ok();
+                        }
+
+                        bool skipped = tile.failed() && tile.error().type == Failure::ResourceUnavailable && !io.canceled();
+                        finish(index, written, skipped);
+
+                        std::scoped_lock lock(mutex);
+                        --inFlight;
+                        condition.notify_all();
+                    },
+                    context);
+            }
+        }
+
+        if (io.canceled() || writeError.failed())
+            break;
+    }
+
+    // wait for the stragglers, then record where we got to.
+    {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [&]() { return inFlight == 0; });
+    }
+
+    if (writeError.ok())
+        saveCheckpoint();
+
+    if (writeError.failed())
+        return writeError.error();
+
+    return progress;
+}
+
+#endif // ROCKY_HAS_MBTILES
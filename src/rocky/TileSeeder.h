@@ -0,0 +1,90 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Common.h>
+#ifdef ROCKY_HAS_MBTILES
+
+#include <rocky/MBTiles.h>
+#include <rocky/TileLayer.h>
+#include <rocky/GeoExtent.h>
+#include <cstdint>
+#include <functional>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+    * Pre-populates an MBTiles database with the tiles an image or elevation
+    * layer creates over an area of interest, so the data is available without
+    * a network connection.
+    *
+    * Progress is checkpointed in the database's metadata. Running the seeder
+    * again with the same settings on the same database resumes after the last
+    * checkpoint, or at the first key that failed, whichever comes first.
+    *
+    * Usage:
+    *   MBTiles::Driver output;
+    *   output.open(name, options, true, profile, extents, io);
+    *
+    *   TileSeeder seeder;
+    *   seeder.layer = myImageLayer; // open
+    *   seeder.profile = profile;
+    *   seeder.extent = GeoExtent(SRS::WGS84, -80, 35, -75, 40);
+    *   seeder.maxLevel = 12;
+    *   auto r = seeder.run(output, io);
+    */
+    class ROCKY_EXPORT TileSeeder
+    {
+    public:
+        //! Counts reported during and after a run
+        struct Progress
+        {
+            //! Number of tile keys covering the extent over all levels
+            std::uint64_t total = 0;
+            //! Number of keys processed so far (including those done in an earlier run)
+            std::uint64_t done = 0;
+            //! Number of tiles written
+            std::uint64_t written = 0;
+            //! Number of keys the layer reported no data for
+            std::uint64_t skipped = 0;
+            //! Number of tiles the layer failed to create
+            std::uint64_t failed = 0;
+        };
+
+        //! Layer to seed, an ImageLayer or an ElevationLayer. Must be open.
+        std::shared_ptr<TileLayer> layer;
+
+        //! Tiling profile of the output database; defaults to the layer's profile
+        Profile profile;
+
+        //! Area to seed; defaults to the layer's extent
+        GeoExtent extent;
+
+        //! Lowest level of detail to seed
+        unsigned minLevel = 0u;
+
+        //! Highest level of detail to seed
+        unsigned maxLevel = 0u;
+
+        //! Maximum number of tiles being created at once
+        unsigned concurrency = 8u;
+
+        //! Whether to write tiles for which the layer only has lower-resolution
+        //! data. Readers fall back to the parent tile anyway, so this is off by default.
+        bool upsample = false;
+
+        //! Number of keys between checkpoints
+        unsigned checkpointInterval = 4096u;
+
+        //! Called on the calling thread after each checkpoint
+        std::function<void(const Progress&)> onProgress;
+
+        //! Seeds the output database, which must be open for writing.
+        //! Returns early (with the progress so far) if the IOOptions are canceled.
+        Result<Progress> run(MBTiles::Driver& output, const IOOptions& io) const;
+    };
+}
+
+#endif // ROCKY_HAS_MBTILES
@@ -11,9 +11,13 @@
 #include "Version.h"
 #include "json.h"
 
+#include <cmath>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <random>
+#include <thread>
+#include <unordered_map>
 
 #ifdef ROCKY_HAS_HTTPLIB
     #ifdef ROCKY_HAS_OPENSSL
@@ -198,197 +202,366 @@ namespace
         return true;
     }
 
+    // Called with the outcome of an asynchronous HTTP request
+    using HTTPCallback = std::function<void(Result<HTTPResponse>)>;
+
+    // Tells an asynchronous HTTP request that nobody wants its result anymore
+    using HTTPCanceled = std::function<bool()>;
+
+    // Adapts an HTTPCanceled to the Cancelable interface
+    struct CancelableFunction : public Cancelable
+    {
+        HTTPCanceled function;
+        CancelableFunction(HTTPCanceled f) : function(f) { }
+        bool canceled() const override { return function && function(); }
+    };
+
+    // The host (scheme://host:port) a request goes to, for per-host limits
+    std::string hostOf(const std::string& url)
+    {
+        std::string proto_host_port, path, query_text;
+        split_url(url, proto_host_port, path, query_text);
+        return proto_host_port;
+    }
+
+    // Randomized exponential backoff before a retry, so that many requests
+    // failing at once don't all retry at once too
+    std::chrono::steady_clock::duration retryDelay(unsigned attempt)
+    {
+        static thread_local std::default_random_engine engine{ std::random_device()() };
+        std::uniform_real_distribution<double> distribution;
+        auto delay = 1000ms * std::pow(2.0, (double)(attempt - 1) + distribution(engine));
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+    }
+
 #ifdef ROCKY_HAS_CURL
 
-    struct stream_object
+    /**
+    * HTTP client on top of curl's multi interface. One network thread runs every
+    * transfer, multiplexing requests to the same host over shared HTTP/2 connections
+    * (or a small pool of HTTP/1.1 keep-alive connections), so waiting on the network
+    * never occupies a job pool thread. Retries are scheduled rather than slept.
+    */
+    class CurlMulti
     {
-        void write(const char* ptr, size_t realsize)
+    public:
+        static CurlMulti& instance()
+        {
+            static CurlMulti multi;
+            return multi;
+        }
+
+        void get(const HTTPRequest& request, const IOOptions& io, HTTPCanceled canceled, HTTPCallback done)
+        {
+            auto transfer = std::make_shared<Transfer>();
+            transfer->request = request;
+            transfer->maxAttempts = std::max(1u, io.maxNetworkAttempts);
+            transfer->connectTimeout = io.networkConnectionTimeout;
+            transfer->canceled = canceled;
+            transfer->done = done;
+            transfer->limiter = io.services().hostLimiter;
+            transfer->host = hostOf(request.url);
+            transfer->t0 = std::chrono::steady_clock::now();
+            submit(transfer);
+        }
+
+    private:
+        struct Transfer
+        {
+            HTTPRequest request;
+            unsigned maxAttempts = 1;
+            std::chrono::seconds connectTimeout;
+            HTTPCanceled canceled;
+            HTTPCallback done;
+            std::shared_ptr<HostLimiter> limiter;
+            std::string host;
+            unsigned attempts = 0;
+            std::chrono::steady_clock::time_point t0, started;
+            CURL* easy = nullptr;
+            curl_slist* headers = nullptr;
+            std::string data;
+            std::vector<KeyValuePair> responseHeaders;
+            char errorBuf[CURL_ERROR_SIZE];
+        };
+
+        CURLM* _multi = nullptr;
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<Transfer>> _incoming; // protected by _mutex
+        std::unordered_map<CURL*, std::shared_ptr<Transfer>> _active; // network thread only
+        std::vector<CURL*> _idleHandles; // network thread only
+        std::atomic<bool> _done = { false };
+        std::thread _thread;
+
+        CurlMulti()
+        {
+            curl_global_init(CURL_GLOBAL_ALL);
+            _multi = curl_multi_init();
+            curl_multi_setopt(_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+            curl_multi_setopt(_multi, CURLMOPT_MAX_HOST_CONNECTIONS, 8L);
+            curl_multi_setopt(_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, 64L);
+            _thread = std::thread([this]() { run(); });
+        }
+
+        ~CurlMulti()
+        {
+            _done = true;
+            curl_multi_wakeup(_multi);
+            if (_thread.joinable())
+                _thread.join();
+
+            for (auto& [easy, transfer] : _active)
+            {
+                curl_multi_remove_handle(_multi, easy);
+                curl_easy_cleanup(easy);
+                curl_slist_free_all(transfer->headers);
+            }
+            for (auto easy : _idleHandles)
+                curl_easy_cleanup(easy);
+
+            curl_multi_cleanup(_multi);
+        }
+
+        static size_t writeFunction(void* ptr, size_t size, size_t nmemb, void* data)
         {
-            stream.write(ptr, realsize);
+            ((Transfer*)data)->data.append((const char*)ptr, size * nmemb);
+            return size * nmemb;
         }
 
-        void writeHeader(const char* ptr, size_t realsize)
+        static size_t headerFunction(void* ptr, size_t size, size_t nmemb, void* data)
         {
-            std::string header(ptr);
+            std::string header((const char*)ptr, size * nmemb);
             std::size_t colon = header.find_first_of(':');
             if (colon != std::string::npos && colon > 0 && colon < header.length() - 1)
             {
-                headers.emplace_back(KeyValuePair{
+                ((Transfer*)data)->responseHeaders.emplace_back(KeyValuePair{
                     trim(header.substr(0, colon)),
                     trim(header.substr(colon + 1)) });
             }
+            return size * nmemb;
         }
 
-        std::stringstream stream;
-        std::vector<KeyValuePair> headers;
-    };
-
-    static size_t stream_object_write_function(void* ptr, size_t size, size_t nmemb, void* data)
-    {
-        size_t realsize = size * nmemb;
-        stream_object* sp = (stream_object*)data;
-        sp->write((const char*)ptr, realsize);
-        return realsize;
-    }
-
-    static size_t stream_object_header_function(void* ptr, size_t size, size_t nmemb, void* data)
-    {
-        size_t realsize = size * nmemb;
-        stream_object* sp = (stream_object*)data;
-        sp->writeHeader((const char*)ptr, realsize);
-        return realsize;
-    }
+        // hands a transfer to the network thread once its host has room for it
+        void submit(std::shared_ptr<Transfer> transfer)
+        {
+            auto enqueue = [this, transfer]()
+                {
+                    {
+                        std::scoped_lock lock(_mutex);
+                        _incoming.emplace_back(transfer);
+                    }
+                    curl_multi_wakeup(_multi);
+                };
 
-    struct CURLHandle
-    {
-        CURL* handle = nullptr;
-        CURLHandle() {
-            handle = curl_easy_init();
-        }
-        ~CURLHandle() {
-            if (handle)
-                curl_easy_cleanup(handle);
+            if (transfer->limiter)
+                transfer->limiter->admit(transfer->host, enqueue);
+            else
+                enqueue();
         }
-    };
-
-    Result<HTTPResponse> http_get_curl(const HTTPRequest& request, const IOOptions& io)
-    {
-        // use thread-local clients for connection reuse.
-        static thread_local struct Basket {
-            CURL* handle = nullptr;
-            ~Basket() { if (handle) curl_easy_cleanup(handle); }
-        } basket;
 
-        HTTPResponse response;
+        // gives the transfer's place back to its host
+        void release(Transfer& transfer, bool failed)
+        {
+            if (transfer.limiter)
+                transfer.limiter->finish(transfer.host, std::chrono::steady_clock::now() - transfer.started, failed);
+        }
 
-        CURL* handle = basket.handle;
-        if (!handle)
+        void start(std::shared_ptr<Transfer> transfer)
         {
-            handle = curl_easy_init();
+            CURL* easy;
+            if (!_idleHandles.empty())
+            {
+                easy = _idleHandles.back();
+                _idleHandles.pop_back();
+            }
+            else
+            {
+                easy = curl_easy_init();
+            }
 
-            curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, stream_object_write_function);
-            curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, stream_object_header_function);
-            curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, (void*)1);
-            curl_easy_setopt(handle, CURLOPT_MAXREDIRS, (void*)5);
-            curl_easy_setopt(handle, CURLOPT_FILETIME, true);
-            curl_easy_setopt(handle, CURLOPT_USERAGENT, "rocky/" ROCKY_VERSION_STRING);
+            curl_easy_setopt(easy, CURLOPT_URL, transfer->request.url.c_str());
+            curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeFunction);
+            curl_easy_setopt(easy, CURLOPT_WRITEDATA, (void*)transfer.get());
+            curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, headerFunction);
+            curl_easy_setopt(easy, CURLOPT_HEADERDATA, (void*)transfer.get());
+            curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 5L);
+            curl_easy_setopt(easy, CURLOPT_FILETIME, 1L);
+            curl_easy_setopt(easy, CURLOPT_USERAGENT, "rocky/" ROCKY_VERSION_STRING);
 
             // Enable automatic CURL decompression of known types.
             // An empty string will automatically add all supported encoding types that are built into CURL.
-            // Note that you must have CURL built against zlib to support gzip or deflate encoding.
-            curl_easy_setopt(handle, CURLOPT_ENCODING, "");
+            curl_easy_setopt(easy, CURLOPT_ENCODING, "");
 
             // Disable peer certificate verification to allow us to access  https servers
             // where the peer certificate cannot be verified.
-            curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, (void*)0);
+            curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
 
-            basket.handle = handle;
-        }
+            // Negotiate HTTP/2 over TLS, and wait for a connection that can multiplex
+            // rather than opening a new one:
+            curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+            curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
 
-        //todo: authentication
-        //todo: proxy server
+            curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, (long)transfer->connectTimeout.count());
 
-        // request headers:
-        struct curl_slist* headers = nullptr;
-        for (auto& h : request.headers)
-        {
-            std::string header = h.name + ": " + h.value;
-            headers = curl_slist_append(headers, header.c_str());
-        }
-        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
-
-        stream_object so;
-        curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)&so);
-        curl_easy_setopt(handle, CURLOPT_HEADERDATA, (void*)&so);
+            transfer->errorBuf[0] = 0;
+            curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->errorBuf);
 
-        char errorBuf[CURL_ERROR_SIZE];
-        errorBuf[0] = 0;
-        curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, (void*)errorBuf);
+            for (auto& h : transfer->request.headers)
+            {
+                std::string header = h.name + ": " + h.value;
+                transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+            }
+            curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
 
-        curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, (long)io.networkConnectionTimeout.count());
+            transfer->easy = easy;
+            transfer->started = std::chrono::steady_clock::now();
+            ++transfer->attempts;
+            curl_multi_add_handle(_multi, easy);
+            _active.emplace(easy, std::move(transfer));
+        }
 
-        CURLcode result = CURLE_OK;
-        std::random_device device;
-        std::default_random_engine engine(device());
-        std::uniform_real_distribution distribution;
+        void recycle(Transfer& transfer)
+        {
+            curl_multi_remove_handle(_multi, transfer.easy);
+            curl_easy_reset(transfer.easy);
+            if (_idleHandles.size() < 64)
+                _idleHandles.push_back(transfer.easy);
+            else
+                curl_easy_cleanup(transfer.easy);
+            transfer.easy = nullptr;
 
-        auto t0 = std::chrono::steady_clock::now();
+            curl_slist_free_all(transfer.headers);
+            transfer.headers = nullptr;
+        }
 
-        auto max_attempts = std::max(1u, io.maxNetworkAttempts);
-        unsigned attempts = 0;
-        while(attempts++ < max_attempts)
+        void finish(std::shared_ptr<Transfer> transfer, CURLcode code)
         {
-            if (io.canceled())
-                return Failure_OperationCanceled;
+            long status = 0;
+            curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &status);
+            recycle(*transfer);
 
-            if (attempts > 1)
+            release(*transfer, code != CURLE_OK || status == 429 || status >= 500);
+
+            // retry connection failures and rate limiting later, without holding the host's place:
+            bool retry = code == CURLE_COULDNT_CONNECT || code == CURLE_OPERATION_TIMEDOUT || (code == CURLE_OK && status == 429);
+            if (retry && transfer->attempts < transfer->maxAttempts && !transfer->canceled())
             {
-                auto delay = 1000ms * std::pow(2, attempts + distribution(engine));
-                if (!io.canceled())
-                    std::this_thread::sleep_for(delay);
+                transfer->data.clear();
+                transfer->responseHeaders.clear();
+                callAt(std::chrono::steady_clock::now() + retryDelay(transfer->attempts), [this, transfer]()
+                    {
+                        if (transfer->canceled())
+                            transfer->done(Failure_OperationCanceled);
+                        else
+                            submit(transfer);
+                    });
+                return;
             }
 
-            result = curl_easy_perform(handle);
-
-            if (result == CURLE_COULDNT_CONNECT || result == CURLE_OPERATION_TIMEDOUT)
+            if (code != CURLE_OK)
             {
-                continue;
+                transfer->done(Failure(Failure::ServiceUnavailable,
+                    transfer->errorBuf[0] ? std::string(transfer->errorBuf) : std::string(curl_easy_strerror(code))));
+                return;
             }
 
-            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response.status);
+            if (httpDebug)
+            {
+                auto dur_ms = 1e-6 * (double)(std::chrono::steady_clock::now() - transfer->t0).count();
+                auto cti = findHeader(transfer->responseHeaders, "Content-Type");
+                auto ct = cti.empty() ? "unknown" : cti;
+                Log()->info(LC "({} {:3d}ms {:6}b {}) HTTP GET {}", status, (int)dur_ms, transfer->data.size(), ct, transfer->request.url);
+            }
 
-            if (response.status == 429) // TOO MANY REQUESTS (rate limiting)
+            if (status != 200 && status != 304) // 304 = NOT MODIFIED (conditional request)
             {
-                continue;
+                if (status == 404) // NOT FOUND (permanent)
+                    transfer->done(Failure(Failure::ResourceUnavailable, transfer->request.url));
+                else
+                    transfer->done(Failure(Failure::ResourceUnavailable, std::to_string(status)));
+                return;
             }
 
-            break;
+            HTTPResponse response;
+            response.status = (int)status;
+            response.data = std::move(transfer->data);
+            response.headers = std::move(transfer->responseHeaders);
+            transfer->done(std::move(response));
         }
 
-        //curl_easy_cleanup(handle);
-
-        if (result == CURLE_OK)
+        void run()
         {
-            response.data = so.stream.str();
-            response.headers = so.headers;
+            detail::setThreadName("rocky::http");
 
-            auto t1 = std::chrono::steady_clock::now();
-            if (httpDebug)
+            while (!_done)
             {
-                auto dur_ms = 1e-6 * (double)(t1 - t0).count();
-                auto cti = findHeader(response.headers, "Content-Type");
-                auto ct = cti.empty() ? "unknown" : cti;
-                Log()->info(LC "({} {:3d}ms {:6}b {}) HTTP GET {}", response.status, (int)dur_ms, response.data.size(), ct, request.url);
-            }
+                std::vector<std::shared_ptr<Transfer>> incoming;
+                {
+                    std::scoped_lock lock(_mutex);
+                    incoming.swap(_incoming);
+                }
 
-            if (io.canceled())
-                return Failure_OperationCanceled;
+                // start new transfers, and drop unwanted ones:
+                for (auto& transfer : incoming)
+                {
+                    if (transfer->canceled())
+                    {
+                        transfer->started = std::chrono::steady_clock::now();
+                        release(*transfer, false);
+                        transfer->done(Failure_OperationCanceled);
+                    }
+                    else
+                    {
+                        start(std::move(transfer));
+                    }
+                }
 
-            if (response.status != 200)
-            {
-                if (response.status == 404) // NOT FOUND (permanent)
+                // abort transfers nobody is waiting for anymore:
+                for (auto i = _active.begin(); i != _active.end(); )
                 {
-                    return Failure(Failure::ResourceUnavailable, request.url);
+                    if (i->second->canceled())
+                    {
+                        auto transfer = std::move(i->second);
+                        i = _active.erase(i);
+                        recycle(*transfer);
+                        release(*transfer, false);
+                        transfer->done(Failure_OperationCanceled);
+                    }
+                    else ++i;
                 }
-                else
+
+                int running = 0;
+                curl_multi_perform(_multi, &running);
+
+                int remaining = 0;
+                while (CURLMsg* message = curl_multi_info_read(_multi, &remaining))
                 {
-                    return Failure(Failure::ResourceUnavailable, std::to_string(response.status));
+                    if (message->msg == CURLMSG_DONE)
+                    {
+                        auto i = _active.find(message->easy_handle);
+                        if (i != _active.end())
+                        {
+                            auto transfer = std::move(i->second);
+                            _active.erase(i);
+                            finish(std::move(transfer), message->data.result);
+                        }
+                    }
                 }
+
+                // wake up for new transfers, or now and then to check for cancelation:
+                curl_multi_poll(_multi, nullptr, 0, 100, nullptr);
             }
         }
-        else
-        {
-            return Failure(Failure::ServiceUnavailable, errorBuf);
-        }
-
-        return response;
-    }
+    };
 #endif
 
 #ifdef ROCKY_HAS_HTTPLIB
-    Result<HTTPResponse> http_get_httplib(const HTTPRequest& request, const IOOptions& io)
+    // Makes one attempt at an HTTP request with httplib. Sets retry if the
+    // request failed in a way that a later attempt might not.
+    Result<HTTPResponse> http_get_httplib(const HTTPRequest& request, const IOOptions& io, bool& retry)
     {
+        retry = false;
+
         httplib::Headers headers;
 
         for (auto& h : request.headers)
@@ -439,13 +612,6 @@ namespace
             // connection timeout
             client.set_connection_timeout((time_t)io.networkConnectionTimeout.count());
 
-            unsigned max_attempts = std::max(1u, io.maxNetworkAttempts);
-
-            unsigned tooManyRequestsCount = 0;
-            std::random_device device;
-            std::default_random_engine engine(device());
-            std::uniform_real_distribution distribution;
-
             // in-flight cancelation detector ... I don't think this actually works.
             // I put a logger in here are it never prints :)
             auto progress = [&](size_t current, size_t total) -> bool
@@ -453,127 +619,453 @@ namespace
                     return !io.canceled();
                 };
 
-            for(;;)
-            {
-                if (io.canceled())
-                    return Failure_OperationCanceled;
-                
-                auto t0 = std::chrono::steady_clock::now();
-                auto res = client.Get(path, params, headers, progress);
-                auto t1 = std::chrono::steady_clock::now();
+            if (io.canceled())
+                return Failure_OperationCanceled;
+
+            auto t0 = std::chrono::steady_clock::now();
+            auto res = client.Get(path, params, headers, progress);
+            auto t1 = std::chrono::steady_clock::now();
 
-                if (res) // means we got a response form the server
+            if (res) // means we got a response form the server
+            {
+                if (httpDebug)
                 {
-                    if (httpDebug)
-                    {
-                        auto dur_ms = 1e-6 * (double)(t1 - t0).count();
-                        auto cti = res->headers.find("Content-Type");
-                        auto ct = cti != res->headers.end() ? cti->second : "unknown";
-                        auto cacahestatusi = res->headers.find("Cf-Cache-Status");
-                        auto cachestatus = cacahestatusi != res->headers.end() ? cacahestatusi->second : "";
-                        if (cachestatus.empty()) {
-                            auto xcachei = res->headers.find("X-Cache");
-                            cachestatus = xcachei != res->headers.end() ? xcachei->second : "";
-                        }
-                        Log()->info(LC "({} {:3d}ms {:6d}b {}) HTTP GET {} ({})", res->status, (int)dur_ms, res->body.size(), ct, request.url, cachestatus);
+                    auto dur_ms = 1e-6 * (double)(t1 - t0).count();
+                    auto cti = res->headers.find("Content-Type");
+                    auto ct = cti != res->headers.end() ? cti->second : "unknown";
+                    auto cacahestatusi = res->headers.find("Cf-Cache-Status");
+                    auto cachestatus = cacahestatusi != res->headers.end() ? cacahestatusi->second : "";
+                    if (cachestatus.empty()) {
+                        auto xcachei = res->headers.find("X-Cache");
+                        cachestatus = xcachei != res->headers.end() ? xcachei->second : "";
                     }
+                    Log()->info(LC "({} {:3d}ms {:6d}b {}) HTTP GET {} ({})", res->status, (int)dur_ms, res->body.size(), ct, request.url, cachestatus);
+                }
 
-                    if (res->status == 404) // NOT FOUND (permanent)
-                    {
-                        return Failure(Failure::ResourceUnavailable, httplib::status_message(res->status));
-                    }
-                    else if (res->status == 429) // TOO MANY REQUESTS (rate limiting)
-                    {
-                        if (--max_attempts > 0)
-                        {
-                            // random delay should avoid many requests failing at once, then waiting and retrying all at the same time and failing again
-                            auto delay = 1000ms * std::pow(2, tooManyRequestsCount++ + distribution(engine));
-                            Log()->debug(LC + std::string(httplib::status_message(res->status)) + " with " + proto_host_port + "; retrying with delay of " + std::to_string(delay.count()) + "ms... ");
-                            if (!io.canceled())
-                                std::this_thread::sleep_for(delay);
-                            continue;
-                        }
-                        else
-                        {
-                            Log()->info(LC + std::string("Retries exhausted with ") + proto_host_port + path);
-                            return Failure(Failure::ResourceUnavailable, httplib::status_message(res->status));
-                        }
-                    }
-                    else if (res->status != 200)
-                    {
-                        return Failure(Failure::GeneralError, httplib::status_message(res->status));
-                    }
+                if (res->status == 404) // NOT FOUND (permanent)
+                {
+                    return Failure(Failure::ResourceUnavailable, httplib::status_message(res->status));
+                }
+                else if (res->status == 429) // TOO MANY REQUESTS (rate limiting)
+                {
+                    retry = true;
+                    return Failure(Failure::ResourceUnavailable, httplib::status_message(res->status));
+                }
+                else if (res->status != 200 && res->status != 304) // 304 = NOT MODIFIED (conditional request)
+                {
+                    return Failure(Failure::GeneralError, httplib::status_message(res->status));
+                }
 
-                    response.status = res->status;
+                response.status = res->status;
 
-                    for (auto& h : res->headers)
-                        response.headers.emplace_back(KeyValuePair{ h.first, h.second });
+                for (auto& h : res->headers)
+                    response.headers.emplace_back(KeyValuePair{ h.first, h.second });
 
-                    response.data = std::move(res->body);
+                response.data = std::move(res->body);
+            }
 
-                    break;
+            else // unable to get a response from the server
+            {
+                if (httpDebug)
+                {
+                    Log()->info(LC "(---) HTTP GET {:.2} ({})", request.url, httplib::to_string(res.error()));
                 }
 
-                else // unable to get a response from the server
+                constexpr auto unrecoverable = [](httplib::Error error) {
+                    return
+                        //error == httplib::Error::ExceedRedirectCount ||
+                        error == httplib::Error::SSLLoadingCerts ||
+                        error == httplib::Error::SSLServerVerification ||
+                        error == httplib::Error::SSLServerHostnameVerification ||
+                        error == httplib::Error::UnsupportedMultipartBoundaryChars ||
+                        error == httplib::Error::Compression;
+                    };
+
+                // retry on a missing connection
+                retry = !unrecoverable(res.error());
+                return Failure(Failure::ServiceUnavailable, httplib::to_string(res.error()));
+            }
+        }
+        catch (std::exception& ex)
+        {
+            return Failure(Failure::GeneralError, ex.what());
+        }
+
+        return response;
+    }
+
+    /**
+    * An httplib request through all its attempts. Each attempt runs on a network pool
+    * thread once the host has room for it; between attempts the request waits on a
+    * timer, holding neither a thread nor the host's place.
+    */
+    struct HttplibRequest : public Cancelable
+    {
+        // Whether an attempt counts as an error in the host's metrics
+        static bool countsAsError(const Result<HTTPResponse>& result, bool retry)
+        {
+            return retry || (result.failed() &&
+                (result.error().type == Failure::ServiceUnavailable || result.error().type == Failure::GeneralError));
+        }
+
+        HTTPRequest request;
+        IOOptions io;
+        HTTPCanceled isCanceled;
+        HTTPCallback done;
+        std::shared_ptr<HostLimiter> limiter;
+        std::string host;
+        unsigned attempts = 0;
+        unsigned maxAttempts = 1;
+
+        bool canceled() const override {
+            return isCanceled && isCanceled();
+        }
+
+        static void submit(std::shared_ptr<HttplibRequest> state)
+        {
+            auto dispatch = [state]()
                 {
-                    if (httpDebug)
-                    {
-                        Log()->info(LC "(---) HTTP GET {:.2} ({})", request.url, httplib::to_string(res.error()));
-                    }
+                    auto& jobs = state->io.services().jobs;
+                    jobs::context context{ "http get", jobs.get_pool("rocky::http", 16) };
+                    jobs.dispatch([state]() { attempt(state); }, context);
+                };
 
-                    constexpr auto unrecoverable = [](httplib::Error error) {
-                        return
-                            //error == httplib::Error::ExceedRedirectCount ||
-                            error == httplib::Error::SSLLoadingCerts ||
-                            error == httplib::Error::SSLServerVerification ||
-                            error == httplib::Error::SSLServerHostnameVerification ||
-                            error == httplib::Error::UnsupportedMultipartBoundaryChars ||
-                            error == httplib::Error::Compression;
-                        };
-
-                    if (unrecoverable(res.error()))
-                    {
-                        return Failure(Failure::ServiceUnavailable, httplib::to_string(res.error()));
-                    }
+            if (state->limiter)
+                state->limiter->admit(state->host, dispatch);
+            else
+                dispatch();
+        }
 
-                    // retry on a missing connection
-                    if (httpDebug)
-                    {
-                        Log()->info(LC + httplib::to_string(res.error()) + " with " + proto_host_port + "; retrying..");
-                    }
+        static void attempt(std::shared_ptr<HttplibRequest> state)
+        {
+            bool retry = false;
+            auto t0 = std::chrono::steady_clock::now();
+            ++state->attempts;
 
-                    if (io.canceled())
-                        return Failure_OperationCanceled;
+            auto result = state->canceled() ?
+                Result<HTTPResponse>(Failure_OperationCanceled) :
+                http_get_httplib(state->request, state->io, retry);
 
-                    if (--max_attempts == 0)
-                    {
-                        return Failure(Failure::ServiceUnavailable, httplib::to_string(res.error()));
-                    }
+            if (state->limiter)
+            {
+                state->limiter->finish(state->host, std::chrono::steady_clock::now() - t0, countsAsError(result, retry));
+            }
 
-                    std::this_thread::sleep_for(1s);
+            if (retry && state->attempts < state->maxAttempts && !state->canceled())
+            {
+                auto delay = retryDelay(state->attempts);
+                if (httpDebug)
+                {
+                    Log()->info(LC "{} with {}; retrying in {}ms", result.error().message, state->host,
+                        (int)std::chrono::duration_cast<std::chrono::milliseconds>(delay).count());
                 }
+                callAt(std::chrono::steady_clock::now() + delay, [state]() { submit(state); });
+                return;
             }
 
+            if (retry && result.failed() && state->attempts >= state->maxAttempts)
+            {
+                Log()->info(LC "Retries exhausted with {}", state->request.url);
+            }
+
+            state->done(std::move(result));
         }
-        catch (std::exception& ex)
+    };
+#endif
+
+    // Determines when an HTTP response should be revalidated, based on its Cache-Control header.
+    // Returns false if the response must not be stored at all.
+    bool computeExpiration(const std::vector<KeyValuePair>& headers, std::chrono::seconds defaultMaxAge,
+        std::chrono::system_clock::time_point& expires)
+    {
+        auto now = std::chrono::system_clock::now();
+        expires = now + defaultMaxAge;
+
+        auto cacheControl = toLower(findHeader(headers, "Cache-Control"));
+        if (cacheControl.empty())
+            return true;
+
+        for (auto& directive : StringTokenizer().delim(",").trimTokens(true).tokenize(cacheControl))
         {
-            return Failure(Failure::GeneralError, ex.what());
+            if (directive == "no-store")
+            {
+                return false;
+            }
+            else if (directive == "no-cache")
+            {
+                expires = now;
+            }
+            else if (startsWith(directive, "max-age=") || startsWith(directive, "s-maxage="))
+            {
+                auto seconds = std::atoll(directive.substr(directive.find('=') + 1).c_str());
+                expires = now + std::chrono::seconds(std::max(0LL, (long long)seconds));
+            }
         }
-
-        return response;
+        return true;
     }
-#endif
 
-    Result<HTTPResponse> http_get(const HTTPRequest& request, const IOOptions& io)
+
+    // Issues a request without waiting for it. Calls done with the result (perhaps on the
+    // network thread, so keep it short), or with OperationCanceled once canceled() is true.
+    void http_get_async(const HTTPRequest& request, const IOOptions& io, HTTPCanceled canceled, HTTPCallback done)
     {
 #if defined(ROCKY_HAS_HTTPLIB)
-        return http_get_httplib(request, io);
+        auto state = std::make_shared<HttplibRequest>();
+        state->request = request;
+        state->io = io.with(*state); // the caller's cancelable may not outlive this call
+        state->isCanceled = canceled;
+        state->done = done;
+        state->limiter = io.services().hostLimiter;
+        state->host = hostOf(request.url);
+        state->maxAttempts = std::max(1u, io.maxNetworkAttempts);
+        HttplibRequest::submit(state);
 #elif defined(ROCKY_HAS_CURL)
-        return http_get_curl(request, io);
+        CurlMulti::instance().get(request, io, canceled, done);
 #else
-        return Failure(Failure::ServiceUnavailable, "HTTP not supported without curl or httplib");
+        done(Failure(Failure::ServiceUnavailable, "HTTP not supported without curl or httplib"));
 #endif
     }
+
+    // Issues a request and waits for the result.
+    Result<HTTPResponse> http_get(const HTTPRequest& request, const IOOptions& io)
+    {
+        // The request runs on the network machinery, which holds no thread while
+        // the host limiter queues it or between retries, so this thread just waits.
+        // The request holds the only other reference to the result, and gives up
+        // on it once we stop waiting for it.
+        Future<Result<HTTPResponse>> result;
+        auto promise = std::make_shared<Future<Result<HTTPResponse>>>(result);
+
+        http_get_async(request, io,
+            [promise]() { return promise->canceled(); },
+            [promise](Result<HTTPResponse> r) { promise->resolve(std::move(r)); });
+
+        if (!result.wait(&io))
+            return Failure_OperationCanceled;
+
+        return result.value();
+    }
+
+    // State of a read between issuing its HTTP request and handling the response
+    struct RemoteRead
+    {
+        HTTPRequest request;
+        std::optional<DiskCacheEntry> diskEntry;
+        std::chrono::steady_clock::time_point t0;
+    };
+
+    // Answers a read from the caches, the deadpool, or the local file system if possible.
+    // Otherwise returns nothing and fills in remote with the HTTP request to make.
+    std::optional<Result<URIResponse>> beginRead(const URI& uri, const std::string& url, const IOOptions& io, RemoteRead& remote)
+    {
+        auto& full = uri.full();
+
+        if (io.services().contentCache)
+        {
+            auto cached = io.services().contentCache->get(full);
+            if (cached.has_value() && cached->ok())
+            {
+                Result<URIResponse> result(cached->value());
+                result->fromCache = true;
+                return result;
+            }
+        }
+
+        Content content;
+
+        // check the dead pool, if available.
+        if (io.services().deadpool)
+        {
+            if (auto r = io.services().deadpool->get(full))
+            {
+                return Result<URIResponse>(r.value());
+            }
+        }
+
+        remote.t0 = std::chrono::steady_clock::now();
+
+        if (std::filesystem::exists(full))
+        {
+            auto contentType = inferContentTypeFromFileExtension(full);
+
+            std::ifstream in(full, std::ios::binary);
+            if (in)
+            {
+                in.seekg(0, std::ios::end);
+                const auto size = (std::size_t)in.tellg();
+                content.data = std::string(size, '\0');
+                in.seekg(0, std::ios::beg);
+                in.read(content.data.data(), (std::streamsize)size);
+                in.close();
+                content.type = contentType;
+            }
+            in.close();
+
+            auto t1 = std::chrono::steady_clock::now();
+
+            if (io.services().contentCache)
+            {
+                io.services().contentCache->put(full, Result<Content>(content));
+            }
+
+            return Result<URIResponse>(URIResponse(content, t1 - remote.t0));
+        }
+
+        if (!uri.isRemote())
+        {
+            return Result<URIResponse>(Failure(Failure::ResourceUnavailable, full));
+        }
+
+        remote.request.url = url;
+
+        for (auto& header : uri.context().headers)
+        {
+            remote.request.headers.push_back({ header.first, header.second });
+        }
+
+        // check the persistent cache; use it if fresh, otherwise make
+        // a conditional request so the server can tell us it's still good.
+        auto& diskCache = io.services().diskCache;
+        if (diskCache)
+        {
+            remote.diskEntry = diskCache->get(full);
+            if (remote.diskEntry.has_value())
+            {
+                if (remote.diskEntry->fresh())
+                {
+                    content.type = std::move(remote.diskEntry->type);
+                    content.data = std::move(remote.diskEntry->data);
+                    content.timestamp = remote.diskEntry->timestamp;
+
+                    if (io.services().contentCache)
+                    {
+                        io.services().contentCache->put(full, Result<Content>(content));
+                    }
+
+                    URIResponse response(content, std::chrono::steady_clock::now() - remote.t0);
+                    response.fromCache = true;
+                    return Result<URIResponse>(response);
+                }
+
+                if (!remote.diskEntry->etag.empty())
+                    remote.request.headers.push_back({ "If-None-Match", remote.diskEntry->etag });
+                if (!remote.diskEntry->lastModified.empty())
+                    remote.request.headers.push_back({ "If-Modified-Since", remote.diskEntry->lastModified });
+            }
+        }
+
+        return {};
+    }
+
+    // Identifies reads that will produce the same result.
+    std::string readKey(const URI& uri)
+    {
+        std::string key = uri.full();
+        for (auto& header : uri.context().headers)
+            key += "\n" + header.first + ": " + header.second;
+        return key;
+    }
+
+    // Turns the response to a remote read's HTTP request into the read's result, and caches it.
+    Result<URIResponse> finishRead(const URI& uri, const IOOptions& io, RemoteRead& remote, Result<HTTPResponse> r)
+    {
+        auto& full = uri.full();
+        auto& diskCache = io.services().diskCache;
+        auto& diskEntry = remote.diskEntry;
+        auto& request = remote.request;
+        Content content;
+
+        if (r.failed())
+        {
+            // if the error is unrecoverable, deadpool it.
+            if (io.services().deadpool && r.error().type == Failure::ResourceUnavailable)
+            {
+                io.services().deadpool->put(full, r.error());
+            }
+
+            // server unreachable? A stale copy is better than nothing.
+            if (diskEntry.has_value() && r.error().type == Failure::ServiceUnavailable)
+            {
+                content.type = std::move(diskEntry->type);
+                content.data = std::move(diskEntry->data);
+                content.timestamp = diskEntry->timestamp;
+                URIResponse response(content, std::chrono::steady_clock::now() - remote.t0);
+                response.fromCache = true;
+                return response;
+            }
+
+            return r.error();
+        }
+
+        // 304 NOT MODIFIED: our stale copy is still good, so extend its life.
+        if (r.value().status == 304 && diskEntry.has_value())
+        {
+            std::chrono::system_clock::time_point expires;
+            if (computeExpiration(r.value().headers, diskCache->defaultMaxAge, expires))
+                diskCache->refresh(full, expires);
+
+            content.type = std::move(diskEntry->type);
+            content.data = std::move(diskEntry->data);
+            content.timestamp = diskEntry->timestamp;
+
+            if (io.services().contentCache)
+            {
+                io.services().contentCache->put(full, Result<Content>(content));
+            }
+
+            URIResponse response(content, std::chrono::steady_clock::now() - remote.t0);
+            response.fromCache = true;
+            return response;
+        }
+
+        // 304 with nothing of ours to revalidate (e.g. the caller sent its own
+        // If-None-Match): there is no body, so don't cache or return one.
+        if (r.value().status == 304)
+        {
+            return Failure(Failure::GeneralError, "Server returned 304 Not Modified, but there is no cached copy of " + full);
+        }
+
+        std::string contentType = findHeader(r.value().headers, "Content-Type");
+
+        if (contentType.empty())
+        {
+            contentType = URI::inferContentType(r.value().data);
+        }
+
+        if (contentType.empty())
+        {
+            auto p = request.url.find_first_of('?');
+            auto url_path = p != std::string::npos ? request.url.substr(0, p) : request.url;
+            contentType = inferContentTypeFromFileExtension(url_path);
+        }
+
+        content.type = std::move(contentType);
+        content.data = std::move(r.value().data);
+        content.timestamp = std::chrono::system_clock::now();
+
+        if (diskCache)
+        {
+            DiskCacheEntry entry;
+            if (computeExpiration(r.value().headers, diskCache->defaultMaxAge, entry.expires))
+            {
+                entry.type = content.type;
+                entry.data = content.data;
+                entry.timestamp = content.timestamp;
+                entry.etag = findHeader(r.value().headers, "ETag");
+                entry.lastModified = findHeader(r.value().headers, "Last-Modified");
+                diskCache->put(full, entry);
+            }
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+
+        if (io.services().contentCache)
+        {
+            io.services().contentCache->put(full, Result<Content>(content));
+        }
+
+        return URIResponse(content, t1 - remote.t0);
+    }
 }
 
 //------------------------------------------------------------------------
@@ -679,114 +1171,125 @@ URI::findRotation()
 
 auto URI::read(const IOOptions& io) const -> Result<URIResponse>
 {
-    // protect against multiple threads trying to read the same URI at the same time
-    detail::ScopedGate<std::string> gate(io.services().uriGate, full());
-
-    if (io.services().contentCache)
-    {
-        auto cached = io.services().contentCache->get(full());
-        if (cached.has_value() && cached->ok())
+    auto readNow = [&]()
         {
-            Result<URIResponse> result(cached->value());
-            result->fromCache = true;
-            return result;
-        }
-    }
+            RemoteRead remote;
+            if (auto result = beginRead(*this, requestURL(), io, remote))
+                return std::move(result.value());
 
-    Content content;
+            return finishRead(*this, io, remote, http_get(remote.request, io));
+        };
 
-    // check the dead pool, if available.
-    if (io.services().deadpool)
+    auto& reads = io.services().uriReads;
+    if (!reads)
+        return readNow();
+
+    // join a read of the same URI that's already in flight, or start one.
+    auto key = readKey(*this);
+    for (;;)
     {
-        if (auto r = io.services().deadpool->get(full()))
+        bool leader;
+        auto flight = reads->claim(key, leader);
+        if (leader)
         {
-            return r.value();
+            reads->finish(key, readNow());
+            return flight.value();
         }
-    }
 
-    auto t0 = std::chrono::steady_clock::now();
+        if (!flight.wait(&io))
+            return Failure_OperationCanceled;
 
-    if (std::filesystem::exists(full()))
-    {
-        auto contentType = inferContentTypeFromFileExtension(full());
+        // the reader we joined was canceled, but we weren't; try again.
+        auto& result = flight.value();
+        if (result.failed() && result.error().type == Failure::OperationCanceled)
+            continue;
 
-        std::ifstream in(full(), std::ios::binary);
-        if (in)
-        {
-            in.seekg(0, std::ios::end);
-            const auto size = (std::size_t)in.tellg();
-            content.data = std::string(size, '\0');
-            in.seekg(0, std::ios::beg);
-            in.read(content.data.data(), (std::streamsize)size);
-            in.close();
-            content.type = contentType;
-        }
-        in.close();
+        return result;
     }
+}
 
-    else if (isRemote())
+auto URI::readAsync(const IOOptions& io) const -> Future<Result<URIResponse>>
+{
+    // everything the request needs once this call returns. The caller's IOOptions
+    // may point at a cancelable that won't live that long, so this replaces it:
+    // the read is canceled when the caller abandons the future.
+    struct AsyncRead : public Cancelable
     {
-        HTTPRequest request{ full() };
-
-        for(auto& header : _context.headers)
-        {
-            request.headers.push_back({ header.first, header.second });
+        URI uri;
+        IOOptions io;
+        RemoteRead remote;
+        std::shared_ptr<detail::SingleFlight<std::string, Result<URIResponse>>> reads;
+        std::string key;
+        Future<Result<URIResponse>> result;
+
+        bool canceled() const override {
+            // while in flight, the table of reads holds one more reference.
+            return !result.available() && result.refs() <= (reads ? 2u : 1u);
         }
 
-        // resolve a rotation:
-        static int rotator = 0;
-        if (_r0 != std::string::npos && _r1 != std::string::npos)
-        {
-            replaceInPlace(
-                request.url,
-                request.url.substr(_r0, _r1 - _r0 + 1),
-                request.url.substr(_r0 + 1 + (rotator++ % (_r1 - _r0 - 1)), 1));
+        void resolve(Result<URIResponse>&& value) {
+            if (reads)
+                reads->finish(key, value);
+            else
+                result.resolve(std::move(value));
         }
+    };
 
-        // make the actual request:
-        auto r = http_get(request, io);
+    auto state = std::make_shared<AsyncRead>();
+    state->uri = *this;
+    state->io = io.with(*state);
 
-        if (r.failed())
-        {
-            // if the error is unrecoverable, deadpool it.
-            if (io.services().deadpool && r.error().type == Failure::ResourceUnavailable)
-            {
-                io.services().deadpool->put(full(), r.error());
-            }
-
-            return r.error();
-        }
+    // join a read of the same URI that's already in flight, or start one.
+    if (io.services().uriReads)
+    {
+        bool leader;
+        state->key = readKey(*this);
+        state->result = io.services().uriReads->claim(state->key, leader);
+        if (!leader)
+            return state->result;
+        state->reads = io.services().uriReads;
+    }
 
-        std::string contentType = findHeader(r.value().headers, "Content-Type");
+    Future<Result<URIResponse>> result = state->result;
 
-        if (contentType.empty())
-        {
-            contentType = inferContentType(r.value().data);
-        }
+    if (auto early = beginRead(*this, requestURL(), state->io, state->remote))
+    {
+        state->resolve(std::move(early.value()));
+        return result;
+    }
 
-        if (contentType.empty())
+    http_get_async(state->remote.request, state->io,
+        [state]() { return state->canceled(); },
+        [state](Result<HTTPResponse> r)
         {
-            auto p = request.url.find_first_of('?');
-            auto url_path = p != std::string::npos ? request.url.substr(0, p) : request.url;
-            contentType = inferContentTypeFromFileExtension(url_path);
-        }
+            // finish up (including any cache writes) on a job thread rather than the network thread
+            auto& jobs = state->io.services().jobs;
+            jobs::context context{ "uri read", jobs.get_pool("rocky::network", 8) };
+            jobs.dispatch([state, r(std::move(r))]() mutable
+                {
+                    state->resolve(finishRead(state->uri, state->io, state->remote, std::move(r)));
+                }, context);
+        });
 
-        content.type = std::move(contentType);
-        content.data = std::move(r.value().data);
-    }
-    else
-    {
-        return Failure(Failure::ResourceUnavailable, full());
-    }
+    return result;
+}
 
-    auto t1 = std::chrono::steady_clock::now();
+std::string
+URI::requestURL() const
+{
+    std::string url = full();
 
-    if (io.services().contentCache)
+    // resolve a rotation, like "http://[abc].server.com", round-robin:
+    static std::atomic<int> rotator = { 0 };
+    if (_r0 != std::string::npos && _r1 != std::string::npos)
     {
-        io.services().contentCache->put(full(), Result<Content>(content));
+        replaceInPlace(
+            url,
+            url.substr(_r0, _r1 - _r0 + 1),
+            url.substr(_r0 + 1 + (rotator++ % (_r1 - _r0 - 1)), 1));
     }
 
-    return URIResponse(content, t1 - t0);
+    return url;
 }
 
 bool
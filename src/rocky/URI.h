@@ -126,6 +126,13 @@ namespace ROCKY_NAMESPACE
         //! Reads the URI into a data buffer
         Result<URIResponse> read(const IOOptions& io) const;
 
+        //! Reads the URI into a data buffer without waiting for it. Remote requests run
+        //! on the "rocky::http" job pool when rocky is built with httplib, or share
+        //! multiplexed connections on the "rocky::http" network thread with curl; the
+        //! response is then processed on the "rocky::network" job pool. Abandoning the
+        //! future cancels the request.
+        Future<Result<URIResponse>> readAsync(const IOOptions& io) const;
+
     public:
 
         bool operator < (const URI& rhs) const { 
@@ -158,6 +165,7 @@ namespace ROCKY_NAMESPACE
 
         void set(std::string_view location, const URI::Context& context);
         void findRotation();
+        std::string requestURL() const;
     };
 
     /**
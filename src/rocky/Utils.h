@@ -70,6 +70,17 @@ namespace ROCKY_NAMESPACE
             return (c < 0x80) ? c | ((c >= 'A' && c <= 'Z') ? 0x20 : 0x00) : std::tolower(c);
         }
 
+        //! 64-bit FNV-1a hash of a string. Unlike std::hash it's the same in every
+        //! process and on every platform, so it can name things that persist.
+        inline std::uint64_t stableHash(std::string_view s) {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            for (unsigned char c : s) {
+                h ^= c;
+                h *= 0x100000001b3ull;
+            }
+            return h;
+        }
+
         //! String to lower case
         inline std::string toLower(std::string_view in) {
             std::string out(in);
@@ -233,6 +244,46 @@ namespace ROCKY_NAMESPACE
         template<> inline
         make_string& make_string::operator << <bool>(const bool& val) { buf << (val ? "true" : "false"); return (*this); }
 
+        /**
+         * Stream buffer over a block of memory it does not own.
+         */
+        struct MemoryStreamBuffer : public std::streambuf
+        {
+            MemoryStreamBuffer(const char* data, std::size_t size) {
+                auto p = const_cast<char*>(data);
+                setg(p, p, p + size);
+            }
+
+        protected:
+            pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+                if (!(which & std::ios_base::in))
+                    return pos_type(off_type(-1));
+                off_type base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? gptr() - eback() : egptr() - eback();
+                off_type pos = base + off;
+                if (pos < 0 || pos > egptr() - eback())
+                    return pos_type(off_type(-1));
+                setg(eback(), eback() + pos, egptr());
+                return pos_type(pos);
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+                return seekoff(off_type(pos), std::ios_base::beg, which);
+            }
+        };
+
+        /**
+         * Input stream that reads directly from a block of memory it does not own,
+         * so a buffer can be handed to a stream-based decoder without copying it.
+         * The memory must outlive the stream.
+         */
+        class MemoryInputStream : private MemoryStreamBuffer, public std::istream
+        {
+        public:
+            MemoryInputStream(const char* data, std::size_t size) :
+                MemoryStreamBuffer(data, size),
+                std::istream(static_cast<MemoryStreamBuffer*>(this)) { }
+        };
+
         /**
          * Splits a string up into a vector of strings based on a set of
          * delimiters, quotes, and rules.
@@ -463,6 +463,7 @@ MapManipulator::reinitialize()
     _continuous = 0;
     _lastAction = ACTION_NULL;
     _previousMove.clear();
+    _prefetchDistance = 0.0;
     clearEvents();
 }
 
@@ -704,6 +705,9 @@ MapManipulator::setViewpoint(const Viewpoint& vp, std::chrono::duration<float> d
         _state.setVPStartTime = _previousTime;
         //_state.setVPStartTime->set( _time_s_now, Units::SECONDS );
         setViewpointFrame(_previousTime);
+
+        // a jump is not motion; don't extrapolate from it
+        _prefetchDistance = 0.0;
     }
 
 #if 0
@@ -1168,6 +1172,8 @@ MapManipulator::apply(vsg::FrameEvent& frame)
 
     bool camera_changed = updateCamera();
 
+    updatePrefetch(frame.time);
+
     _previousTime = frame.time;
 
     // if anything caused the camera's matrix to change, dirty the instance to
@@ -1182,6 +1188,72 @@ MapManipulator::apply(vsg::FrameEvent& frame)
     }
 }
 
+void
+MapManipulator::updatePrefetch(const vsg::time_point& now)
+{
+    auto mapNode = getMapNode();
+    auto camera = _camera_weakptr.ref_ptr();
+
+    if (!settings.prefetch || !_context || !mapNode || !mapNode->map || !camera || !camera->viewportState)
+    {
+        _prefetcher.clear();
+        return;
+    }
+
+    // Estimate the motion of the focal point and the rate of zoom, smoothed over a few
+    // frames. Zoom is tracked on a log scale since the manipulator zooms by a factor.
+    double dt = to_seconds(now - _previousTime);
+    if (_prefetchDistance > 0.0 && dt > 0.0 && dt < 0.5 && !isSettingViewpoint())
+    {
+        const double smoothing = 0.3;
+        auto velocity = (_state.center - _prefetchCenter) / dt;
+        auto zoomRate = std::log(_state.distance / _prefetchDistance) / dt;
+        _prefetchVelocity = _prefetchVelocity * (1.0 - smoothing) + velocity * smoothing;
+        _prefetchZoomRate = _prefetchZoomRate * (1.0 - smoothing) + zoomRate * smoothing;
+    }
+    else
+    {
+        _prefetchVelocity.set(0.0, 0.0, 0.0);
+        _prefetchZoomRate = 0.0;
+    }
+    _prefetchCenter = _state.center;
+    _prefetchDistance = _state.distance;
+
+    GeoPoint target;
+    double range = 0.0;
+
+    if (isSettingViewpoint())
+    {
+        // a transition knows exactly where it will end up
+        target = _state.setVP1->position();
+        range = _state.setVP1->range->as(Units::METERS);
+
+        // the transition's own motion says nothing about where the user goes next
+        _prefetchDistance = 0.0;
+    }
+    else
+    {
+        auto travel = _prefetchVelocity * settings.prefetchLookahead;
+        auto zoom = _prefetchZoomRate * settings.prefetchLookahead;
+
+        // only bother if the camera is moving enough to need different tiles soon
+        if (vsg::length(travel) > 0.05 * _state.distance || std::abs(zoom) > 0.05)
+        {
+            target = GeoPoint(mapNode->srs(), _state.center + travel);
+            range = _state.distance * std::exp(zoom);
+        }
+    }
+
+    // When the camera settles (or a transition ends) keep the prefetched tiles: that is
+    // exactly where the terrain is about to need them. A new motion toward somewhere
+    // else replaces them, since prefetch() releases any tiles outside the new set.
+    if (target.valid())
+    {
+        _prefetcher.prefetch(target, range, camera->viewportState->getViewport().height,
+            mapNode->map, mapNode->profile, mapNode->terrainSettings(), _context->io);
+    }
+}
+
 bool
 MapManipulator::updateCamera()
 {
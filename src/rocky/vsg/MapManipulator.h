@@ -6,6 +6,7 @@
 #pragma once
 
 #include <rocky/vsg/VSGContext.h>
+#include <rocky/vsg/terrain/TilePrefetcher.h>
 #include <rocky/GeoPoint.h>
 #include <rocky/Math.h>
 #include <rocky/Viewpoint.h>
@@ -286,6 +287,15 @@ namespace ROCKY_NAMESPACE
             //! Whtehr to zoom towards the mouse cursor when zooming
             bool zoomToMouse = true;
 
+            //! Whether to predict where the camera is headed (from its current motion,
+            //! or the destination of a setViewpoint transition) and start loading the
+            //! terrain data there before the terrain asks for it. Off by default until
+            //! measured; it competes with the terrain's own requests for IO.
+            bool prefetch = false;
+
+            //! How far ahead to predict the camera's motion when prefetching (seconds)
+            double prefetchLookahead = 0.4;
+
 
             //! Assigns behavior to the action of dragging the mouse while depressing one or
             //! more mouse buttons and modifier keys.
@@ -533,6 +543,13 @@ namespace ROCKY_NAMESPACE
         Action _continuousAction;
         float _lastKnownPerspectiveFOV = 45.0f;
 
+        // predictive loading of terrain data
+        TilePrefetcher _prefetcher;
+        vsg::dvec3 _prefetchCenter;
+        double _prefetchDistance = 0.0;
+        vsg::dvec3 _prefetchVelocity; // focal point motion, meters/s
+        double _prefetchZoomRate = 0.0; // change in log(distance) per second
+
         // rendering required b/c something changed.
         bool _dirty;
 
@@ -548,6 +565,8 @@ namespace ROCKY_NAMESPACE
 
         void updateTether(const vsg::time_point& t);
 
+        void updatePrefetch(const vsg::time_point& t);
+
         //! returns true if the camera changed.
         bool updateCamera();
 
@@ -15,6 +15,7 @@ namespace ROCKY_NAMESPACE
     {
     public:
         TileKey key;
+        TileId id; // key.id(), for cheap comparisons during record
         const NodePager* pager = nullptr;
         mutable void* token = nullptr;
         bool canLoadChild = false;
@@ -189,6 +190,7 @@ NodePager::createNode(const TileKey& key, const IOOptions& io) const
     {
         auto p = PagedNode::create();
         p->key = key;
+        p->id = key.id();
         p->bound = tileBound;
         p->priority = (float)key.level;
         p->pager = this;
@@ -303,7 +305,7 @@ PagedNode::traverse(vsg::RecordTraversal& record) const
             priority = -d;
         }
 
-        if (key == pager->debugKey)
+        if (pager->debugKey.valid() && id == pager->debugKey.id())
         {
             Log()->debug("Debugging {}", key.str());
         }
@@ -81,7 +81,8 @@ namespace
 
     // recursive search for a vsg::ReaderWriters that matches the extension
     // TODO: expand to include 'protocols' I guess
-    vsg::ref_ptr<vsg::ReaderWriter> findReaderWriter(const std::string& extension, const vsg::ReaderWriters& readerWriters)
+    vsg::ref_ptr<vsg::ReaderWriter> findReaderWriter(const std::string& extension, const vsg::ReaderWriters& readerWriters,
+        vsg::ReaderWriter::FeatureMask mask = vsg::ReaderWriter::FeatureMask::READ_ISTREAM)
     {
         vsg::ref_ptr<vsg::ReaderWriter> output;
 
@@ -91,7 +92,7 @@ namespace
             auto crw = dynamic_cast<vsg::CompositeReaderWriter*>(rw.get());
             if (crw)
             {
-                output = findReaderWriter(extension, crw->readerWriters);
+                output = findReaderWriter(extension, crw->readerWriters, mask);
             }
             else if (rw->getFeatures(features))
             {
@@ -99,7 +100,7 @@ namespace
 
                 if (j != features.extensionFeatureMap.end())
                 {
-                    if (j->second & vsg::ReaderWriter::FeatureMask::READ_ISTREAM)
+                    if (j->second & mask)
                     {
                         output = rw;
                     }
@@ -193,9 +194,9 @@ namespace
     /**
     * An update operation that maintains a priroity queue for update tasks.
     * This sits in the VSG viewer's update operations queue indefinitely
-    * and runs once per frame. It chooses the highest priority task in its
-    * queue and runs it. It will run one task per frame so that we do not
-    * risk frame drops. It will automatically discard any tasks that have
+    * and runs once per frame. It runs the tasks in its queue, highest priority
+    * first, until they have used up the time budget, so that we do not risk
+    * frame drops. It will automatically discard any tasks that have
     * been abandoned (no Future exists).
     */
     struct PriorityUpdateQueue : public vsg::Inherit<vsg::Operation, PriorityUpdateQueue>
@@ -207,52 +208,69 @@ namespace
             Task(vsg::Operation* a, std::function<float()> b) : function(a), get_priority(b) {}
             vsg::ref_ptr<vsg::Operation> function;
             std::function<float()> get_priority;
+            float priority = 0.0f;
         };
         std::vector<Task> _queue;
 
-        // runs one task per frame.
+        std::chrono::microseconds budget = std::chrono::microseconds(2000);
+        VSGContextImpl::MeteredUpdateStats stats;
+
+        // runs tasks until the budget is used up.
         void run() override
         {
-            if (!_queue.empty())
+            using clock = std::chrono::steady_clock;
+            auto start = clock::now();
+
+            VSGContextImpl::MeteredUpdateStats frame;
+
+            std::vector<Task> tasks;
             {
-                Task task;
+                std::scoped_lock lock(_mutex);
+                tasks.swap(_queue);
+            }
+
+            if (!tasks.empty())
+            {
+                // evaluate each priority once, then sort from low to high priority;
+                // tasks without a priority function go first.
+                for (auto& task : tasks)
                 {
-                    std::scoped_lock lock(_mutex);
-
-                    // sort from low to high priority
-                    std::sort(_queue.begin(), _queue.end(),
-                        [](const Task& lhs, const Task& rhs)
-                        {
-                            if (lhs.get_priority == nullptr)
-                                return false;
-                            else if (rhs.get_priority == nullptr)
-                                return true;
-                            else
-                                return lhs.get_priority() < rhs.get_priority();
-                        }
-                    );
-
-                    while (!_queue.empty())
-                    {
-                        // pop the highest priority off the back.
-                        task = _queue.back();
-                        _queue.pop_back();
-
-                        // check for cancelation - if the task is already canceled, 
-                        // discard it and fetch the next one.
-                        auto po = dynamic_cast<Cancelable*>(task.function.get());
-                        if (po == nullptr || !po->canceled())
-                            break;
-                        else
-                            task = { };
-                    }
+                    task.priority = task.get_priority ? task.get_priority() : FLT_MAX;
                 }
 
-                if (task.function)
+                std::sort(tasks.begin(), tasks.end(),
+                    [](const Task& lhs, const Task& rhs) { return lhs.priority < rhs.priority; });
+
+                // pop the highest priority tasks off the back until time runs out.
+                while (!tasks.empty() && (frame.ran == 0 || clock::now() - start < budget))
                 {
+                    auto task = std::move(tasks.back());
+                    tasks.pop_back();
+
+                    // check for cancelation - if the task is already canceled, 
+                    // discard it and fetch the next one.
+                    auto po = dynamic_cast<Cancelable*>(task.function.get());
+                    if (po && po->canceled())
+                    {
+                        ++frame.discarded;
+                        continue;
+                    }
+
                     task.function->run();
+                    ++frame.ran;
                 }
             }
+
+            frame.used = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start);
+
+            // return the leftovers to the queue, which may have gained new tasks meanwhile
+            std::scoped_lock lock(_mutex);
+            if (!tasks.empty())
+            {
+                _queue.insert(_queue.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+            }
+            frame.backlog = (unsigned)_queue.size();
+            stats = frame;
         }
     };
 
@@ -329,6 +347,12 @@ VSGContextImpl::ctor(int& argc, char** argv)
         else if (log_level == "off") Log()->set_level(spdlog::level::off);
     }
 
+    // location and size of the optional persistent disk cache
+    std::string diskCachePath = getEnvVar("DISK_CACHE").value_or("");
+    unsigned diskCacheSizeMB = std::atoi(getEnvVar("DISK_CACHE_SIZE_MB").value_or("1024").c_str());
+    args.read("--disk-cache", diskCachePath);
+    args.read("--disk-cache-size-mb", diskCacheSizeMB);
+
 #ifdef ROCKY_HAS_GDAL
     readerWriterOptions->add(GDAL_VSG_ReaderWriter::create());
 #endif
@@ -395,8 +419,7 @@ VSGContextImpl::ctor(int& argc, char** argv)
         auto result = URI(location).read(io);
         if (result.ok())
         {
-            std::istringstream buf(result.value().content.data);
-            return io.services().readImageFromStream(buf, result.value().content.type, io);
+            return io.services().readImageFromBuffer(result.value().content.data, result.value().content.type, io);
         }
         return Result<std::shared_ptr<Image>>(Failure(Failure::ResourceUnavailable, "Data is null"));
     };
@@ -469,15 +492,49 @@ VSGContextImpl::ctor(int& argc, char** argv)
             return Failure(Failure::ServiceUnavailable, "No image reader for \"" + contentType + "\"");
         };
 
+    // To write to a stream, encode a VSG copy of the image with a readerwriter
+    // that can write the mime-type (or extension).
+    io.services().writeImageToStream = [options(readerWriterOptions)](std::shared_ptr<Image> image, std::ostream& stream, std::string contentType, const rocky::IOOptions& io) -> Result<>
+        {
+            if (!image)
+                return Failure_AssertionFailure;
+
+            auto i = ext_for_mime_type.find(contentType);
+            auto extension =
+                i != ext_for_mime_type.end() ? i->second :
+                !contentType.empty() && contentType[0] != '.' ? "." + contentType :
+                contentType;
+
+            auto rw = findReaderWriter(extension, options->readerWriters, vsg::ReaderWriter::FeatureMask::WRITE_OSTREAM);
+            if (rw != nullptr)
+            {
+                auto local_options = vsg::Options::create(*options);
+                local_options->extensionHint = extension;
+                auto data = moveImageToVSG(image->clone());
+                if (rw->write(data, stream, local_options))
+                    return ResultVoidOK;
+            }
+
+            return Failure(Failure::ServiceUnavailable, "No image writer for \"" + contentType + "\"");
+        };
+
     // caches URI request results
-    io.services().contentCache = std::make_shared<ContentCache>(256);
+    io.services().contentCache = std::make_shared<ContentCache>(64u * 1024u * 1024u);
 
     // weak cache of resident image (and elevation) rasters
-    io.services().residentImageCache = std::make_shared<ResidentCache<std::string, Image, GeoExtent>>();
+    io.services().residentImageCache = std::make_shared<ResidentCache<ResidentTileKey, Image, GeoExtent>>();
 
     // remembers failed URI requests so we don't repeat them
     io.services().deadpool = std::make_shared<DealpoolService>(4096);
 
+    // persistent cache that survives a restart
+    if (!diskCachePath.empty())
+    {
+        auto diskCache = std::make_shared<DiskCache>(diskCachePath, (std::uint64_t)diskCacheSizeMB * 1024ull * 1024ull);
+        if (diskCache->valid())
+            io.services().diskCache = diskCache;
+    }
+
 
     ROCKY_SOFT_ASSERT_AND_RETURN(_viewer && _viewer->updateOperations, void());
 
@@ -546,6 +603,18 @@ VSGContextImpl::scheduleMeteredUpdate(vsg::Operation* operation, std::function<f
     }
 }
 
+VSGContextImpl::MeteredUpdateStats
+VSGContextImpl::meteredUpdateStats() const
+{
+    auto pq = dynamic_cast<PriorityUpdateQueue*>(_priorityUpdateQueue.get());
+    if (pq)
+    {
+        std::scoped_lock lock(pq->_mutex);
+        return pq->stats;
+    }
+    return {};
+}
+
 void
 VSGContextImpl::onNextUpdate(std::function<void(VSGContext)> function)
 {
@@ -601,6 +670,12 @@ VSGContextImpl::upload(const vsg::BufferInfoList& bufferInfos)
     // A way to upload GPU buffers without using the dirty()/DYNAMIC_DATA mechanism,
     // which gets slow with a large number of buffers.
     // inspired by: https://github.com/vsg-dev/VulkanSceneGraph/discussions/1572
+    if (_deferUploads)
+    {
+        _deferredBufferInfos.insert(_deferredBufferInfos.end(), bufferInfos.begin(), bufferInfos.end());
+        return;
+    }
+
     vsg::BufferInfoList validBufferInfos;
     validBufferInfos.reserve(bufferInfos.size());
 
@@ -631,6 +706,12 @@ VSGContextImpl::upload(const vsg::ImageInfoList& imageInfos)
     // A way to upload images without using the dirty()/DYNAMIC_DATA mechanism,
     // which gets slow with a large number of buffers.
     // inspired by: https://github.com/vsg-dev/VulkanSceneGraph/discussions/1572
+    if (_deferUploads)
+    {
+        _deferredImageInfos.insert(_deferredImageInfos.end(), imageInfos.begin(), imageInfos.end());
+        return;
+    }
+
     vsg::ImageInfoList validImageInfos;
     validImageInfos.reserve(imageInfos.size());
     for (auto& bi : imageInfos)
@@ -681,8 +762,28 @@ VSGContextImpl::update()
         }
     }
 
-    // One-shot update priority queue
+    // One-shot update priority queue. Collect the uploads its tasks make
+    // so they go to the transfer tasks together.
+    if (auto pq = dynamic_cast<PriorityUpdateQueue*>(_priorityUpdateQueue.get()))
+    {
+        pq->budget = meteredUpdateBudget;
+    }
+
+    _deferUploads = true;
     _priorityUpdateQueue->run();
+    _deferUploads = false;
+
+    if (!_deferredBufferInfos.empty())
+    {
+        upload(_deferredBufferInfos);
+        _deferredBufferInfos.clear();
+    }
+
+    if (!_deferredImageInfos.empty())
+    {
+        upload(_deferredImageInfos);
+        _deferredImageInfos.clear();
+    }
 
     // Merge compilation results
     if (_compileResult)
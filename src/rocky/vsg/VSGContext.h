@@ -11,6 +11,7 @@
 #include <rocky/Callbacks.h>
 #include <rocky/Rendering.h>
 #include <vsg/all.h>
+#include <chrono>
 #include <deque>
 #include <vector>
 
@@ -80,6 +81,23 @@ namespace ROCKY_NAMESPACE
         //! (this is usually platform-specific)
         std::function<float()> devicePixelRatio = []() { return 1.0f; };
 
+        //! Time each update pass may spend running operations queued with
+        //! scheduleMeteredUpdate. The highest-priority operation always runs,
+        //! even if it alone takes longer.
+        std::chrono::microseconds meteredUpdateBudget = std::chrono::microseconds(2000);
+
+        //! What the metered updates did during an update pass
+        struct MeteredUpdateStats
+        {
+            unsigned ran = 0; // operations run
+            unsigned discarded = 0; // abandoned operations discarded without running
+            unsigned backlog = 0; // operations left in the queue for the next pass
+            std::chrono::microseconds used = {}; // time spent running operations
+        };
+
+        //! Metered update statistics for the most recent update pass
+        MeteredUpdateStats meteredUpdateStats() const;
+
     public:
 
         //! Queue a function to run during the update pass.
@@ -122,8 +140,9 @@ namespace ROCKY_NAMESPACE
         void update();
 
         //! Queue an operation to run during a future update pass.
-        //! Only one queued operation will run per frame, the highest priority one
-        //! running first.
+        //! Each pass runs queued operations, highest priority first, until they have
+        //! used up the meteredUpdateBudget; the rest wait for the next pass. GPU uploads
+        //! requested by these operations are submitted together once they're done.
         void scheduleMeteredUpdate(vsg::Operation* operation, std::function<float()> getPriority = {});
 
         //! Utility to compile a new rendergraph before adding it to a scene.
@@ -152,6 +171,11 @@ namespace ROCKY_NAMESPACE
         // priority queue for one-shot priority tasks
         vsg::ref_ptr<vsg::Operation> _priorityUpdateQueue;
 
+        // uploads collected while running the priority queue
+        bool _deferUploads = false;
+        vsg::BufferInfoList _deferredBufferInfos;
+        vsg::ImageInfoList _deferredImageInfos;
+
         // one-shot update function queue
         std::mutex _functionsToRunDuringNextUpdateMutex;
         std::vector<std::function<void(VSGContext)>> _functionsToRunDuringNextUpdate;
@@ -140,9 +140,8 @@ namespace ROCKY_NAMESPACE
                 // the last frame that the view was rendered; used to detect a closed view and clean up its resources
                 FrameCountType lastFrame = std::numeric_limits<FrameCountType>::max();
 
-                // cached SRS definition for this view.
-                // We do not store an actual SRS (SIOF hazard)
-                std::string srsDef;
+                // SRS this view last rendered with; comparing handles is enough to detect a change.
+                SRS srs;
             };
             mutable ViewLocal<ViewInfo> _viewInfo;
 
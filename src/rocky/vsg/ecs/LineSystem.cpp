@@ -292,7 +292,7 @@ LineSystemNode::createOrUpdateGeometryForView(ViewIDType viewID, const LineGeome
     auto& view = _viewInfo[viewID];
 
     // If the view is removed, dispose of its nodes:
-    if (view.srsDef.empty())
+    if (view.srs.handle() == 0u)
     {
         if (geomView.root)
         {
@@ -304,7 +304,7 @@ LineSystemNode::createOrUpdateGeometryForView(ViewIDType viewID, const LineGeome
         return;
     }
 
-    SRS srs(view.srsDef);
+    SRS srs = view.srs;
     ROCKY_SOFT_ASSERT_AND_RETURN(srs, void());
 
     bool reallocate = view.dirty;
@@ -480,9 +480,9 @@ LineSystemNode::traverse(vsg::RecordTraversal& record) const
     view.lastFrame = rs.frame;
 
     // Did my SRS change? Because if it did, we need to regenerate
-    if (view.srsDef.empty() || view.srsDef != srs.definition())
+    if (view.srs.handle() == 0u || view.srs.handle() != srs.handle())
     {
-        view.srsDef = srs.definition();
+        view.srs = srs;
         view.dirty = true;
         return;
     }
@@ -615,7 +615,7 @@ LineSystemNode::update(VSGContext vsgcontext)
                 auto frame = vsgcontext->viewer()->getFrameStamp()->frameCount;
                 if (view.lastFrame < frame - 1u)
                 {
-                    view.srsDef.clear();
+                    view.srs = {};
                     view.dirty = true;
                     view.lastFrame = std::numeric_limits<FrameCountType>::max();
                 }
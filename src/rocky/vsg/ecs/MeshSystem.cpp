@@ -377,7 +377,7 @@ MeshSystemNode::createOrUpdateGeometryForView(ViewIDType viewID, const MeshGeome
     auto& view = _viewInfo[viewID];
 
     // If the view is removed, dispose of its nodes:
-    if (view.srsDef.empty())
+    if (view.srs.handle() == 0u)
     {
         if (geomView.root)
         {
@@ -389,7 +389,7 @@ MeshSystemNode::createOrUpdateGeometryForView(ViewIDType viewID, const MeshGeome
         return;
     }
 
-    SRS srs(view.srsDef);
+    SRS srs = view.srs;
     ROCKY_SOFT_ASSERT_AND_RETURN(srs, void());
 
     view.dirty = false;
@@ -607,9 +607,9 @@ MeshSystemNode::traverse(vsg::RecordTraversal& record) const
     view.lastFrame = rs.frame;
 
     // Did my SRS change? Because if it did, we need to regenerate
-    if (view.srsDef.empty() || view.srsDef != srs.definition())
+    if (view.srs.handle() == 0u || view.srs.handle() != srs.handle())
     {
-        view.srsDef = srs.definition();
+        view.srs = srs;
         view.dirty = true;
         return;
     }
@@ -735,7 +735,7 @@ MeshSystemNode::update(VSGContext vsgcontext)
                 auto frame = vsgcontext->viewer()->getFrameStamp()->frameCount;
                 if (view.lastFrame < frame - 1u)
                 {
-                    view.srsDef.clear();
+                    view.srs = {};
                     view.dirty = true;
                     view.lastFrame = std::numeric_limits<FrameCountType>::max();
                 }
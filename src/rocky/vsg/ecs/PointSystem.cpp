@@ -291,7 +291,7 @@ PointSystemNode::createOrUpdateGeometryForView(ViewIDType viewID, const PointGeo
     auto& view = _viewInfo[viewID];
 
     // If the view is removed, dispose of its nodes:
-    if (view.srsDef.empty())
+    if (view.srs.handle() == 0u)
     {
         if (geomView.root)
         {
@@ -303,7 +303,7 @@ PointSystemNode::createOrUpdateGeometryForView(ViewIDType viewID, const PointGeo
         return;
     }
 
-    SRS srs(view.srsDef);
+    SRS srs = view.srs;
     ROCKY_SOFT_ASSERT_AND_RETURN(srs, void());
 
     bool reallocate = view.dirty;
@@ -470,9 +470,9 @@ PointSystemNode::traverse(vsg::RecordTraversal& record) const
     view.lastFrame = rs.frame;
 
     // Did my SRS change? Because if it did, we need to regenerate
-    if (view.srsDef.empty() || view.srsDef != srs.definition())
+    if (view.srs.handle() == 0u || view.srs.handle() != srs.handle())
     {
-        view.srsDef = srs.definition();
+        view.srs = srs;
         view.dirty = true;
         return;
     }
@@ -604,7 +604,7 @@ PointSystemNode::update(VSGContext vsgcontext)
                 auto frame = vsgcontext->viewer()->getFrameStamp()->frameCount;
                 if (view.lastFrame < frame - 1u)
                 {
-                    view.srsDef.clear();
+                    view.srs = {};
                     view.dirty = true;
                     view.lastFrame = std::numeric_limits<FrameCountType>::max();
                 }
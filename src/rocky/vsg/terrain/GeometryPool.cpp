@@ -56,7 +56,7 @@ GeometryPool::getPooledGeometry(const TileKey& tileKey, const Settings& settings
 
     ROCKY_TODO("MeshEditor meshEditor(tileKey, tileSize, map, nullptr);");
 
-    if ( enabled )
+    if (enabled && geomKey.tile.valid())
     {
         // Protect access on a per key basis to prevent the same key from being created twice.  
         // This was causing crashes with multiple windows opening and closing.
@@ -108,8 +108,7 @@ GeometryPool::getPooledGeometry(const TileKey& tileKey, const Settings& settings
 void
 GeometryPool::createKeyForTileKey(const TileKey& key, unsigned tileSize, GeometryKey& out) const
 {
-    out.lod  = key.level;
-    out.tileY = key.profile.srs().isGeodetic()? key.y : 0;
+    out.tile = TileId(key.level, 0, key.profile.srs().isGeodetic() ? key.y : 0, key.profile.index());
     out.size = tileSize;
 }
 
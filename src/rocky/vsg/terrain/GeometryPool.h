@@ -9,7 +9,7 @@
 #include <rocky/TileKey.h>
 #include <rocky/IOTypes.h>
 #include <rocky/vsg/VSGContext.h>
-#include <map>
+#include <unordered_map>
 
 #define VERTEX_VISIBLE       1 // draw it
 #define VERTEX_BOUNDARY      2 // vertex lies on a skirt boundary
@@ -40,8 +40,9 @@ namespace ROCKY_NAMESPACE
 
     struct GeometryKey
     {
-        int lod = -1;
-        int tileY = 0;
+        //! Tiles that share geometry map to the same id: its level, and in a
+        //! geodetic profile its row (x and, otherwise, y are zero).
+        TileId tile;
         unsigned size = 0u;
 
         GeometryKey() = default;
@@ -50,27 +51,27 @@ namespace ROCKY_NAMESPACE
 
         inline bool operator < (const GeometryKey& rhs) const
         {
-            if (lod < rhs.lod) return true;
-            if (lod > rhs.lod) return false;
-            if (tileY < rhs.tileY) return true;
-            if (tileY > rhs.tileY) return false;
+            if (tile != rhs.tile) return tile.value < rhs.tile.value;
             return size < rhs.size;
         }
 
         inline bool operator == (const GeometryKey& rhs) const
         {
-            return
-                lod == rhs.lod &&
-                tileY == rhs.tileY &&
-                size == rhs.size;
+            return tile == rhs.tile && size == rhs.size;
         }
 
         inline bool operator != (const GeometryKey& rhs) const
         {
-            return
-                lod != rhs.lod ||
-                tileY != rhs.tileY ||
-                size != rhs.size;
+            return tile != rhs.tile || size != rhs.size;
+        }
+    };
+}
+
+namespace std {
+    // std::hash specialization for GeometryKey
+    template<> struct hash<rocky::GeometryKey> {
+        inline size_t operator()(const rocky::GeometryKey& value) const {
+            return hash<rocky::TileId>()(value.tile) ^ ((size_t)value.size * 0x9e3779b97f4a7c15ull);
         }
     };
 }
@@ -101,7 +102,7 @@ namespace ROCKY_NAMESPACE
 
         ~GeometryPool();
 
-        using SharedGeometries = std::map<GeometryKey, vsg::ref_ptr<SharedGeometry>>;
+        using SharedGeometries = std::unordered_map<GeometryKey, vsg::ref_ptr<SharedGeometry>>;
 
         struct Settings {
             uint32_t tileSize = 17u;
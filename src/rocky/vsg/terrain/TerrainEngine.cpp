@@ -31,8 +31,20 @@ TerrainEngine::TerrainEngine(std::shared_ptr<const Map> new_map, const Profile&
     ROCKY_SOFT_ASSERT(map, "Map is required");
     ROCKY_SOFT_ASSERT(profile.valid(), "Valid profile required");
 
+    // The pager tracks tiles by TileId, which limits how deep the terrain can go.
+    maxLevel = TileId::maxLevel(profile);
+    if (settings.maxLevel > maxLevel)
+    {
+        Log()->warn("Terrain maxLevel {} is deeper than this profile supports; the terrain will stop at level {}",
+            (unsigned)settings.maxLevel, maxLevel);
+    }
 
-    vsgcontext->io.services().jobs.get_pool(loadSchedulerName)->set_concurrency(settings.concurrency);
+    auto pool = vsgcontext->io.services().jobs.get_pool(loadSchedulerName);
+    pool->set_concurrency(settings.concurrency);
+
+    // Tile load priorities only change when the camera moves, so cache them
+    // and re-evaluate once per frame in update() instead of on every dequeue.
+    pool->set_cached_priorities(true);
 
     // geometry pooling not supported for QSC yet.
     if (new_profile.srs().isQSC())
@@ -103,5 +115,7 @@ bool TerrainEngine::update(VSGContext vc)
         changes = true;
     }
 
+    pool->reprioritize();
+
     return changes;
 }
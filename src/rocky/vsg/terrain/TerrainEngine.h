@@ -53,6 +53,9 @@ namespace ROCKY_NAMESPACE
 
         TerrainTileHost* host = nullptr;
 
+        //! Deepest level the pager can track by TileId in this profile
+        unsigned maxLevel = 0;
+
         //! name of job arena used to load data
         std::string loadSchedulerName = "rocky::terrain_loader";
 
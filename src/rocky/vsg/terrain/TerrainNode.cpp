@@ -59,6 +59,12 @@ TerrainProfileNode::createRootTiles(VSGContext vsgcontext)
     ROCKY_SOFT_ASSERT_AND_RETURN(_engine->stateFactory->status.ok(), _engine->stateFactory->status.error());
     ROCKY_HARD_ASSERT(children.empty(), "TerrainNode::createRootTiles() called with children already present");
 
+    // the pager tracks tiles by TileId; without a profile index they would all collide.
+    if (_engine->profile.index() == 0)
+    {
+        return Failure(Failure::ConfigurationError, "Terrain profile has no TileId index (too many profiles in use); cannot page tiles");
+    }
+
     // once the pipeline exists, we can start creating tiles.
     auto keys = _engine->profile.allKeysAtLOD(terrain.minLevel);
 
@@ -293,6 +299,12 @@ TerrainProfileNode::settings() const
     return terrain;
 }
 
+unsigned
+TerrainProfileNode::maxLevel() const
+{
+    return _engine ? _engine->maxLevel : 0u;
+}
+
 Result<GeoPoint>
 TerrainNode::intersect(const GeoPoint& input) const
 {
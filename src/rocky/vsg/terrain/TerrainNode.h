@@ -56,6 +56,8 @@ namespace ROCKY_NAMESPACE
 
         const TerrainSettings& settings() const override;
 
+        unsigned maxLevel() const override;
+
         TerrainTilePager& tiles() override {
             return _tiles;
         }
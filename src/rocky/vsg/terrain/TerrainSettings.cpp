@@ -25,6 +25,7 @@ TerrainSettings::from_json(std::string_view JSON)
     get_to(j, "skirtRatio", skirtRatio);
     get_to(j, "backgroundColor", backgroundColor);
     get_to(j, "concurrency", concurrency);
+    get_to(j, "concurrentLayerFetch", concurrentLayerFetch);
     get_to(j, "debugTriangles", debugTriangles);
     get_to(j, "lighting", lighting);
     get_to(j, "debugNormals", debugNormals);
@@ -48,6 +49,7 @@ TerrainSettings::to_json() const
     set(j, "skirtRatio", skirtRatio);
     set(j, "backgroundColor", backgroundColor);
     set(j, "concurrency", concurrency);
+    set(j, "concurrentLayerFetch", concurrentLayerFetch);
     set(j, "debugTriangles", debugTriangles);
     set(j, "lighting", lighting);
     set(j, "debugNormals", debugNormals);
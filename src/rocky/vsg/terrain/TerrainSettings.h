@@ -38,6 +38,8 @@ namespace ROCKY_NAMESPACE
         option<float> pixelError = 128.0f;
 
         //! The maximum level of detail to which the terrain should subdivide.
+        //! The terrain never goes deeper than TileId::maxLevel of its profile
+        //! (26 in global-geodetic, 27 in spherical-mercator).
         option<unsigned> maxLevel = 23;
 
         //! The level of detail at which the terrain should begin.
@@ -57,6 +59,10 @@ namespace ROCKY_NAMESPACE
         //! Number of threads dedicated to loading terrain data
         option<unsigned> concurrency = 6;
 
+        //! Whether to fetch the data for all of a tile's layers at the same time
+        //! instead of one after another (helps with multiple remote layers)
+        option<bool> concurrentLayerFetch = false;
+
         //! Whether to outline each triangle when rendering the terrain
         option<bool> debugTriangles = false;
 
@@ -24,6 +24,9 @@ namespace ROCKY_NAMESPACE
         //! Access terrain settings.
         virtual const TerrainSettings& settings() const = 0;
 
+        //! Deepest level the host can page, whatever the settings ask for.
+        virtual unsigned maxLevel() const = 0;
+
         virtual TerrainTilePager& tiles() = 0;
     };
 }
@@ -79,7 +79,9 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
         auto state = rv.getState();
 
         // should we subdivide?
-        bool subdivisionPossible = key.level < host->settings().maxLevel;
+        // (the pager tracks tiles by TileId, so it can't go deeper than that holds)
+        bool subdivisionPossible =
+            key.level < host->settings().maxLevel && key.level < host->maxLevel();
         bool subtilesInRange = false;
         bool traversePayload = true;
 
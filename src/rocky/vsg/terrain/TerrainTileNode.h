@@ -37,6 +37,7 @@ namespace ROCKY_NAMESPACE
         mutable std::atomic<uint64_t> lastTraversalFrame = { 0 };
         mutable std::atomic<vsg::time_point> lastTraversalTime;
         mutable std::atomic<float> lastTraversalRange = { FLT_MAX };
+        mutable std::atomic<uint64_t> lastPingFrame = { UINT64_MAX };
 
         //! Update this node (placeholder).
         //! @return true if any changes occur.
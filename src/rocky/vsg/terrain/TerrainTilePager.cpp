@@ -11,6 +11,7 @@
 #include "SurfaceNode.h"
 #include "../VSGUtils.h"
 #include <rocky/TerrainTileModelFactory.h>
+#include <atomic>
 
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::detail;
@@ -25,6 +26,9 @@ TerrainTilePager::TerrainTilePager(const TerrainSettings& settings, TerrainTileH
     _host(host),
     _settings(settings)
 {
+    static std::atomic<std::uint64_t> s_pagers = { 0 };
+    _id = ++s_pagers;
+
     _firstLOD = settings.minLevel;
 }
 
@@ -38,6 +42,15 @@ TerrainTilePager::releaseAll()
 {
     std::scoped_lock lock(_mutex);
 
+    {
+        std::scoped_lock buffersLock(_visitBuffersMutex);
+        for (auto& buffer : _visitBuffers)
+        {
+            std::scoped_lock bufferLock(buffer->mutex);
+            buffer->visits.clear();
+        }
+    }
+
     _tiles.clear();
     _tracker.reset();
     _createChildren.clear();
@@ -46,15 +59,54 @@ TerrainTilePager::releaseAll()
     _updateData.clear();
 }
 
+TerrainTilePager::VisitBuffer&
+TerrainTilePager::visitBuffer()
+{
+    // Each thread remembers its buffer in each pager it has pinged. Pagers are
+    // identified by a serial number since a new one might reuse an old one's address.
+    thread_local std::vector<std::pair<std::uint64_t, VisitBuffer*>> buffers;
+
+    for (auto& [id, buffer] : buffers)
+    {
+        if (id == _id)
+            return *buffer;
+    }
+
+    std::scoped_lock lock(_visitBuffersMutex);
+    auto* buffer = _visitBuffers.emplace_back(std::make_unique<VisitBuffer>()).get();
+
+    // forget the oldest pagers; at worst the thread starts a second buffer in one of them
+    if (buffers.size() >= 8)
+        buffers.erase(buffers.begin());
+
+    buffers.emplace_back(_id, buffer);
+    return *buffer;
+}
+
 void
 TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::RecordTraversal& rv)
 {
-    ScopedPredicateLock lock(_mutex, _settings.supportMultiThreadedRecord);
+    // One visit per tile per frame is enough, no matter how many views see it.
+    auto frame = rv.getFrameStamp()->frameCount;
+    if (tile->lastPingFrame.exchange(frame) == frame)
+        return;
+
+    auto& buffer = visitBuffer();
+    std::scoped_lock lock(buffer.mutex);
+    buffer.visits.emplace_back(Visit{ vsg::ref_ptr<TerrainTileNode>(tile), parent == nullptr });
+}
+
+void
+TerrainTilePager::visit(const Visit& visit)
+{
+    auto* tile = visit.tile.get();
+    auto& key = tile->key;
+    auto id = key.id();
 
     // first, update the tracker to keep this tile alive.
-    auto& info = _tiles[tile->key];
+    auto& info = _tiles[id];
     if (!info.tile)
-        info.tile = tile;
+        info.tile = visit.tile;
 
     if (info.trackerToken)
         info.trackerToken = _tracker.update(info.trackerToken);
@@ -70,22 +122,22 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
         // If this tile is fully merged, and it needs children, queue them up to load.
         if (info.dataMerger.available() && tile->needsSubtiles)
         {
-            _createChildren.push_back(tile->key);
+            _createChildren.push_back(id);
         }
 
-        if (parent == nullptr)
+        if (visit.root)
         {
             // If this is a root tile, and it needs data, queue that up:
             if (info.dataLoader.empty())
             {
-                _loadData.emplace_back(tile->key);
+                _loadData.emplace_back(id);
             }
         }
         else
         {
             // If this is a non-root tile that needs data, check to make sure the 
             // parent's tile is done loaded before queueing that up.
-            auto parent_iter = _tiles.find(parent->key);
+            auto parent_iter = _tiles.find(id.parent());
             if (parent_iter == _tiles.end())
             {
                 // Parent was evicted from the tile cache but the child
@@ -94,23 +146,23 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
             }
             else if (parent_iter->second.dataMerger.available() && info.dataLoader.empty())
             {
-                _loadData.push_back(tile->key);
+                _loadData.push_back(id);
             }
         }
     }
 
     // If a data-load is complete and ready to merge, queue it up.
-    // This will only queue one merge per frame to prevent overloading
-    // the (synchronous) update cycle in VSG.
+    // Merges run as metered updates, within a per-frame time budget, to
+    // prevent overloading the (synchronous) update cycle in VSG.
     if (info.dataLoader.available() && info.dataMerger.empty())
     {
-        _mergeData.emplace_back(tile->key);
+        _mergeData.emplace_back(id);
     }
 
     // Tile updates are TBD.
     if (tile->needsUpdate)
     {
-        _updateData.emplace_back(tile->key);
+        _updateData.emplace_back(id);
     }
 }
 
@@ -122,6 +174,25 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
     auto fs = vsgcontext->viewer()->getFrameStamp();
     auto& io = vsgcontext->io;
 
+    // act on the tile visits recorded since the last update.
+    {
+        std::scoped_lock buffersLock(_visitBuffersMutex);
+        for (auto& buffer : _visitBuffers)
+        {
+            {
+                std::scoped_lock bufferLock(buffer->mutex);
+                _visits.swap(buffer->visits);
+            }
+
+            for (auto& v : _visits)
+            {
+                visit(v);
+            }
+
+            _visits.clear();
+        }
+    }
+
     bool changes = false;
 
     changes =
@@ -138,9 +209,9 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
     //    << "needsMerge=" << _mergeData.size() << std::endl;
 
     // update any tiles that asked for it
-    for (auto& key : _updateData)
+    for (auto& id : _updateData)
     {
-        auto iter = _tiles.find(key);
+        auto iter = _tiles.find(id);
         if (iter != _tiles.end())
         {
             if (iter->second.tile->update(fs, io))
@@ -150,9 +221,9 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
     _updateData.clear();
 
     // launch any "new subtiles" requests
-    for (auto& key : _createChildren)
+    for (auto& id : _createChildren)
     {
-        auto iter = _tiles.find(key);
+        auto iter = _tiles.find(id);
         if (iter != _tiles.end())
         {
             requestCreateChildren(iter->second, engine, vsgcontext); // parent, context
@@ -164,9 +235,9 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
     _createChildren.clear();
 
     // launch any data loading requests
-    for (auto& key : _loadData)
+    for (auto& id : _loadData)
     {
-        auto iter = _tiles.find(key);
+        auto iter = _tiles.find(id);
         if (iter != _tiles.end())
         {
             requestLoadData(iter->second, io, engine, vsgcontext);
@@ -177,9 +248,9 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
     _loadData.clear();
 
     // schedule any data merging requests
-    for (auto& key : _mergeData)
+    for (auto& id : _mergeData)
     {
-        auto iter = _tiles.find(key);
+        auto iter = _tiles.find(id);
         if (iter != _tiles.end())
         {
             requestMergeData(iter->second, io, engine, vsgcontext);
@@ -199,8 +270,8 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
         {
             if (!tile->doNotExpire)
             {
-                auto key = tile->key;
-                auto parent_iter = _tiles.find(key.createParentKey());
+                auto& key = tile->key;
+                auto parent_iter = _tiles.find(key.id().parent());
                 if (parent_iter != _tiles.end())
                 {
                     auto parent = parent_iter->second.tile;
@@ -216,7 +287,7 @@ TerrainTilePager::update(std::shared_ptr<TerrainEngine> engine, VSGContext vsgco
                         tile->needsSubtiles = false;
                     }
                 }
-                _tiles.erase(key);
+                _tiles.erase(key.id());
                 return true;
             }
             return false;
@@ -235,7 +306,7 @@ vsg::ref_ptr<TerrainTileNode>
 TerrainTilePager::getTile(const TileKey& key) const
 {
     std::scoped_lock lock(_mutex);
-    auto iter = _tiles.find(key);
+    auto iter = _tiles.find(key.id());
     return
         iter != _tiles.end() ? iter->second.tile :
         vsg::ref_ptr<TerrainTileNode>(nullptr);
@@ -349,6 +420,7 @@ TerrainTilePager::requestLoadData(TileInfo& info, const IOOptions& in_io, std::s
 
         TerrainTileModelFactory factory;
         factory.compositeColorLayers = true;
+        factory.concurrentFetch = engine->settings.concurrentLayerFetch;
 
         auto dataModel = factory.createTileModel(engine->map.get(), key, io.with(p));
 
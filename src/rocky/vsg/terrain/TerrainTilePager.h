@@ -9,7 +9,10 @@
 #include <rocky/vsg/terrain/TerrainTileNode.h>
 #include <rocky/SentryTracker.h>
 #include <chrono>
-#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace ROCKY_NAMESPACE
 {
@@ -38,7 +41,22 @@ namespace ROCKY_NAMESPACE
             jobs::future<bool> dataMerger;
         };
 
-        using TileTable = std::map<TileKey, TileInfo>;
+        //! Tiles by TileKey::id()
+        using TileTable = std::unordered_map<TileId, TileInfo>;
+
+        //! A tile seen by a record traversal
+        struct Visit
+        {
+            vsg::ref_ptr<TerrainTileNode> tile;
+            bool root = false; // pinged without a parent
+        };
+
+        //! Visits recorded by one record thread since the last update
+        struct VisitBuffer
+        {
+            std::mutex mutex; // only contended while update() collects the visits
+            std::vector<Visit> visits;
+        };
 
     public:
         //! Consturct the tile manager.
@@ -47,7 +65,9 @@ namespace ROCKY_NAMESPACE
         ~TerrainTilePager();
 
         //! TerrainTileNode will call this to let us know that it's alive
-        //! and that it may need something.
+        //! and that it may need something. The visit is only recorded here
+        //! (in a buffer belonging to the calling thread) and acted upon in
+        //! the next update(), so record threads never wait on each other.
         //! ONLY call during record.
         void ping(
             TerrainTileNode* tile,
@@ -76,15 +96,27 @@ namespace ROCKY_NAMESPACE
         TerrainTileHost* _host;
         const TerrainSettings& _settings;
 
-        std::vector<TileKey> _createChildren;
-        std::vector<TileKey> _loadData;
-        std::vector<TileKey> _mergeData;
-        std::vector<TileKey> _updateData;
+        std::vector<TileId> _createChildren;
+        std::vector<TileId> _loadData;
+        std::vector<TileId> _mergeData;
+        std::vector<TileId> _updateData;
+
+        // per-thread visit buffers, filled by ping() and emptied by update()
+        std::uint64_t _id = 0;
+        std::mutex _visitBuffersMutex;
+        std::vector<std::unique_ptr<VisitBuffer>> _visitBuffers;
+        std::vector<Visit> _visits;
 
         unsigned _firstLOD = 0u;
 
     private:
 
+        //! This thread's visit buffer
+        VisitBuffer& visitBuffer();
+
+        //! Acts on a tile visit recorded by ping()
+        void visit(const Visit& visit);
+
         //! Loads the geometry for 4 new subtiles, and inherits their data models from a parent.
         void requestCreateChildren(
             TileInfo& info,
@@ -0,0 +1,176 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#include "TilePrefetcher.h"
+#include <rocky/ElevationLayer.h>
+#include <rocky/ImageLayer.h>
+#include <rocky/Units.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace ROCKY_NAMESPACE;
+
+#undef LC
+#define LC "[TilePrefetcher] "
+
+namespace
+{
+    // Fetches the data that the terrain's tile model factory will ask each layer for,
+    // for a single tile. The results are only returned to keep them resident.
+    std::vector<GeoImage> fetch(const TileKey& key, const std::vector<ImageLayer::Ptr>& imageLayers,
+        const std::vector<ElevationLayer::Ptr>& elevationLayers, const IOOptions& io)
+    {
+        std::vector<GeoImage> result;
+
+        for (auto& layer : imageLayers)
+        {
+            if (io.canceled())
+                return {};
+
+            if (layer->bestAvailableTileKey(key) == key)
+            {
+                auto r = layer->createTile(key, io);
+                if (r.ok())
+                    result.emplace_back(r.value());
+            }
+        }
+
+        for (auto& layer : elevationLayers)
+        {
+            if (io.canceled())
+                return {};
+
+            if (layer->bestAvailableTileKey(key) == key)
+            {
+                auto r = layer->createTile(key, io);
+                if (r.ok())
+                    result.emplace_back(r.value());
+            }
+        }
+
+        return result;
+    }
+}
+
+unsigned
+TilePrefetcher::levelOfDetail(const GeoPoint& focalPoint, double range, float viewportHeight,
+    const Profile& profile, const TerrainSettings& settings)
+{
+    unsigned level = settings.minLevel;
+
+    if (!focalPoint.valid() || !profile.valid() || range <= 0.0 || viewportHeight <= 0.0f)
+        return level;
+
+    // Same test as TerrainTileNode: a tile subdivides while its bounding radius is larger
+    // than the range times this ratio.
+    double ratio = (settings.tilePixelSize + settings.pixelError) / viewportHeight;
+
+    for (; level < settings.maxLevel; ++level)
+    {
+        auto key = TileKey::createTileKeyContainingPoint(focalPoint, level, profile);
+        if (!key.valid())
+            break;
+
+        auto extent = key.extent();
+        double radius = 0.5 * std::hypot(extent.width(Units::METERS), extent.height(Units::METERS));
+        if (radius <= range * ratio)
+            break;
+    }
+
+    return level;
+}
+
+void
+TilePrefetcher::prefetch(const GeoPoint& focalPoint, double range, float viewportHeight,
+    std::shared_ptr<const Map> map, const Profile& profile, const TerrainSettings& settings,
+    const IOOptions& io)
+{
+    if (!map)
+    {
+        clear();
+        return;
+    }
+
+    auto level = levelOfDetail(focalPoint, range, viewportHeight, profile, settings);
+    auto focalKey = TileKey::createTileKeyContainingPoint(focalPoint, level, profile);
+    if (!focalKey.valid())
+    {
+        clear();
+        return;
+    }
+
+    // the tiles we want, nearest to the focal point first:
+    std::vector<std::pair<TileKey, int>> wanted;
+    int r = (int)radius;
+    for (int dy = -r; dy <= r; ++dy)
+    {
+        for (int dx = -r; dx <= r; ++dx)
+        {
+            auto key = (dx == 0 && dy == 0) ? focalKey : focalKey.createNeighborKey(dx, dy);
+            if (key.valid())
+                wanted.emplace_back(key, dx * dx + dy * dy);
+        }
+    }
+
+    // drop the tiles the prediction has moved away from; dropping the
+    // last reference to a pending fetch cancels it.
+    for (auto i = _tiles.begin(); i != _tiles.end();)
+    {
+        bool keep = std::any_of(wanted.begin(), wanted.end(),
+            [&](auto& w) { return w.first == i->first; });
+
+        i = keep ? std::next(i) : _tiles.erase(i);
+    }
+
+    std::vector<ImageLayer::Ptr> imageLayers;
+    std::vector<ElevationLayer::Ptr> elevationLayers;
+    bool haveLayers = false;
+
+    auto& jobs = io.services().jobs;
+
+    for (auto& [key, ring] : wanted)
+    {
+        if (_tiles.find(key) != _tiles.end())
+            continue;
+
+        if (!haveLayers)
+        {
+            imageLayers = map->layers<ImageLayer>([](auto layer) { return layer->status().ok(); });
+            elevationLayers = map->layers<ElevationLayer>([](auto layer) { return layer->status().ok(); });
+            haveLayers = true;
+
+            if (imageLayers.empty() && elevationLayers.empty())
+                return;
+        }
+
+        // prefetches run in their own small pool so they never hold up a tile the
+        // terrain needs now; within it, tiles nearest the focal point go first.
+        float priority = -(float)ring;
+
+        jobs::context context;
+        context.name = "prefetch " + key.str();
+        context.pool = jobs.get_pool("rocky::prefetch", concurrency);
+        context.priority = [priority]() { return priority; };
+
+        _tiles[key] = jobs.dispatch([key = key, imageLayers, elevationLayers, io](Cancelable& c)
+            {
+                return fetch(key, imageLayers, elevationLayers, io.with(c));
+            },
+            context);
+    }
+}
+
+void
+TilePrefetcher::clear()
+{
+    _tiles.clear();
+}
+
+std::size_t
+TilePrefetcher::pending() const
+{
+    return std::count_if(_tiles.begin(), _tiles.end(),
+        [](auto& tile) { return !tile.second.available(); });
+}
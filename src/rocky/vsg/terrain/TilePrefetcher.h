@@ -0,0 +1,72 @@
+/**
+ * rocky c++
+ * Copyright 2026 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/terrain/TerrainSettings.h>
+#include <rocky/GeoImage.h>
+#include <rocky/GeoPoint.h>
+#include <rocky/Map.h>
+#include <rocky/Profile.h>
+#include <rocky/Threading.h>
+#include <rocky/TileKey.h>
+#include <map>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+    * Loads terrain data ahead of the camera.
+    *
+    * Given a prediction of where the camera will be looking shortly, fetches the
+    * layer data for the tiles the terrain will want there, at low priority, so
+    * it's already in the caches when the terrain pager asks for it. Prefetched
+    * tiles stay resident until a new prediction no longer covers them; at that
+    * point any of their fetches still pending are canceled.
+    *
+    * Not thread-safe; call from one thread (e.g. the event handler driving the camera).
+    */
+    class ROCKY_EXPORT TilePrefetcher
+    {
+    public:
+        //! Number of rings of neighboring tiles to fetch around the predicted focal tile
+        unsigned radius = 1u;
+
+        //! Maximum number of tiles to fetch at once
+        unsigned concurrency = 2u;
+
+        //! Fetches the tiles the terrain would display around a focal point, and
+        //! cancels or releases any previously prefetched tiles outside that set.
+        //! @param focalPoint Predicted focal point of the camera
+        //! @param range Predicted distance from the camera to the focal point (meters)
+        //! @param viewportHeight Height of the viewport (pixels)
+        //! @param map Map from which to fetch the data
+        //! @param profile Tiling profile of the terrain
+        //! @param settings Settings of the terrain
+        //! @param io IO options
+        void prefetch(const GeoPoint& focalPoint, double range, float viewportHeight,
+            std::shared_ptr<const Map> map, const Profile& profile, const TerrainSettings& settings,
+            const IOOptions& io);
+
+        //! Cancels all pending fetches and releases all prefetched tiles.
+        void clear();
+
+        //! Number of tiles prefetched or pending.
+        std::size_t size() const {
+            return _tiles.size();
+        }
+
+        //! Number of tiles still pending.
+        std::size_t pending() const;
+
+        //! Level of detail at which the terrain will display the tile under a focal point
+        //! seen from a given range; this mirrors the terrain's subdivision test.
+        static unsigned levelOfDetail(const GeoPoint& focalPoint, double range, float viewportHeight,
+            const Profile& profile, const TerrainSettings& settings);
+
+    private:
+        std::map<TileKey, Future<std::vector<GeoImage>>> _tiles;
+    };
+}
@@ -5,11 +5,13 @@
  * MIT License
  */
 #pragma once
+#include <algorithm>
 #include <atomic>
 #include <cfloat>
 #include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <type_traits>
@@ -34,7 +36,7 @@
 
 // Version
 #define WEEJOBS_VERSION_MAJOR 1
-#define WEEJOBS_VERSION_MINOR 2
+#define WEEJOBS_VERSION_MINOR 3
 #define WEEJOBS_VERSION_REV   0
 #define WEEJOBS_STR_NX(s) #s
 #define WEEJOBS_STR(s) WEEJOBS_STR_NX(s)
@@ -244,6 +246,121 @@ namespace WEEJOBS_NAMESPACE
             mutable std::mutex _m;
         };
 
+        /**
+         * Lock-free work-stealing deque (Chase & Lev, "Dynamic Circular Work-Stealing
+         * Deque"). We use seq_cst operations on top/bottom instead of the standalone
+         * fences of Le et al. so that thread sanitizers can reason about it.
+         *
+         * One owner thread pushes and pops at the bottom (LIFO); any number of other
+         * threads may steal from the top (FIFO). The storage grows as needed; retired
+         * buffers are kept until the deque is destroyed since a concurrent thief may
+         * still be reading from them.
+         */
+        template<typename T>
+        class ws_deque
+        {
+            static_assert(std::is_pointer<T>::value, "ws_deque holds pointers");
+
+        public:
+            //! Construct a deque with an initial capacity (rounded up to a power of 2)
+            explicit ws_deque(std::int64_t capacity = 64)
+            {
+                std::int64_t c = 1;
+                while (c < capacity) c <<= 1;
+                _buffers.emplace_back(new buffer(c));
+                _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+            }
+
+            //! Approximate number of items in the deque
+            std::int64_t size() const
+            {
+                auto b = _bottom.load(std::memory_order_relaxed);
+                auto t = _top.load(std::memory_order_relaxed);
+                return b > t ? b - t : 0;
+            }
+
+            //! Push an item onto the bottom. Owner thread only.
+            void push(T item)
+            {
+                auto b = _bottom.load(std::memory_order_relaxed);
+                auto t = _top.load(std::memory_order_acquire);
+                auto* a = _buffer.load(std::memory_order_relaxed);
+                if (b - t > a->capacity - 1)
+                    a = grow(a, t, b);
+                a->put(b, item);
+                _bottom.store(b + 1, std::memory_order_release);
+            }
+
+            //! Pop an item from the bottom, or nullptr if empty. Owner thread only.
+            T pop()
+            {
+                auto b = _bottom.load(std::memory_order_relaxed) - 1;
+                auto* a = _buffer.load(std::memory_order_relaxed);
+                _bottom.store(b, std::memory_order_seq_cst);
+                auto t = _top.load(std::memory_order_seq_cst);
+
+                T item = nullptr;
+                if (t <= b)
+                {
+                    item = a->get(b);
+                    if (t == b)
+                    {
+                        // last item; race against thieves for it
+                        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                            item = nullptr;
+                        _bottom.store(b + 1, std::memory_order_relaxed);
+                    }
+                }
+                else
+                {
+                    _bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return item;
+            }
+
+            //! Steal an item from the top, or nullptr if empty or if another
+            //! thread won the race. Any thread.
+            T steal()
+            {
+                auto t = _top.load(std::memory_order_seq_cst);
+                auto b = _bottom.load(std::memory_order_seq_cst);
+
+                if (t < b)
+                {
+                    auto* a = _buffer.load(std::memory_order_acquire);
+                    T item = a->get(t);
+                    if (_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        return item;
+                }
+                return nullptr;
+            }
+
+        private:
+            struct buffer
+            {
+                explicit buffer(std::int64_t c) : capacity(c), mask(c - 1), slots(new std::atomic<T>[c]) { }
+                std::int64_t capacity, mask;
+                std::unique_ptr<std::atomic<T>[]> slots;
+                T get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+                void put(std::int64_t i, T item) { slots[i & mask].store(item, std::memory_order_relaxed); }
+            };
+
+            buffer* grow(buffer* a, std::int64_t t, std::int64_t b)
+            {
+                auto* bigger = new buffer(a->capacity * 2);
+                for (auto i = t; i < b; ++i)
+                    bigger->put(i, a->get(i));
+                _buffers.emplace_back(bigger);
+                _buffer.store(bigger, std::memory_order_release);
+                return bigger;
+            }
+
+            alignas(64) std::atomic<std::int64_t> _top = { 0 };
+            alignas(64) std::atomic<std::int64_t> _bottom = { 0 };
+            std::atomic<buffer*> _buffer = { nullptr };
+            std::vector<std::unique_ptr<buffer>> _buffers; // owner thread only
+        };
+
 #if __cplusplus >= 201703L || _MSVC_LANG >= 201703L
         template<typename F, typename...Args>
         using result_of_t = typename std::invoke_result<F, Args...>::type;
@@ -391,12 +508,21 @@ namespace WEEJOBS_NAMESPACE
         //! or a cancelation flag is set; then returns the result object. Be sure to
         //! check canceled() after calling join() to see if the return value is valid.
         const T& join(const cancelable* p) const
+        {
+            wait(p);
+            return value();
+        }
+
+        //! Blocks until the result becomes available or the future is abandoned
+        //! or a cancelation flag is set. Returns true if the result is available.
+        //! Unlike join(), this is safe to call on a future that may never resolve.
+        bool wait(const cancelable* p = nullptr) const
         {
             while (working() && (p == nullptr || !p->canceled()))
             {
                 _shared->_ev.wait(std::chrono::milliseconds(1));
             }
-            return value();
+            return available();
         }
 
         //! Blocks until the result becomes available or the future is abandoned
@@ -497,6 +623,8 @@ namespace WEEJOBS_NAMESPACE
         {
             context ctx;
             std::function<bool()> _delegate;
+            float _priority = 0.0f; // cached result of ctx.priority() (cached-priority mode only)
+            std::chrono::steady_clock::time_point _queued; // time the job entered the queue
 
             bool operator < (const job& rhs) const
             {
@@ -504,6 +632,37 @@ namespace WEEJOBS_NAMESPACE
                 float rp = rhs.ctx.priority ? rhs.ctx.priority() : -FLT_MAX;
                 return lp < rp;
             }
+
+            //! Evaluate the priority function and cache the result
+            inline void update_priority()
+            {
+                _priority = ctx.priority ? ctx.priority() : 0.0f;
+            }
+        };
+
+        // per-thread state for work-stealing mode
+        struct ws_worker
+        {
+            class jobpool* pool = nullptr; // pool that owns this worker thread
+            ws_deque<job*> deque; // jobs dispatched from this thread; owner pushes/pops, others steal
+            std::mutex inbox_mutex;
+            std::vector<job*> inbox; // jobs dispatched from outside the pool
+        };
+
+        // the work-stealing worker running on the current thread, if any
+        inline ws_worker*& this_ws_worker()
+        {
+            static thread_local ws_worker* worker = nullptr;
+            return worker;
+        }
+
+        // heap ordering for cached-priority mode (highest priority at the front)
+        struct job_cached_priority_less
+        {
+            inline bool operator()(const job& lhs, const job& rhs) const
+            {
+                return lhs._priority < rhs._priority;
+            }
         };
 
         //inline bool steal_job(class jobpool* thief, detail::job& stolen);
@@ -528,6 +687,33 @@ namespace WEEJOBS_NAMESPACE
             std::atomic_uint postprocessing = { 0u };
             std::atomic_uint canceled = { 0u };
             std::atomic_uint total = { 0u };
+            std::atomic_uint peak_pending = { 0u }; // high-water mark of the queue depth
+            std::atomic_uint64_t dequeued = { 0u }; // number of jobs taken from the queue
+            std::atomic_uint64_t dequeue_ns = { 0u }; // total time spent selecting jobs (under lock)
+            std::atomic_uint64_t wait_ns = { 0u }; // total time jobs spent waiting in the queue
+            std::atomic_uint64_t reprioritize_ns = { 0u }; // total time spent in reprioritize()
+            std::atomic_uint64_t stolen = { 0u }; // jobs taken from another worker (work-stealing mode)
+            std::atomic_uint64_t completed = { 0u }; // number of jobs that finished running
+            std::atomic_uint64_t run_ns = { 0u }; // total time jobs spent running
+            std::atomic_uint64_t errors = { 0u }; // jobs that reported an error (for external sources; see runtime::add_metrics)
+
+            //! Average time to select the next job, in nanoseconds
+            double avg_dequeue_ns() const {
+                auto n = dequeued.load();
+                return n > 0 ? (double)dequeue_ns.load() / (double)n : 0.0;
+            }
+
+            //! Average time a job waited in the queue before running, in nanoseconds
+            double avg_wait_ns() const {
+                auto n = dequeued.load();
+                return n > 0 ? (double)wait_ns.load() / (double)n : 0.0;
+            }
+
+            //! Average time a job spent running, in nanoseconds
+            double avg_run_ns() const {
+                auto n = completed.load();
+                return n > 0 ? (double)run_ns.load() / (double)n : 0.0;
+            }
         };
 
     public:
@@ -535,6 +721,10 @@ namespace WEEJOBS_NAMESPACE
         ~jobpool()
         {
             stop_threads();
+
+            unsigned num_workers = std::min(_ws_num_workers.load(), max_ws_workers);
+            for (unsigned i = 0; i < num_workers; ++i)
+                delete _ws_workers[i].load();
         }
 
         //! Name of this job pool
@@ -572,11 +762,77 @@ namespace WEEJOBS_NAMESPACE
             _can_steal_work = value;
         }
 
+        //! Whether to cache job priorities instead of evaluating every job's
+        //! priority function each time a job is dequeued. In this mode the queue
+        //! is kept as a binary heap: each priority function is called once at dispatch
+        //! time and again only when you call reprioritize(), and dequeuing is O(log n).
+        //! Default = false (exact priorities, O(n) dequeue).
+        void set_cached_priorities(bool value)
+        {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            if (_cached_priorities != value)
+            {
+                _cached_priorities = value;
+                if (_cached_priorities)
+                {
+                    for (auto& job : _queue)
+                        job.update_priority();
+                    std::make_heap(_queue.begin(), _queue.end(), detail::job_cached_priority_less());
+                }
+            }
+        }
+
+        //! Whether priority caching is enabled
+        bool cached_priorities() const
+        {
+            return _cached_priorities;
+        }
+
+        //! Re-evaluates the priority function of every queued job and re-sorts the queue.
+        //! Only meaningful when cached priorities are enabled. Call this periodically
+        //! (e.g., once per frame) so the queue tracks changing priorities.
+        void reprioritize()
+        {
+            if (!_cached_priorities)
+                return;
+
+            auto t0 = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(_queue_mutex);
+                for (auto& job : _queue)
+                    job.update_priority();
+                std::make_heap(_queue.begin(), _queue.end(), detail::job_cached_priority_less());
+            }
+            _metrics.reprioritize_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+        }
+
+        //! Whether to run jobs in work-stealing mode. In this mode each worker thread
+        //! has its own lock-free deque: a job dispatched from a worker goes onto that
+        //! worker's deque, a job dispatched from any other thread goes into one worker's
+        //! inbox (round-robin), and idle workers steal from the others. This avoids
+        //! contention on the pool's queue lock when running many small jobs.
+        //! Jobs with a priority function still go into the pool's priority queue and
+        //! run in priority order; workers service their deques first, so unprioritized
+        //! jobs run ahead of prioritized ones.
+        //! Default = false.
+        void set_work_stealing(bool value)
+        {
+            _work_stealing = value;
+        }
+
+        //! Whether work-stealing mode is enabled
+        bool work_stealing() const
+        {
+            return _work_stealing;
+        }
+
         //! Discard all queued jobs
         void cancel_all()
         {
             std::lock_guard<std::mutex> lock(_queue_mutex);
             _queue.clear();
+            _ws_discard();
             _metrics.canceled += _metrics.pending;
             _metrics.pending = 0;
         }
@@ -595,13 +851,38 @@ namespace WEEJOBS_NAMESPACE
                     context.group->acquire();
                 }
 
-                if (_target_concurrency > 0)
+                if (_target_concurrency > 0 && _work_stealing && !context.priority && _ws_dispatch(delegate, context))
                 {
+                    // queued on a work-stealing deque
+                }
+                else if (_target_concurrency > 0)
+                {
+                    detail::job job{ context, delegate };
+                    job._queued = std::chrono::steady_clock::now();
+
+                    // evaluate the priority outside the lock when we can
+                    bool evaluated = _cached_priorities;
+                    if (evaluated)
+                        job.update_priority();
+
                     std::lock_guard<std::mutex> lock(_queue_mutex);
 
-                    _queue.emplace_back(detail::job{ context, delegate });
+                    if (_cached_priorities)
+                    {
+                        if (!evaluated)
+                            job.update_priority();
+
+                        _queue.emplace_back(std::move(job));
+                        std::push_heap(_queue.begin(), _queue.end(), detail::job_cached_priority_less());
+                    }
+                    else
+                    {
+                        _queue.emplace_back(std::move(job));
+                    }
 
-                    _metrics.pending++;
+                    auto pending = ++_metrics.pending;
+                    if (pending > _metrics.peak_pending)
+                        _metrics.peak_pending = pending;
                     _metrics.total++;
                     _block.notify_one();
                 }
@@ -628,8 +909,22 @@ namespace WEEJOBS_NAMESPACE
                 std::lock_guard<std::mutex> lock(_queue_mutex);
                 return _take_job(output, false);
             }
+            else if (!_done && !_queue.empty() && _cached_priorities)
+            {
+                auto t0 = std::chrono::steady_clock::now();
+
+                std::pop_heap(_queue.begin(), _queue.end(), detail::job_cached_priority_less());
+                output = std::move(_queue.back());
+                _queue.pop_back();
+
+                _metrics.pending--;
+                _record_dequeue(output, t0);
+                return true;
+            }
             else if (!_done && !_queue.empty())
             {
+                auto t0 = std::chrono::steady_clock::now();
+
                 auto ptr = _queue.end();
                 float highest_priority = -FLT_MAX;
                 for (auto iter = _queue.begin(); iter != _queue.end(); ++iter)
@@ -654,11 +949,165 @@ namespace WEEJOBS_NAMESPACE
                 _queue.resize(_queue.size() - 1);
 
                 _metrics.pending--;
+                _record_dequeue(output, t0);
                 return true;
             }
             return false;
         }
 
+        // queue a job on a work-stealing deque (or inbox). Returns false if there
+        // are no workers to receive it.
+        inline bool _ws_dispatch(std::function<bool()>& delegate, const context& context)
+        {
+            auto* self = detail::this_ws_worker();
+            if (self && self->pool != this)
+                self = nullptr;
+
+            unsigned num_workers = std::min(_ws_num_workers.load(), max_ws_workers);
+            if (!self && num_workers == 0)
+                return false;
+
+            auto* job = new detail::job{ context, delegate };
+            job->_queued = std::chrono::steady_clock::now();
+
+            // count it before publishing it so takers never see a negative count
+            ++_ws_pending;
+            auto pending = ++_metrics.pending;
+            if (pending > _metrics.peak_pending)
+                _metrics.peak_pending = pending;
+            _metrics.total++;
+
+            if (self)
+            {
+                self->deque.push(job);
+            }
+            else
+            {
+                auto* worker = _ws_workers[_ws_next_inbox++ % num_workers].load();
+                std::lock_guard<std::mutex> lock(worker->inbox_mutex);
+                worker->inbox.push_back(job);
+            }
+
+            // only touch the lock if someone is actually waiting
+            if (_ws_sleepers > 0)
+            {
+                std::lock_guard<std::mutex> lock(_queue_mutex);
+                _block.notify_one();
+            }
+            return true;
+        }
+
+        // take a job from this thread's deque, its inbox, or another worker.
+        inline bool _ws_take(detail::job& output)
+        {
+            if (_ws_pending <= 0)
+                return false;
+
+            auto t0 = std::chrono::steady_clock::now();
+
+            auto* self = detail::this_ws_worker();
+            if (self && self->pool != this)
+                self = nullptr;
+
+            detail::job* job = nullptr;
+
+            if (self)
+            {
+                job = self->deque.pop();
+
+                if (!job)
+                {
+                    // move our inbox onto our deque, where other workers can steal from it
+                    std::vector<detail::job*> incoming;
+                    {
+                        std::lock_guard<std::mutex> lock(self->inbox_mutex);
+                        incoming.swap(self->inbox);
+                    }
+                    for (auto* j : incoming)
+                        self->deque.push(j);
+                    job = self->deque.pop();
+                }
+            }
+
+            if (!job)
+            {
+                unsigned num_workers = std::min(_ws_num_workers.load(), max_ws_workers);
+                unsigned start = (unsigned)std::hash<std::thread::id>()(std::this_thread::get_id());
+                for (unsigned i = 0; i < num_workers && !job; ++i)
+                {
+                    auto* victim = _ws_workers[(start + i) % num_workers].load();
+                    if (victim == self)
+                        continue;
+
+                    job = victim->deque.steal();
+
+                    if (!job && victim->inbox_mutex.try_lock())
+                    {
+                        if (!victim->inbox.empty())
+                        {
+                            job = victim->inbox.back();
+                            victim->inbox.pop_back();
+                        }
+                        victim->inbox_mutex.unlock();
+                    }
+
+                    if (job)
+                        _metrics.stolen++;
+                }
+            }
+
+            if (!job)
+                return false;
+
+            --_ws_pending;
+            _metrics.pending--;
+            output = std::move(*job);
+            delete job;
+            _record_dequeue(output, t0);
+            return true;
+        }
+
+        // discard all jobs in the work-stealing deques and inboxes.
+        // Returns the number of jobs discarded.
+        inline unsigned _ws_discard()
+        {
+            unsigned count = 0;
+            auto discard = [&](detail::job* job)
+                {
+                    if (job->ctx.group != nullptr)
+                        job->ctx.group->release();
+                    delete job;
+                    --_ws_pending;
+                    _metrics.pending--;
+                    ++count;
+                };
+
+            unsigned num_workers = std::min(_ws_num_workers.load(), max_ws_workers);
+            for (unsigned i = 0; i < num_workers; ++i)
+            {
+                auto* worker = _ws_workers[i].load();
+
+                // steal() is safe from any thread
+                while (auto* job = worker->deque.steal())
+                    discard(job);
+
+                std::lock_guard<std::mutex> lock(worker->inbox_mutex);
+                for (auto* job : worker->inbox)
+                    discard(job);
+                worker->inbox.clear();
+            }
+            return count;
+        }
+
+        // update the dequeue metrics for a job just taken from the queue
+        inline void _record_dequeue(const detail::job& job, std::chrono::steady_clock::time_point t0)
+        {
+            auto t1 = std::chrono::steady_clock::now();
+            _metrics.dequeued++;
+            _metrics.dequeue_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            _metrics.wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - job._queued).count();
+        }
+
         //! Construct a new job pool.
         //! Do not call this directly - call getPool(name) instead.
         jobpool(runtime& rt, const std::string& name, unsigned concurrency);
@@ -678,6 +1127,14 @@ namespace WEEJOBS_NAMESPACE
 
         class runtime& _runtime;
         std::atomic<bool> _can_steal_work = { true };
+        std::atomic<bool> _cached_priorities = { false }; // queue is a heap on job::_priority
+        std::atomic<bool> _work_stealing = { false }; // route unprioritized jobs to per-worker deques
+        static constexpr unsigned max_ws_workers = 256u;
+        std::atomic<detail::ws_worker*> _ws_workers[max_ws_workers] = { }; // one per thread ever started
+        std::atomic<unsigned> _ws_num_workers = { 0u };
+        std::atomic<unsigned> _ws_next_inbox = { 0u };
+        std::atomic<std::int64_t> _ws_pending = { 0 }; // jobs in all deques and inboxes
+        std::atomic<unsigned> _ws_sleepers = { 0u }; // threads waiting on _block
         std::vector<detail::job> _queue;
         mutable std::mutex _queue_mutex; // protect access to the queue
         std::atomic<unsigned> _target_concurrency; // target number of concurrent threads in the pool
@@ -753,6 +1210,14 @@ namespace WEEJOBS_NAMESPACE
         //! Metrics for all job pool
         inline metrics* get_metrics();
 
+        //! Lists a metrics structure that isn't a job pool's (e.g., a work queue managed
+        //! elsewhere) alongside the pools' in get_metrics(). The structure must outlive
+        //! any use of get_metrics().
+        inline void add_metrics(jobpool::metrics_t* m);
+
+        //! Removes a metrics structure listed with add_metrics.
+        inline void remove_metrics(jobpool::metrics_t* m);
+
         //! stop all threads, wait for them to exit, and shut down the system
         inline void shutdown();
 
@@ -903,14 +1368,17 @@ namespace WEEJOBS_NAMESPACE
         {
             std::lock_guard<std::mutex> lock(_pools_mutex);
 
-            std::size_t max_num_jobs = 0u;
+            // only count jobs in each pool's queue; _take_job can't reach the ones
+            // in its work-stealing deques.
+            std::int64_t max_num_jobs = 0;
             for (auto pool : _pools)
             {
                 if (pool != thief)
                 {
-                    if (pool->_metrics.pending > max_num_jobs)
+                    std::int64_t queued = (std::int64_t)pool->_metrics.pending - pool->_ws_pending;
+                    if (queued > max_num_jobs)
                     {
-                        max_num_jobs = pool->_metrics.pending;
+                        max_num_jobs = queued;
                         pool_with_most_jobs = pool;
                     }
                 }
@@ -966,6 +1434,19 @@ namespace WEEJOBS_NAMESPACE
         return &_metrics;
     }
 
+    inline void runtime::add_metrics(jobpool::metrics_t* m)
+    {
+        std::lock_guard<std::mutex> lock(_pools_mutex);
+        _metrics._pools.push_back(m);
+    }
+
+    inline void runtime::remove_metrics(jobpool::metrics_t* m)
+    {
+        std::lock_guard<std::mutex> lock(_pools_mutex);
+        auto& pools = _metrics._pools;
+        pools.erase(std::remove(pools.begin(), pools.end(), m), pools.end());
+    }
+
     inline void runtime::set_thread_name_function(std::function<void(const char*)> f)
     {
         _set_thread_name = f;
@@ -991,6 +1472,14 @@ namespace WEEJOBS_NAMESPACE
         {
             detail::job next;
             bool have_next = false;
+
+            // work-stealing deques first; these never block
+            if (_ws_pending > 0)
+            {
+                have_next = _ws_take(next);
+            }
+
+            if (!have_next)
             {
                 if (_can_steal_work && _runtime._stealing_allowed)
                 {
@@ -998,7 +1487,9 @@ namespace WEEJOBS_NAMESPACE
                         std::unique_lock<std::mutex> lock(_queue_mutex);
 
                         // work-stealing enabled: wait until any queue is non-empty
+                        ++_ws_sleepers;
                         _block.wait(lock, [this]() { return _metrics.pending > 0 || _done; });
+                        --_ws_sleepers;
 
                         if (!_done && !_queue.empty())
                         {
@@ -1015,8 +1506,10 @@ namespace WEEJOBS_NAMESPACE
                 {
                     std::unique_lock<std::mutex> lock(_queue_mutex);
 
-                    // wait until just our local queue is non-empty
-                    _block.wait(lock, [this] { return !_queue.empty() || _done; });
+                    // wait until just our local queue (or deques) are non-empty
+                    ++_ws_sleepers;
+                    _block.wait(lock, [this] { return !_queue.empty() || _ws_pending > 0 || _done; });
+                    --_ws_sleepers;
 
                     if (!_done && !_queue.empty())
                     {
@@ -1039,6 +1532,11 @@ namespace WEEJOBS_NAMESPACE
                 {
                     _metrics.canceled++;
                 }
+                else
+                {
+                    _metrics.completed++;
+                    _metrics.run_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+                }
 
                 // release the group semaphore if necessary
                 if (next.ctx.group != nullptr)
@@ -1068,8 +1566,20 @@ namespace WEEJOBS_NAMESPACE
         {
             _metrics.concurrency++;
 
-            _threads.push_back(std::thread([this]
+            // each thread gets a deque for work-stealing mode
+            detail::ws_worker* worker = nullptr;
+            if (_ws_num_workers < max_ws_workers)
+            {
+                worker = new detail::ws_worker();
+                worker->pool = this;
+                _ws_workers[_ws_num_workers].store(worker);
+                ++_ws_num_workers;
+            }
+
+            _threads.push_back(std::thread([this, worker]
                 {
+                    detail::this_ws_worker() = worker;
+
                     if (_runtime._set_thread_name)
                     {
                         _runtime._set_thread_name(_metrics.name.c_str());
@@ -1098,6 +1608,8 @@ namespace WEEJOBS_NAMESPACE
         }
         _queue.clear();
 
+        _ws_discard();
+
         // wake up all threads so they can exit
         _block.notify_all();
     }
@@ -1,8 +1,33 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 #include <rocky/rocky.h>
+#include <rocky/TerrainTileModelFactory.h>
+#include <rocky/Reprojection.h>
+#include <rocky/ElevationSampler.h>
+#include <rocky/TileSeeder.h>
+#ifdef ROCKY_HAS_VSG
+#include <rocky/vsg/terrain/TilePrefetcher.h>
+#endif
 #include <random>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#ifdef ROCKY_HAS_GDAL
+#include <gdal_priv.h>
+#include <ogr_spatialref.h>
+#endif
 
 #define ROCKY_EXPOSE_JSON_FUNCTIONS
 #include <rocky/json.h>
@@ -19,6 +44,187 @@ namespace
             return ResultVoidOK;
         }
     };
+
+    // Elevation layer producing a constant height, optionally only on the western
+    // half of each tile and only within the given data extent.
+    class TestElevationLayer : public Inherit<ElevationLayer, TestElevationLayer>
+    {
+    public:
+        float height = 0.0f;
+        bool westHalfOnly = false;
+        GeoExtent coverage;
+        TileKey failKey; // createTile fails for this key
+        mutable std::atomic_int created = { 0 };
+
+        Result<> openImplementation(const IOOptions& io) override {
+            profile = Profile("global-geodetic");
+            auto r = super::openImplementation(io);
+            if (r.ok() && coverage.valid())
+                setDataExtents({ DataExtent(coverage) });
+            return r;
+        }
+
+        Result<GeoImage> createTileImplementation(const TileKey& key, const IOOptions& io) const override {
+            ++created;
+            if (key == failKey)
+                return Failure(Failure::GeneralError, "Test failure");
+            auto hf = Heightfield::create(17, 17);
+            for (unsigned t = 0; t < hf.height(); ++t)
+                for (unsigned s = 0; s < hf.width(); ++s)
+                    hf.heightAt(s, t) = (westHalfOnly && s > hf.width() / 2) ? NO_DATA_VALUE : height;
+            return GeoImage(hf.image, key.extent());
+        }
+    };
+}
+
+namespace
+{
+#ifdef _WIN32
+    using socket_t = SOCKET;
+    inline void shutdownSocket(socket_t s) { ::shutdown(s, SD_BOTH); }
+    inline void closeSocket(socket_t s) { ::closesocket(s); }
+#else
+    using socket_t = int;
+    constexpr socket_t INVALID_SOCKET = -1;
+    inline void shutdownSocket(socket_t s) { ::shutdown(s, SHUT_RDWR); }
+    inline void closeSocket(socket_t s) { ::close(s); }
+#endif
+
+    // Minimal keep-alive HTTP/1.1 server on the loopback interface, standing in
+    // for a tile server. GET /status/<code> answers with that status code; any
+    // other GET answers 200 with the request path as a text/plain body.
+    class LocalHTTPServer
+    {
+    public:
+        //! Number of requests answered so far
+        std::atomic_int requests = { 0 };
+
+        //! Time to wait before answering each request
+        std::atomic<std::chrono::milliseconds> delay = { std::chrono::milliseconds(0) };
+
+        LocalHTTPServer()
+        {
+#ifdef _WIN32
+            WSADATA data;
+            WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+            _listener = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0; // ephemeral
+            socklen_t len = sizeof(addr);
+            if (_listener == INVALID_SOCKET ||
+                ::bind(_listener, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+                ::listen(_listener, 64) != 0 ||
+                ::getsockname(_listener, (sockaddr*)&addr, &len) != 0)
+            {
+                return;
+            }
+            _port = ntohs(addr.sin_port);
+            _acceptor = std::thread([this]() { acceptLoop(); });
+        }
+
+        ~LocalHTTPServer()
+        {
+            // wake up the blocked threads; each one closes its own socket.
+            _done = true;
+            if (_listener != INVALID_SOCKET)
+                shutdownSocket(_listener);
+            if (_acceptor.joinable())
+                _acceptor.join();
+            if (_listener != INVALID_SOCKET)
+                closeSocket(_listener);
+            {
+                std::scoped_lock lock(_mutex);
+                for (auto s : _clients)
+                    shutdownSocket(s);
+            }
+            for (auto& t : _connections)
+                t.join();
+#ifdef _WIN32
+            WSACleanup();
+#endif
+        }
+
+        bool ok() const {
+            return _port != 0;
+        }
+
+        std::string url(const std::string& path) const {
+            return "http://127.0.0.1:" + std::to_string(_port) + path;
+        }
+
+    private:
+        socket_t _listener = INVALID_SOCKET;
+        unsigned short _port = 0;
+        std::atomic_bool _done = { false };
+        std::thread _acceptor;
+        std::mutex _mutex;
+        std::vector<socket_t> _clients;
+        std::vector<std::thread> _connections;
+
+        void acceptLoop()
+        {
+            while (!_done)
+            {
+                socket_t client = ::accept(_listener, nullptr, nullptr);
+                if (client == INVALID_SOCKET)
+                    break;
+
+                std::scoped_lock lock(_mutex);
+                if (_done)
+                {
+                    closeSocket(client);
+                    break;
+                }
+                _clients.push_back(client);
+                _connections.emplace_back([this, client]() { serve(client); });
+            }
+        }
+
+        void serve(socket_t client)
+        {
+            std::string buffer;
+            char chunk[4096];
+            while (!_done)
+            {
+                auto end = buffer.find("\r\n\r\n");
+                if (end == std::string::npos)
+                {
+                    auto n = ::recv(client, chunk, sizeof(chunk), 0);
+                    if (n <= 0)
+                        break;
+                    buffer.append(chunk, (std::size_t)n);
+                    continue;
+                }
+
+                // request line: GET <path> HTTP/1.1
+                auto line = buffer.substr(0, buffer.find("\r\n"));
+                buffer.erase(0, end + 4);
+                auto p0 = line.find(' '), p1 = line.rfind(' ');
+                std::string path = (p0 != std::string::npos && p1 > p0) ? line.substr(p0 + 1, p1 - p0 - 1) : "/";
+
+                std::this_thread::sleep_for(delay.load());
+
+                int status = 200;
+                if (startsWith(path, "/status/"))
+                    status = std::atoi(path.c_str() + 8);
+
+                std::string body = status == 200 ? path : std::string();
+                std::string response =
+                    "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : " Error") + "\r\n"
+                    "Content-Type: text/plain\r\n"
+                    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                    "\r\n" + body;
+
+                ++requests;
+                if (::send(client, response.data(), (int)response.size(), 0) != (int)response.size())
+                    break;
+            }
+            closeSocket(client);
+        }
+    };
 }
 
 TEST_CASE("strings")
@@ -36,6 +242,10 @@ TEST_CASE("strings")
     CHECK(s1 == "Hello, Rocky!");
     s1 = "  Hello, Rocky!  ";
     CHECK(detail::trimInPlace(s1) == "Hello, Rocky!");
+
+    // stable hashes are fixed values (FNV-1a), since they name persistent data
+    CHECK(detail::stableHash("") == 0xcbf29ce484222325ull);
+    CHECK(detail::stableHash("a") == 0xaf63dc4c8601ec8cull);
 }
 
 TEST_CASE("json")
@@ -109,6 +319,60 @@ TEST_CASE("TileKey")
     CHECK(TileKey(2, 0, 0, p).quadKey() == "000");
     CHECK(TileKey(2, 1, 0, p).quadKey() == "001");
     CHECK(TileKey(2, 5, 1, p).quadKey() == "103");
+
+    // packed ids
+    auto id = TileKey(7, 100, 45, p).id();
+    CHECK(id.valid());
+    CHECK(id.level() == 7);
+    CHECK(id.x() == 100);
+    CHECK(id.y() == 45);
+    CHECK(id.profileIndex() == p.index());
+    CHECK(id == TileKey(7, 100, 45, Profile("global-geodetic")).id());
+    CHECK(id != TileKey(7, 100, 45, Profile("spherical-mercator")).id());
+    CHECK(id.parent() == TileKey(7, 100, 45, p).createParentKey().id());
+    CHECK(id.child(3) == TileKey(7, 100, 45, p).createChildKey(3).id());
+    CHECK(TileKey(0, 0, 0, p).id().parent().valid() == false);
+    CHECK(TileKey().id().valid() == false);
+    CHECK(TileId(27, 1u << 27, 0, p.index()).valid() == false);
+
+    // the vertical datum distinguishes profiles that are otherwise equivalent
+    Profile p_egm96(SRS("epsg:4326+5773"), Box(-180.0, -90.0, 180.0, 90.0), 2, 1);
+    REQUIRE(p_egm96.valid());
+    CHECK(p_egm96 == p);
+    CHECK(p_egm96.index() > 0);
+    CHECK(p_egm96.index() != p.index());
+
+    // deepest level the terrain can page in the stock profiles
+    auto deepest = TileId::maxLevel(p);
+    CHECK(deepest == 26);
+    CHECK(TileId::maxLevel(Profile("spherical-mercator")) == 27);
+    TileKey corner(deepest, (2u << deepest) - 1, (1u << deepest) - 1, p);
+    CHECK(corner.id().valid());
+    CHECK(corner.id().x() == corner.x);
+    CHECK(corner.createChildKey(3).id().valid() == false);
+
+    // quadtree order: parent first, then children in quadrant order
+    CHECK(TileKey(1, 0, 0, p).id() < TileKey(2, 0, 0, p).id());
+    CHECK(TileKey(2, 0, 0, p).id() < TileKey(2, 1, 0, p).id());
+    CHECK(TileKey(2, 1, 1, p).id() < TileKey(1, 1, 0, p).id());
+    CHECK(!(TileKey(1, 1, 0, p).id() < TileKey(2, 1, 1, p).id()));
+
+    std::unordered_map<TileId, int> table;
+    table[TileKey(3, 1, 2, p).id()] = 1;
+    table[TileKey(3, 2, 1, p).id()] = 2;
+    CHECK(table.size() == 2);
+    CHECK(table[TileKey(3, 1, 2, p).id()] == 1);
+}
+
+namespace
+{
+    // counts live instances, for testing ThreadLocal
+    struct Counter {
+        static inline std::atomic_int live = { 0 };
+        int uses = 0;
+        Counter() { ++live; }
+        ~Counter() { --live; }
+    };
 }
 
 TEST_CASE("Threading")
@@ -130,6 +394,204 @@ TEST_CASE("Threading")
     CHECK(f2.empty() == false);
     CHECK(f2.available() == true);
     CHECK(f2.value() == 123);
+
+    // cached priorities: jobs run in priority order, re-sorted by reprioritize()
+    {
+        jobs::runtime rt;
+        auto pool = rt.get_pool("cached", 1);
+        pool->set_cached_priorities(true);
+
+        // occupy the only thread so the rest of the jobs queue up
+        std::atomic_bool release = { false };
+        rt.dispatch([&]() { while (!release) std::this_thread::yield(); }, jobs::context{ "blocker", pool });
+        while (pool->metrics()->running == 0) std::this_thread::yield();
+
+        std::mutex order_mutex;
+        std::vector<int> order;
+        float priorities[4] = { 1.0f, 3.0f, 2.0f, 0.0f };
+        auto group = jobs::jobgroup::create();
+        for (int i = 0; i < 4; ++i)
+        {
+            rt.dispatch([&, i]() { std::scoped_lock lock(order_mutex); order.push_back(i); },
+                jobs::context{ "job", pool, [&priorities, i]() { return priorities[i]; }, group });
+        }
+
+        priorities[3] = 4.0f; // not seen until we reprioritize
+        pool->reprioritize();
+
+        CHECK(pool->metrics()->peak_pending >= 4);
+        release = true;
+        group->join();
+        CHECK(order == std::vector<int>{ 3, 1, 2, 0 });
+        CHECK(pool->metrics()->dequeued >= 5);
+    }
+
+    // work stealing: jobs dispatched from inside and outside the pool all run
+    {
+        jobs::runtime rt;
+        auto pool = rt.get_pool("stealing", 4);
+        pool->set_work_stealing(true);
+
+        std::atomic_int count = { 0 };
+        auto group = jobs::jobgroup::create();
+        for (int i = 0; i < 8; ++i)
+        {
+            rt.dispatch([&]()
+                {
+                    for (int j = 0; j < 100; ++j)
+                        rt.dispatch([&]() { ++count; }, jobs::context{ "child", pool, {}, group });
+                    ++count;
+                }, jobs::context{ "parent", pool, {}, group });
+        }
+        group->join();
+        CHECK(count == 808);
+        CHECK(pool->metrics()->pending == 0);
+    }
+
+    // runConcurrently: every task runs exactly once, even from inside a busy pool
+    {
+        jobs::runtime rt;
+        auto pool = rt.get_pool("concurrent", 1);
+
+        auto outer = rt.dispatch([&](Cancelable&)
+            {
+                std::vector<int> results(16, 0);
+                std::vector<std::function<void()>> tasks;
+                for (int i = 0; i < 16; ++i)
+                    tasks.emplace_back([&results, i]() { results[i] = i * i; });
+
+                detail::runConcurrently(tasks, rt, pool);
+
+                int sum = 0;
+                for (int i = 0; i < 16; ++i)
+                    sum += results[i] == i * i ? 1 : 0;
+                return sum;
+            }, jobs::context{ "outer", pool });
+
+        CHECK(outer.join() == 16);
+    }
+
+    // ThreadLocal: one value per thread, idle values reaped by other threads
+    {
+        detail::ThreadLocal<Counter> local;
+        CHECK(local.access()->uses == 0);
+
+        // keep every thread alive until all are done, so none reuses another's index
+        std::atomic_int done = { 0 };
+        std::atomic_int correct = { 0 };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([&]()
+                {
+                    for (int j = 0; j < 100; ++j)
+                        local.access()->uses++;
+                    if (local.access()->uses == 100) ++correct;
+                    ++done;
+                    while (done < 8) std::this_thread::yield();
+                });
+        }
+        for (auto& t : threads)
+            t.join();
+        CHECK(correct == 8);
+        CHECK(Counter::live == 9);
+
+        // a new thread that gets an exited thread's index starts with a fresh value
+        std::atomic_int fresh = { 0 };
+        for (int i = 0; i < 8; ++i)
+        {
+            std::thread([&]()
+                {
+                    if (local.access()->uses == 0) ++fresh;
+                    local.access()->uses = 42;
+                }).join();
+        }
+        CHECK(fresh == 8);
+
+        // an Access keeps its value alive even when it's due to be reaped
+        {
+            auto mine = local.access();
+            local.idleTimeout = std::chrono::milliseconds(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::thread([&]() { local.access(); }).join(); // reaps idle values
+            CHECK(mine->uses == 0);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(local.access()->uses == 0); // still this thread's own value; the others' values are gone
+        CHECK(Counter::live == 1);
+
+        local.clear();
+        CHECK(Counter::live == 0);
+    }
+
+    // SingleFlight: callers that claim a key in flight share the leader's result
+    {
+        detail::SingleFlight<std::string, int> flights;
+        bool leader1, leader2, leader3;
+        auto f1 = flights.claim("a", leader1);
+        auto f2 = flights.claim("a", leader2);
+        auto f3 = flights.claim("b", leader3);
+        CHECK((leader1 && !leader2 && leader3));
+        CHECK(flights.size() == 2);
+
+        flights.finish("a", 42);
+        CHECK((f1.available() && f2.available() && f1.value() == 42 && f2.value() == 42));
+        CHECK(f3.available() == false);
+        CHECK(flights.size() == 1);
+
+        // a finished key starts over:
+        auto f4 = flights.claim("a", leader1);
+        CHECK((leader1 && !f4.available()));
+    }
+}
+
+TEST_CASE("Cache")
+{
+    // default cost function counts entries:
+    detail::ShardedCache<std::string, int> counted(4);
+    for (int i = 0; i < 4; ++i)
+        counted.put(std::to_string(i), i);
+    CHECK(counted.size() == 4);
+    CHECK(counted.get("2") == 2);
+    counted.put("4", 4);
+    CHECK(counted.size() == 4);
+    CHECK(counted.evictions() == 1);
+    CHECK(counted.get("2").has_value()); // recently used, so it got a second chance
+
+    // byte-weighted (one shard, so each entry can use the whole budget):
+    detail::ShardedCache<std::string, std::string> weighted(1000,
+        [](const std::string&, const std::string& value) { return value.size(); }, 1);
+    weighted.put("small", std::string(10, 'x'));
+    weighted.put("large", std::string(900, 'x'));
+    weighted.put("too large", std::string(2000, 'x'));
+    CHECK(weighted.get("too large").has_value() == false);
+    CHECK(weighted.rejections() == 1);
+    CHECK(weighted.bytes() == 910);
+
+    // growing an existing entry evicts others to stay within capacity:
+    weighted.put("small", std::string(500, 'x'));
+    CHECK(weighted.bytes() <= weighted.capacity());
+    CHECK(weighted.get("small").has_value());
+    CHECK(weighted.get("large").has_value() == false);
+
+    // ...and growing it past the per-entry limit removes it:
+    weighted.put("small", std::string(2000, 'x'));
+    CHECK(weighted.get("small").has_value() == false);
+    CHECK(weighted.bytes() == 0);
+
+    // with several shards, the per-entry limit is one shard's share:
+    detail::ShardedCache<std::string, std::string> sharded(4000,
+        [](const std::string&, const std::string& value) { return value.size(); }, 4);
+    CHECK(sharded.maxEntryCost() == 1000);
+    sharded.put("fits", std::string(1000, 'x'));
+    sharded.put("does not fit", std::string(1001, 'x'));
+    CHECK(sharded.get("fits").has_value());
+    CHECK(sharded.get("does not fit").has_value() == false);
+    CHECK(sharded.rejections() == 1);
+
+    ContentCache content;
+    CHECK(content.maxEntryCost() == content.capacity() / 4);
 }
 
 TEST_CASE("Math")
@@ -219,6 +681,113 @@ TEST_CASE("Image")
     CHECK(glm::epsilonEqual(value.g, 0.65f, 0.01f));
     CHECK(glm::epsilonEqual(value.b, 0.0f, 0.01f));
     CHECK(glm::epsilonEqual(value.a, 1.0f, 0.01f));
+
+    SECTION("Composite")
+    {
+        GeoExtent extent(SRS::WGS84, -10, -10, 10, 10);
+
+        auto bottom = Image::create(Image::R8G8B8A8_UNORM, 128, 128);
+        bottom->fill(Image::Pixel(1, 0, 0, 1));
+        auto top = Image::create(Image::R8G8B8A8_UNORM, 128, 128);
+        top->fill(Image::Pixel(0, 1, 0, 1));
+
+        // the top source covers only the eastern half
+        std::vector<GeoImage> sources = {
+            GeoImage(bottom, extent),
+            GeoImage(top, GeoExtent(SRS::WGS84, 0, -10, 10, 10)) };
+        std::vector<float> opacities = { 1.0f, 0.5f };
+
+        auto serial = Image::create(Image::R8G8B8A8_UNORM, 128, 128);
+        GeoImage(serial, extent).composite(sources, opacities);
+
+        CHECK(glm::all(glm::epsilonEqual(serial->read(10, 64), Image::Pixel(1, 0, 0, 1), 0.01f)));
+        CHECK(glm::all(glm::epsilonEqual(serial->read(120, 64), Image::Pixel(0.5f, 0.5f, 0, 0.75f), 0.01f)));
+
+        // splitting rows across threads gives the same result
+        IOOptions io;
+        auto parallel = Image::create(Image::R8G8B8A8_UNORM, 128, 128);
+        GeoImage(parallel, extent).composite(sources, opacities, &io);
+        CHECK(std::memcmp(serial->data<char>(), parallel->data<char>(), serial->sizeInBytes()) == 0);
+    }
+
+    SECTION("Reprojection")
+    {
+        // a mercator source sampled on a geographic grid: a separable mapping
+        Profile merc("spherical-mercator");
+        TileKey key(2, 1, 1, Profile("global-geodetic"));
+        auto sourceKeys = key.intersectingKeys(merc);
+        REQUIRE(!sourceKeys.empty());
+
+        auto sourceImage = Image::create(Image::R8G8B8A8_UNORM, 64, 64);
+        sourceImage->eachPixel([&](const Image::iterator& i) {
+            sourceImage->write(Image::Pixel(i.u(), i.v(), 0.5f, 1.0f), i); });
+        std::vector<GeoImage> sources = { GeoImage(sourceImage, sourceKeys.front().extent()) };
+
+        detail::ReprojectionGrid grid(key.extent(), 32, 32, true, merc.srs());
+        CHECK(grid.separable);
+
+        IOOptions io;
+        auto output = Image::create(Image::R8G8B8A8_UNORM, 32, 32);
+        REQUIRE(detail::mosaicImages(grid, sources, *output, io));
+
+        // same result as reading each point individually:
+        unsigned mismatches = 0;
+        for (unsigned r = 0; r < grid.rows; ++r)
+        {
+            for (unsigned c = 0; c < grid.cols; ++c)
+            {
+                auto p = grid.point(c, r);
+                auto expected = sources[0].read(p.x, p.y);
+                auto actual = output->read(c, r);
+                if (expected.ok() && expected.value().a > 0.0f)
+                {
+                    if (!glm::all(glm::epsilonEqual(actual, expected.value(), 0.005f)))
+                        ++mismatches;
+                }
+                else if (actual.a != 0.0f)
+                    ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+
+        // a transverse mercator grid is not separable and falls back on the generic path
+        detail::ReprojectionGrid utm(key.extent(), 32, 32, true, SRS("epsg:32633"));
+        CHECK_FALSE(utm.separable);
+        CHECK(utm.points.size() == 32 * 32);
+        CHECK_FALSE(detail::mosaicImages(utm, sources, *output, io));
+    }
+
+    SECTION("Decode from buffer")
+    {
+        IOOptions io;
+
+        // data no native decoder recognizes goes to the stream reader:
+        bool streamed = false;
+        io.services().readImageFromStream = [&](std::istream& in, std::string, const IOOptions&) -> Result<std::shared_ptr<Image>>
+            {
+                std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                streamed = (data == "raw!");
+                return Image::create(Image::R8_UNORM, 1, 1);
+            };
+        CHECK(io.services().readImageFromBuffer("raw!", {}, io).ok());
+        CHECK(streamed);
+
+#ifdef ROCKY_HAS_PNG
+        // 1x2 RGB png, red on top of blue; decodes to RGBA with the bottom row first
+        const char png[] =
+            "\x89\x50\x4e\x47\x0d\x0a\x1a\x0a\x00\x00\x00\x0d\x49\x48\x44\x52\x00\x00\x00\x01\x00\x00\x00\x02"
+            "\x08\x02\x00\x00\x00\x16\xe3\x21\x70\x00\x00\x00\x0d\x49\x44\x41\x54\x78\x9c\x63\xf8\xcf\x00\x02"
+            "\xff\x01\x08\x00\x01\xff\xd9\x90\xbb\x35\x00\x00\x00\x00\x49\x45\x4e\x44\xae\x42\x60\x82";
+
+        streamed = false;
+        auto r = io.services().readImageFromBuffer(std::string_view(png, sizeof(png) - 1), "image/png", io);
+        CHECK_FALSE(streamed);
+        REQUIRE(r.ok());
+        CHECK(r.value()->pixelFormat() == Image::R8G8B8A8_UNORM);
+        CHECK(glm::all(glm::epsilonEqual(r.value()->read(0, 0), Image::Pixel(0, 0, 1, 1), 0.01f)));
+        CHECK(glm::all(glm::epsilonEqual(r.value()->read(0, 1), Image::Pixel(1, 0, 0, 1), 0.01f)));
+#endif
+    }
 }
 
 TEST_CASE("Heightfield")
@@ -266,11 +835,440 @@ TEST_CASE("Map")
         map->add(layer);
         CHECK(map->layers().size() == 1);
     }
+
+    SECTION("Elevation blending")
+    {
+        // a global base layer under a partial overlay; a third layer only covers
+        // the eastern hemisphere so it should not take part in western tiles.
+        auto base = TestElevationLayer::create();
+        base->height = 100.0f;
+
+        auto overlay = TestElevationLayer::create();
+        overlay->height = 200.0f;
+        overlay->westHalfOnly = true;
+
+        auto east = TestElevationLayer::create();
+        east->height = 999.0f;
+        east->coverage = GeoExtent(SRS::WGS84, 0.0, -90.0, 180.0, 90.0);
+
+        auto elevMap = Map::create();
+        elevMap->add(base);
+        elevMap->add(overlay);
+        elevMap->add(east);
+
+        IOOptions io;
+        REQUIRE(elevMap->openAllLayers(io).ok());
+
+        TerrainTileModelFactory factory;
+        TileKey key(0, 0, 0, Profile("global-geodetic"));
+        auto model = factory.createTileModel(elevMap.get(), key, io);
+        REQUIRE(model.elevation.heightfield.valid());
+
+        GeoHeightfield hf(model.elevation.heightfield);
+        auto ex = key.extent();
+        auto west = hf.read(ex.xmin(), ex.ymin() + 0.5 * ex.height());
+        auto eastEdge = hf.read(ex.xmax(), ex.ymin() + 0.5 * ex.height());
+        REQUIRE((west.ok() && eastEdge.ok()));
+        CHECK(west.value() == Approx(200.0f).margin(0.1f)); // overlay on top
+        CHECK(eastEdge.value() == Approx(100.0f).margin(0.1f)); // falls through to the base
+    }
+}
+
+TEST_CASE("ElevationSampler")
+{
+    IOOptions io;
+    auto layer = TestElevationLayer::create();
+    layer->height = 100.0f;
+    layer->coverage = GeoExtent(SRS::WGS84, 0.0, -90.0, 180.0, 90.0); // eastern hemisphere
+    REQUIRE(layer->open(io).ok());
+
+    ElevationSampler sampler;
+    sampler.layer = layer;
+
+    // a track zig-zagging across a tile boundary only fetches each tile once
+    auto session = sampler.session(io);
+    session.srs = SRS::WGS84;
+    session.level = 4;
+    std::vector<glm::dvec3> track;
+    for (int i = 0; i < 100; ++i)
+        track.emplace_back(i % 2 == 0 ? 11.24 : 11.26, 10.0, 0.0);
+    CHECK(session.clampRange(track.begin(), track.end()));
+    CHECK(session.fetches() == 2);
+    CHECK(track.back().z == Approx(100.0));
+
+    // scattered points over more tiles than the working set holds
+    auto scattered = sampler.session(io);
+    scattered.srs = SRS::WGS84;
+    scattered.level = 4;
+    scattered.workingSetSize = 2;
+    scattered.sortByTile = true;
+    std::vector<glm::dvec3> points;
+    for (int i = 0; i < 100; ++i)
+        points.emplace_back(5.0 + 12.0 * (i % 10), 10.0, 0.0);
+    CHECK(scattered.clampRange(points.begin(), points.end()));
+    CHECK(scattered.fetches() == 10);
+
+    // per-point results continue past points without data
+    std::vector<glm::dvec3> mixed = { {10.0, 10.0, 0.0}, {-10.0, 10.0, 0.0}, {20.0, 10.0, 0.0} };
+    std::vector<bool> results;
+    CHECK(sampler.clampRange(SRS::WGS84, mixed.begin(), mixed.end(), results, io) == 2);
+    CHECK(results == std::vector<bool>{ true, false, true });
+    CHECK(mixed[2].z == Approx(100.0));
+    CHECK(mixed[1].x == Approx(-10.0));
+    // asynchronous batches share their tile requests
+    std::vector<GeoPoint> batch = {
+        GeoPoint(SRS::WGS84, 10.0, 10.0), GeoPoint(SRS::WGS84, 10.01, 10.01), GeoPoint(SRS::WGS84, -10.0, 10.0) };
+    auto first = sampler.sampleAsync(batch, Distance(1000.0, Units::METERS), io);
+    auto& samples = first.join();
+    REQUIRE(samples.size() == 3);
+    CHECK((samples[0].ok() && samples[0].value().height == Approx(100.0f)));
+    CHECK(samples[1].ok());
+    CHECK(samples[2].failed()); // outside the layer's data extent
+
+    auto coalesced = sampler.coalescedRequests();
+    auto second = sampler.clampAsync(batch, Distance(1000.0, Units::METERS), io);
+    auto& clamped = second.join();
+    REQUIRE(clamped.size() == 3);
+    CHECK((clamped[0].ok() && clamped[0].value().z == Approx(100.0)));
+    CHECK(sampler.coalescedRequests() > coalesced);
+}
+
+#ifdef ROCKY_HAS_VSG
+TEST_CASE("TilePrefetcher")
+{
+    IOOptions io;
+    auto layer = TestElevationLayer::create();
+    layer->height = 100.0f;
+    REQUIRE(layer->open(io).ok());
+
+    auto map = Map::create();
+    map->add(layer);
+
+    Profile profile("global-geodetic");
+    TerrainSettings settings;
+    GeoPoint point(SRS::WGS84, 10.0, 10.0);
+
+    // the closer the camera, the finer the tiles
+    auto far = TilePrefetcher::levelOfDetail(point, 1e7, 1080.0f, profile, settings);
+    auto near = TilePrefetcher::levelOfDetail(point, 1e4, 1080.0f, profile, settings);
+    CHECK(near > far);
+    CHECK(TilePrefetcher::levelOfDetail(point, 1e-3, 1080.0f, profile, settings) == settings.maxLevel);
+
+    // fetches the focal tile and its neighbors
+    TilePrefetcher prefetcher;
+    prefetcher.prefetch(point, 1e5, 1080.0f, map, profile, settings, io);
+    CHECK(prefetcher.size() == 9);
+    for (int i = 0; i < 500 && prefetcher.pending() > 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(prefetcher.pending() == 0);
+    auto created = layer->created.load();
+    CHECK(created > 0);
+
+    // the same prediction again fetches nothing new
+    prefetcher.prefetch(point, 1e5, 1080.0f, map, profile, settings, io);
+    CHECK(prefetcher.size() == 9);
+    CHECK(prefetcher.pending() == 0);
+    CHECK(layer->created == created);
+
+    // a new prediction replaces the old tiles
+    prefetcher.prefetch(GeoPoint(SRS::WGS84, -100.0, -40.0), 1e5, 1080.0f, map, profile, settings, io);
+    CHECK(prefetcher.size() == 9);
+
+    prefetcher.clear();
+    CHECK(prefetcher.size() == 0);
 }
+#endif
+
+#ifdef ROCKY_HAS_MBTILES
+TEST_CASE("MBTiles")
+{
+    // raw pixel codec, so the test does not depend on an image library
+    IOOptions io;
+    io.services().writeImageToStream = [](std::shared_ptr<Image> image, std::ostream& out, std::string, const IOOptions&) -> Result<> {
+        std::uint32_t header[3] = { image->width(), image->height(), (std::uint32_t)image->pixelFormat() };
+        out.write((const char*)header, sizeof(header));
+        out.write(image->data<char>(), image->sizeInBytes());
+        return ResultVoidOK; };
+    io.services().readImageFromStream = [](std::istream& in, std::string, const IOOptions&) -> Result<std::shared_ptr<Image>> {
+        std::uint32_t header[3];
+        in.read((char*)header, sizeof(header));
+        auto image = Image::create((Image::PixelFormat)header[2], header[0], header[1]);
+        in.read(image->data<char>(), image->sizeInBytes());
+        return image; };
+
+    auto path = (std::filesystem::temp_directory_path() / "rocky_tests.mbtiles").string();
+    std::filesystem::remove(path);
+
+    Profile profile("global-geodetic");
+    MBTiles::Options options;
+    options.uri = URI(path);
+    options.format = "application/x-raw";
+    options.deduplicate = true;
+
+    SECTION("Bulk write")
+    {
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        auto image = Image::create(Image::R8G8B8A8_UNORM, 8, 8);
+        image->fill(glm::fvec4(1, 0, 0, 1));
+        for (auto& key : profile.allKeysAtLOD(2))
+            CHECK(db.writeAsync(key, image, io).ok());
+        CHECK(db.flush().ok());
+
+        auto tile = db.read(TileKey(2, 3, 1, profile), io);
+        REQUIRE(tile.ok());
+        CHECK(tile.value()->read(4, 4).r == Approx(1.0f));
+        CHECK(db.read(TileKey(3, 0, 0, profile), io).failed());
+    }
+
+    SECTION("Deduplication")
+    {
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        // the same image under several keys is stored once
+        auto image = Image::create(Image::R8G8B8A8_UNORM, 8, 8);
+        image->fill(glm::fvec4(0, 0, 1, 1));
+        for (auto& key : profile.allKeysAtLOD(1))
+            CHECK(db.writeAsync(key, image, io).ok());
+        CHECK(db.write(TileKey(0, 0, 0, profile), image, io).ok());
+        CHECK(db.flush().ok());
+
+        auto count = db.imageCount();
+        REQUIRE(count.ok());
+        CHECK(count.value() == 1);
+
+        for (auto& key : profile.allKeysAtLOD(1))
+            CHECK(db.read(key, io).ok());
+
+        // a different image gets its own row
+        auto other = Image::create(Image::R8G8B8A8_UNORM, 8, 8);
+        other->fill(glm::fvec4(1, 1, 0, 1));
+        CHECK(db.write(TileKey(0, 1, 0, profile), other, io).ok());
+        CHECK(db.imageCount().value() == 2);
+
+        auto tile = db.read(TileKey(0, 1, 0, profile), io);
+        REQUIRE(tile.ok());
+        CHECK(tile.value()->read(4, 4).g == Approx(1.0f));
+    }
+
+    SECTION("Parallel reads")
+    {
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        // a different color per tile, so each read can be checked
+        auto keys = profile.allKeysAtLOD(2);
+        for (unsigned i = 0; i < keys.size(); ++i)
+        {
+            auto image = Image::create(Image::R8G8B8A8_UNORM, 8, 8);
+            image->fill(glm::fvec4((float)i / 255.0f, 0, 0, 1));
+            CHECK(db.write(keys[i], image, io).ok());
+        }
+
+        // each thread reads every tile through its own connection
+        std::atomic<unsigned> good = { 0 };
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]()
+                {
+                    for (unsigned i = 0; i < keys.size(); ++i)
+                    {
+                        auto tile = db.read(keys[i], io);
+                        if (tile.ok() && tile.value()->read(4, 4).r == Approx((float)i / 255.0f))
+                            ++good;
+                    }
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        CHECK(good.load() == 4 * keys.size());
+    }
+
+#ifdef ROCKY_HAS_ZLIB
+    SECTION("Compressed")
+    {
+        // compressed tiles decode through a MemoryInputStream over the sqlite blob
+        options.compress = true;
+
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        auto image = Image::create(Image::R8G8B8A8_UNORM, 8, 8);
+        image->fill(glm::fvec4(0, 1, 0, 1));
+        CHECK(db.write(TileKey(1, 2, 1, profile), image, io).ok());
+
+        auto tile = db.read(TileKey(1, 2, 1, profile), io);
+        REQUIRE(tile.ok());
+        CHECK(tile.value()->width() == 8);
+        CHECK(tile.value()->read(4, 4).g == Approx(1.0f));
+    }
+#endif
+
+    SECTION("Seeding")
+    {
+        auto layer = TestElevationLayer::create();
+        layer->height = 100.0f;
+        layer->coverage = GeoExtent(SRS::WGS84, 0.0, -90.0, 180.0, 90.0); // eastern hemisphere
+        REQUIRE(layer->open(io).ok());
+
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        TileSeeder seeder;
+        seeder.layer = layer;
+        seeder.maxLevel = 2;
+        seeder.checkpointInterval = 8;
+
+        auto first = seeder.run(db, io);
+        REQUIRE(first.ok());
+        CHECK(first->total == 2 + 8 + 32);
+        CHECK(first->written >= 1 + 4 + 16); // every eastern tile
+        CHECK(first->written + first->skipped == first->total);
+
+        auto tile = db.read(TileKey(2, 6, 1, profile), io);
+        REQUIRE(tile.ok());
+        CHECK(tile.value()->pixelFormat() == Image::R32_SFLOAT);
+        CHECK(Heightfield(tile.value()).heightAt(8, 8) == Approx(100.0f));
+
+        // a second run resumes after the last checkpoint, which is the end
+        auto second = seeder.run(db, io);
+        REQUIRE(second.ok());
+        CHECK(second->done == second->total);
+        CHECK(second->written == 0);
+    }
+
+    SECTION("Seeding resumes at a failed tile")
+    {
+        auto layer = TestElevationLayer::create();
+        layer->height = 100.0f;
+        layer->failKey = TileKey(1, 2, 1, profile);
+        REQUIRE(layer->open(io).ok());
+
+        MBTiles::Driver db;
+        DataExtentList extents;
+        REQUIRE(db.open("test", options, true, profile, extents, io).ok());
+
+        TileSeeder seeder;
+        seeder.layer = layer;
+        seeder.maxLevel = 2;
+
+        auto first = seeder.run(db, io);
+        REQUIRE(first.ok());
+        CHECK(first->failed == 1);
+        CHECK(db.read(layer->failKey, io).failed());
+
+        // the checkpoint stops at the failed key, so the next run retries it
+        layer->failKey = {};
+        auto second = seeder.run(db, io);
+        REQUIRE(second.ok());
+        CHECK(second->failed == 0);
+        CHECK(second->written > 0);
+        CHECK(db.read(TileKey(1, 2, 1, profile), io).ok());
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + "-wal");
+    std::filesystem::remove(path + "-shm");
+}
+#endif
 
 #ifdef ROCKY_HAS_GDAL
 TEST_CASE("GDAL")
 {
+#if GDAL_VERSION_NUM >= 3100000
+    GDALAllRegister();
+
+    // a small north-up DEM from (0, 0) to (8, 8) degrees with some nodata cells
+    const int size = 16;
+    const float nodata = -9999.0f;
+    auto path = (std::filesystem::temp_directory_path() / "rocky_tests_dem.tif").string();
+    {
+        auto* ds = GetGDALDriverManager()->GetDriverByName("GTiff")->Create(path.c_str(), size, size, 1, GDT_Float32, nullptr);
+        REQUIRE(ds);
+        double gt[6] = { 0.0, 8.0 / size, 0.0, 8.0, 0.0, -8.0 / size };
+        ds->SetGeoTransform(gt);
+        OGRSpatialReference srs;
+        srs.SetWellKnownGeogCS("WGS84");
+        ds->SetSpatialRef(&srs);
+
+        std::vector<float> values(size * size);
+        for (int i = 0; i < size * size; ++i)
+            values[i] = (float)((i * 37) % 101);
+        for (int i : { 5 * size + 5, 5 * size + 6, 6 * size + 5, 10 * size + 3, 2 * size + 12 })
+            values[i] = nodata;
+
+        auto* band = ds->GetRasterBand(1);
+        band->SetNoDataValue(nodata);
+        CHECK(band->RasterIO(GF_Write, 0, 0, size, size, values.data(), size, size, GDT_Float32, 0, 0, nullptr) == CE_None);
+        GDALClose(ds);
+    }
+
+    // precise mode samples from one read of the source window, and must match
+    // InterpolateAtPoint sample for sample, including next to nodata.
+    auto* source = (GDALDataset*)GDALOpen(path.c_str(), GA_ReadOnly);
+    REQUIRE(source);
+    auto* band = source->GetRasterBand(1);
+
+    const unsigned tileSize = 17;
+    Profile profile("global-geodetic");
+    TileKey key(5, 32, 15, profile); // (0, 0) to (5.625, 5.625)
+    double xmin, ymin, xmax, ymax;
+    key.extent().getBounds(xmin, ymin, xmax, ymax);
+    double dx = (xmax - xmin) / (tileSize - 1), dy = (ymax - ymin) / (tileSize - 1);
+
+    std::pair<Interpolation, GDALRIOResampleAlg> kernels[] = {
+        { Interpolation::Nearest, GRIORA_NearestNeighbour },
+        { Interpolation::Bilinear, GRIORA_Bilinear },
+        { Interpolation::Cubic, GRIORA_Cubic },
+        { Interpolation::CubicSpline, GRIORA_CubicSpline } };
+
+    for (auto& [interpolation, alg] : kernels)
+    {
+        auto layer = GDALElevationLayer::create();
+        layer->uri = URI(path);
+        layer->precise = true;
+        layer->interpolation = interpolation;
+
+        GDAL_detail::Driver driver;
+        REQUIRE(driver.open("test", layer.get(), tileSize, nullptr, IOOptions()).ok());
+        auto image = driver.createHeightfield(key, tileSize, IOOptions());
+        REQUIRE(image.ok());
+        Heightfield hf(image.value());
+
+        unsigned mismatches = 0, nodataSamples = 0;
+        for (unsigned r = 0; r < tileSize; ++r)
+        {
+            for (unsigned c = 0; c < tileSize; ++c)
+            {
+                double px = std::clamp((xmin + dx * c) * size / 8.0, 0.0, size - 1.0);
+                double py = std::clamp((8.0 - (ymin + dy * r)) * size / 8.0, 0.0, size - 1.0);
+                double v;
+                float expected = band->InterpolateAtPoint(px, py, alg, &v, nullptr) == CE_None && (float)v != nodata ?
+                    (float)v : NO_DATA_VALUE;
+
+                if (expected == NO_DATA_VALUE)
+                    ++nodataSamples;
+                if (std::abs(hf.heightAt(c, r) - expected) > 1e-3f)
+                    ++mismatches;
+            }
+        }
+        CHECK(mismatches == 0);
+        if (interpolation == Interpolation::Nearest)
+            CHECK(nodataSamples > 0);
+    }
+
+    GDALClose(source);
+    std::filesystem::remove(path);
+#endif
 }
 #endif // ROCKY_HAS_GDAL
 
@@ -597,6 +1595,114 @@ TEST_CASE("SRS")
         // REQUIRE no crash :)
     }
 
+    SECTION("SRS interning")
+    {
+        SRS a("epsg:3857"), b(std::string("epsg:3857")), c("wgs84");
+        CHECK(a.handle() != 0u);
+        CHECK(a.handle() == b.handle());
+        CHECK(a.handle() != c.handle());
+        CHECK(a.definition() == "epsg:3857");
+        CHECK(SRS().handle() == 0u);
+        CHECK(SRS("").handle() == 0u);
+
+        SRS copy = a;
+        CHECK(copy.handle() == a.handle());
+        CHECK(copy == a);
+
+        // different definitions of the same SRS are still equivalent, every time:
+        SRS merc("spherical-mercator");
+        CHECK(merc.handle() != a.handle());
+        CHECK(merc == a);
+        CHECK(merc == a);
+        CHECK(merc.horizontallyEquivalentTo(a));
+        CHECK(merc != c);
+
+        // handles and their properties are shared across threads; PROJ objects are not
+        std::uint32_t other_handle = 0u;
+        bool other_projected = false;
+        std::thread([&]() {
+            SRS t("epsg:3857");
+            other_handle = t.handle();
+            other_projected = t.isProjected();
+            }).join();
+        CHECK(other_handle == a.handle());
+        CHECK(other_projected == true);
+        CHECK(a.isProjected() == true);
+    }
+
+    SECTION("Native transforms")
+    {
+        // built-in math for the common SRS pairs must agree with PROJ to under a millimeter
+        const SRS* pairs[][2] = {
+            { &SRS::WGS84, &SRS::ECEF },
+            { &SRS::ECEF, &SRS::WGS84 },
+            { &SRS::WGS84, &SRS::SPHERICAL_MERCATOR },
+            { &SRS::SPHERICAL_MERCATOR, &SRS::WGS84 } };
+
+        std::vector<glm::dvec3> lla;
+        for (double lat = -89.5; lat <= 89.5; lat += 8.5)
+            for (double lon = -180.0; lon <= 180.0; lon += 22.5)
+                for (double h : { -400.0, 0.0, 8848.0, 400000.0, 35786000.0 })
+                    lla.emplace_back(lon, lat, h);
+
+        // distance in meters between two points in an SRS
+        auto distance = [](const SRS& srs, const glm::dvec3& a, const glm::dvec3& b) {
+            if (srs.isGeodetic()) {
+                auto& e = srs.ellipsoid();
+                return glm::length(e.geodeticToGeocentric(a) - e.geodeticToGeocentric(b));
+            }
+            return glm::length(srs.isProjected() ? glm::dvec3(a.x - b.x, a.y - b.y, 0.0) : a - b);
+        };
+
+        for (auto& pair : pairs)
+        {
+            auto& from = *pair[0];
+            auto& to = *pair[1];
+
+            auto native = from.to(to);
+            auto proj = SRSOperation(from, to, false);
+            REQUIRE(native.native());
+            REQUIRE(proj.native() == false);
+
+            // inputs in the source SRS:
+            std::vector<glm::dvec3> input(lla);
+            if (!from.isGeodetic())
+                REQUIRE(SRSOperation(SRS::WGS84, from, false).transformArray(input.data(), input.size()));
+
+            double worst = 0.0, worst_inverse = 0.0;
+            for (auto& p : input)
+            {
+                glm::dvec3 a, b;
+                REQUIRE(native.transform(p, a));
+                REQUIRE(proj.transform(p, b));
+                worst = std::max(worst, distance(to, a, b));
+
+                REQUIRE(native.inverse(b, a));
+                REQUIRE(proj.inverse(b, b));
+                worst_inverse = std::max(worst_inverse, distance(from, a, b));
+            }
+            CHECK(worst < 0.001);
+            CHECK(worst_inverse < 0.001);
+
+            // arrays take the same path:
+            std::vector<glm::dvec3> a(input), b(input);
+            REQUIRE(native.transformArray(a.data(), a.size()));
+            REQUIRE(proj.transformArray(b.data(), b.size()));
+            for (std::size_t i = 0; i < a.size(); ++i)
+                CHECK(distance(to, a[i], b[i]) < 0.001);
+        }
+
+        // points the built-in math doesn't do go to PROJ:
+        auto native = SRS::WGS84.to(SRS::SPHERICAL_MERCATOR);
+        auto proj = SRSOperation(SRS::WGS84, SRS::SPHERICAL_MERCATOR, false);
+        glm::dvec3 a(190.0, 10.0, 0.0), b(190.0, 10.0, 0.0);
+        CHECK(native.transform(a.x, a.y, a.z) == proj.transform(b.x, b.y, b.z));
+        CHECK(glm::all(glm::epsilonEqual(a, b, 1e-6)));
+
+        CHECK(SRS::WGS84.to(SRS("epsg:32618")).native() == false);
+        CHECK(SRS::WGS84.to(SRS::WGS84).native() == false);
+    }
+
     SECTION("Well-known Profiles")
     {
         Profile GG("global-geodetic");
@@ -704,6 +1810,122 @@ TEST_CASE("IO")
         }
     }
 
+#if defined(ROCKY_HAS_HTTPLIB) || defined(ROCKY_HAS_CURL)
+    SECTION("Local server")
+    {
+        LocalHTTPServer server;
+        REQUIRE(server.ok());
+        IOOptions io;
+
+        auto r = URI(server.url("/hello")).read(io);
+        CHECKED_IF(r.ok())
+        {
+            CHECK(r->content.data == "/hello");
+            CHECK(r->content.type == "text/plain");
+        }
+
+        auto missing = URI(server.url("/status/404")).read(io);
+        CHECK(missing.failed());
+        CHECK((missing.failed() && missing.error().type == Failure::ResourceUnavailable));
+
+        // many requests in flight at once share the network:
+        std::vector<Future<Result<URIResponse>>> futures;
+        for (int i = 0; i < 32; ++i)
+            futures.emplace_back(URI(server.url("/tile/" + std::to_string(i))).readAsync(io));
+
+        for (int i = 0; i < 32; ++i)
+        {
+            auto& result = futures[i].join();
+            CHECKED_IF(result.ok())
+            {
+                CHECK(result->content.data == "/tile/" + std::to_string(i));
+            }
+        }
+        CHECK(server.requests == 34);
+
+        // concurrent reads of one URI share a single request:
+        server.delay = std::chrono::milliseconds(250);
+        auto shared = URI(server.url("/shared")).readAsync(io);
+        std::atomic_int matches = { 0 };
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 8; ++i)
+        {
+            readers.emplace_back([&]()
+                {
+                    auto r = URI(server.url("/shared")).read(io);
+                    if (r.ok() && r->content.data == "/shared") ++matches;
+                });
+        }
+        for (auto& t : readers)
+            t.join();
+        CHECK(matches == 8);
+        CHECK(shared.join().ok());
+        CHECK(server.requests == 35);
+    }
+
+    SECTION("Host limits")
+    {
+        LocalHTTPServer server;
+        REQUIRE(server.ok());
+        IOOptions io;
+        auto& limiter = io.services().hostLimiter;
+        REQUIRE(limiter);
+        limiter->maxRequestsPerHost = 2;
+
+        // six slow requests, two at a time:
+        server.delay = std::chrono::milliseconds(100);
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<Future<Result<URIResponse>>> futures;
+        for (int i = 0; i < 6; ++i)
+            futures.emplace_back(URI(server.url("/slow/" + std::to_string(i))).readAsync(io));
+        for (auto& f : futures)
+            CHECK(f.join().ok());
+        CHECK(std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(290));
+
+        auto metrics = limiter->metrics(server.url(""));
+        REQUIRE(metrics);
+        CHECK(metrics->concurrency == 2);
+        CHECK(metrics->completed == 6);
+        CHECK(metrics->pending == 0);
+        CHECK(metrics->avg_run_ns() >= 1e8 * 0.9);
+        CHECK(metrics->errors == 0);
+
+        // server errors count against the host:
+        server.delay = std::chrono::milliseconds(0);
+        CHECK(URI(server.url("/status/500")).read(io).failed());
+        CHECK(metrics->errors == 1);
+
+        // and the host shows up with the job pools:
+        auto all = io.services().jobs.get_metrics()->all();
+        CHECK(std::find(all.begin(), all.end(), metrics) != all.end());
+
+        // ...until the limiter goes away:
+        jobs::runtime runtime;
+        auto count = runtime.get_metrics()->all().size();
+        {
+            HostLimiter temp(&runtime);
+            temp.admit("http://a", []() {});
+            temp.finish("http://a", {}, false);
+            CHECK(runtime.get_metrics()->all().size() == count + 1);
+        }
+        CHECK(runtime.get_metrics()->all().size() == count);
+
+        // or, for a limiter that outlives its services, until they go away:
+        std::shared_ptr<HostLimiter> survivor;
+        {
+            IOOptions other;
+            survivor = other.services().hostLimiter;
+            survivor->admit("http://b", []() {});
+            survivor->finish("http://b", {}, false);
+            auto listed = other.services().jobs.get_metrics()->all();
+            CHECK(std::find(listed.begin(), listed.end(), survivor->metrics("http://b")) != listed.end());
+        }
+        survivor->admit("http://b", []() {});
+        survivor->finish("http://b", {}, false);
+        CHECK(survivor->metrics("http://b")->completed == 2);
+    }
+#endif
+
     SECTION("URI")
     {
         URI file("C:/folder/filename.ext");
@@ -734,6 +1956,47 @@ TEST_CASE("IO")
         CHECK(relative_to_url_file.base() == "filename.ext");
         CHECK(relative_to_url_file.full() == "https://server.tld/folder/filename.ext");
     }
+
+    SECTION("Disk cache")
+    {
+        auto root = (std::filesystem::temp_directory_path() / "rocky_tests_disk_cache").string();
+        std::filesystem::remove_all(root);
+        {
+            DiskCache cache(root, 3000);
+            CHECK(cache.valid());
+
+            DiskCacheEntry entry;
+            entry.type = "image/png";
+            entry.data = std::string(1000, 'x');
+            entry.etag = "\"abc\"";
+
+            cache.put("http://server/1", entry);
+            cache.put("http://server/2", entry);
+
+            auto r = cache.get("http://server/1");
+            CHECKED_IF(r.has_value())
+            {
+                CHECK(r->data == entry.data);
+                CHECK(r->etag == entry.etag);
+                CHECK(r->fresh());
+            }
+
+            // exceeds the byte budget, so the least recently used entry goes away:
+            cache.put("http://server/3", entry);
+            CHECK(cache.get("http://server/2").has_value() == false);
+            CHECK(cache.evictions() == 1);
+
+            cache.refresh("http://server/1", std::chrono::system_clock::now() - std::chrono::seconds(1));
+            CHECK(cache.get("http://server/1")->fresh() == false);
+        }
+
+        // entries persist across instances:
+        DiskCache reopened(root, 3000);
+        CHECK(reopened.size() == 2);
+        CHECK(reopened.get("http://server/3").has_value());
+        reopened.clear();
+        CHECK(reopened.size() == 0);
+    }
 }
 
 TEST_CASE("Earth File")